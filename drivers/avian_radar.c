@@ -10,117 +10,252 @@
 #include "spi.h"
 #include "gpio.h"
 #include "clock.h"
+#include "rtt.h"
+#include "trace.h"
 #include <string.h>
 
-/* Static frame buffer */
-static radar_frame_t current_frame;
-static volatile bool acquisition_running = false;
-static volatile uint32_t frame_counter = 0;
+/* Default device for the single-sensor API */
+static radar_dev_t default_dev = {
+    .cs = SPI_CS_DEFAULT,
+    .frame_chirps = RADAR_NUM_CHIRPS,
+};
 
 /* Expected number of 12-bit samples per frame */
-#define SAMPLES_PER_FRAME   (RADAR_NUM_SAMPLES * RADAR_NUM_CHIRPS)
+#define SAMPLES_PER_FRAME(dev)  (RADAR_NUM_SAMPLES * (dev)->frame_chirps)
 
-/* Each sample is 12 bits, packed as 2 samples in 3 bytes */
-#define BYTES_PER_FRAME     ((SAMPLES_PER_FRAME * 3) / 2)
+/* Chirp time from the register export, for frame-end delay computation */
+#define CHIRP_TIME_US       AVIAN_CHIRP_TIME_US
+
+/* Continuous mode bookkeeping runs on the RTT */
+#define US_TO_RTT_TICKS(us) ((uint32_t)(((uint64_t)(us) * RTT_TICK_HZ + 500000ULL) / 1000000ULL))
+
+/* Margin around a frame completion on the anchor grid: re-anchoring
+ * polls are up to 1/16 period apart, plus RTT granularity */
+#define STREAM_GUARD_TICKS(period)  ((period) / 16 + 2)
+
+/* Link training clock steps, slowest first (SPI clock = MCK / SCBR) */
+static const uint8_t link_scbr_steps[] = { SPI_SCBR_DEFAULT, 10, 8, 6, 5, 4, SPI_SCBR_FASTEST };
+#define LINK_NUM_STEPS      (sizeof(link_scbr_steps) / sizeof(link_scbr_steps[0]))
 
 /*
- * Write Avian register via SPI
- * Format: [ADDR<<1 | 1][DATA23:16][DATA15:8][DATA7:0]
+ * Register transaction: 4 bytes out, GSR0 and the 24-bit value back
+ * Format: [ADDR<<1 | RW][DATA23:16][DATA15:8][DATA7:0]
  */
-static void avian_write_reg(uint8_t addr, uint32_t value)
+static uint32_t avian_transfer(radar_dev_t *dev, uint8_t addr, bool write, uint32_t value)
 {
     uint8_t tx_buf[4];
+    uint8_t rx_buf[4];
 
-    tx_buf[0] = (addr << 1) | 0x01;  /* Write bit = 1 */
+    tx_buf[0] = (uint8_t)((addr << 1) | (write ? 0x01 : 0x00));
     tx_buf[1] = (value >> 16) & 0xFF;
     tx_buf[2] = (value >> 8) & 0xFF;
     tx_buf[3] = value & 0xFF;
 
-    spi_select();
-    spi_transfer_buffer(tx_buf, NULL, 4);
-    spi_deselect();
+    spi_select_cs(&dev->cs);
+    spi_transfer_buffer(tx_buf, rx_buf, 4);
+    spi_deselect_cs(&dev->cs);
+
+    dev->shadow.gsr0 = rx_buf[0];
+    return ((uint32_t)rx_buf[1] << 16) |
+           ((uint32_t)rx_buf[2] << 8) |
+           rx_buf[3];
+}
+
+/* Shadow bookkeeping */
+#define SHADOW_BIT(map, addr)   (((map)[(addr) >> 5] >> ((addr) & 31)) & 1u)
+#define SHADOW_SET(map, addr)   ((map)[(addr) >> 5] |= 1u << ((addr) & 31))
+#define SHADOW_CLR(map, addr)   ((map)[(addr) >> 5] &= ~(1u << ((addr) & 31)))
+
+static bool avian_reg_cacheable(uint8_t addr)
+{
+    return addr < AVIAN_NUM_REG_ADDR && addr != AVIAN_REG_STAT1 && addr != AVIAN_REG_FSTAT;
+}
+
+static void shadow_store(radar_dev_t *dev, uint8_t addr, uint32_t value)
+{
+    if (avian_reg_cacheable(addr)) {
+        dev->shadow.value[addr] = (addr == AVIAN_REG_MAIN) ? (value & ~AVIAN_MAIN_CMD_MASK) : value;
+        SHADOW_SET(dev->shadow.known, addr);
+        SHADOW_CLR(dev->shadow.dirty, addr);
+    }
+}
+
+/* Forget everything, e.g. after a software reset */
+static void shadow_invalidate(radar_dev_t *dev)
+{
+    memset(dev->shadow.known, 0, sizeof(dev->shadow.known));
+    memset(dev->shadow.dirty, 0, sizeof(dev->shadow.dirty));
 }
 
 /*
- * Read Avian register via SPI
- * Format: [ADDR<<1 | 0][0][0][0] -> returns 24-bit value
+ * Write Avian register via SPI (always sent; the shadow follows)
  */
-static uint32_t avian_read_reg(uint8_t addr)
+static void avian_write_reg(radar_dev_t *dev, uint8_t addr, uint32_t value)
 {
-    uint8_t tx_buf[4] = {0};
-    uint8_t rx_buf[4];
+    avian_transfer(dev, addr, true, value & 0xFFFFFF);
+    dev->shadow.words_written++;
+    shadow_store(dev, addr, value & 0xFFFFFF);
+}
 
-    tx_buf[0] = (addr << 1) | 0x00;  /* Read bit = 0 */
+/*
+ * Read Avian register via SPI (always sent, shadow untouched: link
+ * training reads back values that may be corrupted)
+ */
+static uint32_t avian_read_reg(radar_dev_t *dev, uint8_t addr)
+{
+    return avian_transfer(dev, addr, false, 0);
+}
 
-    spi_select();
-    spi_transfer_buffer(tx_buf, rx_buf, 4);
-    spi_deselect();
+/*
+ * MAIN command (FRAME_START, resets) with the configured MAIN bits kept
+ */
+static void avian_main(radar_dev_t *dev, uint32_t cmd)
+{
+    avian_write_reg(dev, AVIAN_REG_MAIN, (dev->shadow.value[AVIAN_REG_MAIN] & ~AVIAN_MAIN_CMD_MASK) | cmd);
+}
 
-    /* Return 24-bit value from bytes 1-3 */
-    return ((uint32_t)rx_buf[1] << 16) |
-           ((uint32_t)rx_buf[2] << 8) |
-           rx_buf[3];
+/*
+ * Burst write of `count` registers starting at `addr` from the shadow
+ * Format: [0xFF][ADDR<<1 | 1][0][0], then 3 bytes per register, the
+ * address incrementing until chip select is released
+ */
+static void avian_burst_write(radar_dev_t *dev, uint8_t addr, uint8_t count)
+{
+    uint8_t cmd[4] = { 0xFF, (uint8_t)((addr << 1) | 0x01), 0, 0 };
+    uint8_t gsr0_response[4];
+    uint8_t data[AVIAN_NUM_REG_ADDR * 3];
+
+    for (uint8_t i = 0; i < count; i++) {
+        uint32_t value = dev->shadow.value[addr + i];
+        data[3 * i] = (value >> 16) & 0xFF;
+        data[3 * i + 1] = (value >> 8) & 0xFF;
+        data[3 * i + 2] = value & 0xFF;
+    }
+
+    spi_select_cs(&dev->cs);
+    spi_transfer_buffer(cmd, gsr0_response, 4);
+    spi_transfer_buffer(data, NULL, (uint32_t)count * 3);
+    spi_deselect_cs(&dev->cs);
+
+    dev->shadow.gsr0 = gsr0_response[0];
+    dev->shadow.words_written += count;
+    dev->shadow.bursts++;
+    for (uint8_t i = 0; i < count; i++) {
+        SHADOW_SET(dev->shadow.known, addr + i);
+        SHADOW_CLR(dev->shadow.dirty, addr + i);
+    }
 }
 
 /*
- * Hardware reset via GPIO
+ * Stage a register value; returns false if the sensor already holds it
  */
-static void avian_hardware_reset(void)
+static bool avian_reg_stage(radar_dev_t *dev, uint8_t addr, uint32_t value)
 {
-    radar_reset_low();
-    delay_ms(10);
-    radar_reset_high();
-    delay_ms(50);  /* Wait for sensor to boot */
+    value &= 0xFFFFFF;
+    if (addr == AVIAN_REG_MAIN) {
+        value &= ~AVIAN_MAIN_CMD_MASK;
+    }
+    if (SHADOW_BIT(dev->shadow.known, addr) && !SHADOW_BIT(dev->shadow.dirty, addr) &&
+        dev->shadow.value[addr] == value) {
+        dev->shadow.words_skipped++;
+        return false;
+    }
+    dev->shadow.value[addr] = value;
+    SHADOW_SET(dev->shadow.dirty, addr);
+    return true;
 }
 
 /*
- * Detect if Avian sensor is present
+ * Write all staged registers. Runs of dirty addresses (bridging single
+ * known, clean registers: resending one costs less than a new burst
+ * header) go out as one burst from AVIAN_REG_BURST_MIN registers on,
+ * shorter runs as single writes.
  */
-static bool avian_detect(void)
+static void avian_reg_flush(radar_dev_t *dev)
 {
-    /* Configure high-speed SPI compensation first */
-    avian_write_reg(AVIAN_REG_SFCTL, 0x100000);
-    delay_ms(1);
+    uint8_t addr = 0;
 
-    /* Read ADC0 register to verify device presence */
-    uint32_t adc0 = avian_read_reg(AVIAN_REG_ADC0);
+    while (addr < AVIAN_NUM_REG_ADDR) {
+        if (!SHADOW_BIT(dev->shadow.dirty, addr)) {
+            addr++;
+            continue;
+        }
 
-    /* Check against known BGT60TR13C/E reset values */
-    return (adc0 == AVIAN_ADC0_BGT60TR13C) || (adc0 == AVIAN_ADC0_BGT60TR13E);
+        uint8_t last = addr;
+        uint8_t next = addr + 1;
+        while (next < AVIAN_NUM_REG_ADDR) {
+            if (SHADOW_BIT(dev->shadow.dirty, next)) {
+                last = next++;
+            } else if (next + 1 < AVIAN_NUM_REG_ADDR && SHADOW_BIT(dev->shadow.known, next) &&
+                       SHADOW_BIT(dev->shadow.dirty, next + 1)) {
+                next++;
+            } else {
+                break;
+            }
+        }
+
+        uint8_t count = last - addr + 1;
+        if (count >= AVIAN_REG_BURST_MIN) {
+            avian_burst_write(dev, addr, count);
+        } else {
+            for (uint8_t a = addr; a <= last; a++) {
+                if (SHADOW_BIT(dev->shadow.dirty, a)) {
+                    avian_write_reg(dev, a, dev->shadow.value[a]);
+                }
+            }
+        }
+        addr = last + 1;
+    }
 }
 
 /*
- * Read FIFO status
- * Returns number of samples available in FIFO
+ * Register value from the shadow, read over SPI only if unknown
  */
-static uint16_t avian_get_fifo_count(void)
+static uint32_t avian_reg_get(radar_dev_t *dev, uint8_t addr)
 {
-    uint32_t fstat = avian_read_reg(AVIAN_REG_FSTAT);
-    return fstat & AVIAN_FSTAT_FILL_MASK;
+    if (avian_reg_cacheable(addr) && SHADOW_BIT(dev->shadow.known, addr)) {
+        dev->shadow.reads_saved++;
+        return dev->shadow.value[addr];
+    }
+    uint32_t value = avian_read_reg(dev, addr);
+    shadow_store(dev, addr, value);
+    return value;
 }
 
 /*
- * Check for FIFO errors
+ * Hardware reset via GPIO (one reset line for all sensors)
  */
-static bool avian_check_fifo_error(void)
+void radar_hardware_reset(void)
 {
-    uint32_t fstat = avian_read_reg(AVIAN_REG_FSTAT);
-    return (fstat & AVIAN_FSTAT_FOU_ERR) != 0;
+    radar_reset_low();
+    delay_ms(10);
+    radar_reset_high();
+    delay_ms(50);  /* Wait for sensor to boot */
 }
 
 /*
- * Read samples from FIFO using burst mode
- * Samples are 12-bit packed: 2 samples in 3 bytes
- * Output: unpacked to 16-bit signed values
+ * Detect if Avian sensor is present
  */
-static bool avian_read_fifo(int16_t *samples, uint16_t num_samples)
+static bool avian_detect(radar_dev_t *dev)
 {
-    /* Calculate bytes to read (2 samples = 3 bytes) */
-    uint16_t bytes_to_read = (num_samples * 3) / 2;
+    /* Configure high-speed SPI compensation first */
+    avian_write_reg(dev, AVIAN_REG_SFCTL, AVIAN_SFCTL_MISO_HS_READ);
+    delay_ms(1);
 
-    /* Temporary buffer for packed 12-bit data */
-    static uint8_t packed_buf[BYTES_PER_FRAME + 4];
+    /* Read ADC0 register to verify device presence */
+    uint32_t adc0 = avian_read_reg(dev, AVIAN_REG_ADC0);
 
+    /* Check against known BGT60TR13C/E reset values */
+    return (adc0 == AVIAN_ADC0_BGT60TR13C) || (adc0 == AVIAN_ADC0_BGT60TR13E);
+}
+
+/*
+ * Burst read of packed FIFO data
+ * Returns false (nothing read) if GSR0 reports a FIFO error, unless
+ * `salvage` (reading the complete frames queued ahead of an overflow)
+ */
+static bool avian_burst_read(radar_dev_t *dev, uint8_t *buf, uint16_t len, bool salvage)
+{
     /* Send burst read command
      * Format: 0xFF (burst), ADDR<<1 (read), 0, 0
      */
@@ -131,53 +266,288 @@ static bool avian_read_fifo(int16_t *samples, uint16_t num_samples)
         0
     };
 
-    spi_select();
+    trace_begin(TRACE_SPI_BURST, len);
+    spi_select_cs(&dev->cs);
 
     /* Send burst prefix and receive GSR0 in response */
     uint8_t gsr0_response[4];
     spi_transfer_buffer(cmd, gsr0_response, 4);
+    dev->shadow.gsr0 = gsr0_response[0];
+
+    /* Check GSR0 for FIFO overflow */
+    if ((gsr0_response[0] & AVIAN_GSR0_FOU_ERR) && !salvage) {
+        spi_deselect_cs(&dev->cs);
+        trace_end(TRACE_SPI_BURST, 0);
+        return false;
+    }
+
+    /* Burst read the packed data (MOSI idles at 0xFF, no TX buffer) */
+    spi_transfer_buffer(NULL, buf, len);
+
+    spi_deselect_cs(&dev->cs);
+    trace_end(TRACE_SPI_BURST, len);
+    return true;
+}
+
+/* Median chirp mean square (Hoare selection on a copy) */
+static uint32_t chirp_energy_median(const radar_chirp_stats_t *stats, uint16_t num_chirps)
+{
+    uint32_t v[RADAR_NUM_CHIRPS];
+    int k = num_chirps / 2;
+    int lo = 0;
+    int hi = num_chirps - 1;
+
+    for (int c = 0; c < num_chirps; c++) {
+        v[c] = stats[c].energy;
+    }
+    while (lo < hi) {
+        uint32_t pivot = v[k];
+        int i = lo;
+        int j = hi;
+        do {
+            while (v[i] < pivot) i++;
+            while (pivot < v[j]) j--;
+            if (i <= j) {
+                uint32_t t = v[i];
+                v[i++] = v[j];
+                v[j--] = t;
+            }
+        } while (i <= j);
+        if (j < k) lo = i;
+        if (k < i) hi = j;
+    }
+    return v[k];
+}
+
+/* Chirp-to-chirp change energy between chirp c and c - 1 */
+static uint32_t chirp_motion(const int16_t *samples, uint16_t c)
+{
+    const int16_t *chirp = &samples[c * RADAR_NUM_SAMPLES];
+    uint32_t sum = 0;
+
+    for (int s = 0; s < RADAR_NUM_SAMPLES; s++) {
+        int32_t d = chirp[s] - chirp[s - RADAR_NUM_SAMPLES];
+        sum += (uint32_t)(d * d);
+    }
+    return sum;
+}
+
+/*
+ * Outlier test on the chirp statistics; bad chirps are replaced by the
+ * mean of their good neighbours (one good neighbour: a copy, none:
+ * zeros), their chirp-to-chirp change is recomputed and their raw sums
+ * are taken out of the clutter map update. Touches only bad chirps and
+ * their neighbours. Returns the number of bad chirps.
+ */
+static uint16_t chirp_repair(radar_dev_t *dev, int16_t *samples, uint16_t num_chirps,
+                             uint32_t *motion, int32_t *chirp_acc, const int32_t *offset)
+{
+    radar_chirp_stats_t *stats = dev->chirp_stats;
+    if (num_chirps == 0) {
+        return 0;
+    }
+    uint32_t median = chirp_energy_median(stats, num_chirps);
+    uint32_t limit = median * RADAR_CHIRP_OUTLIER + RADAR_CHIRP_FLOOR;
+    uint16_t clipping = 0;
+    uint16_t bad = 0;
 
-    /* Check GSR0 for FIFO overflow (bit 3) */
-    if (gsr0_response[0] & 0x08) {
-        spi_deselect();
+    dev->frame.chirp_energy = median;
+    for (uint16_t c = 0; c < num_chirps; c++) {
+        clipping += (stats[c].clips >= RADAR_CHIRP_CLIP_SAMPLES);
+    }
+    bool clip_outliers = (clipping < num_chirps / 4);
+
+    for (uint16_t c = 0; c < num_chirps; c++) {
+        stats[c].bad = (stats[c].energy > limit) ||
+                       (clip_outliers && stats[c].clips >= RADAR_CHIRP_CLIP_SAMPLES);
+        bad += stats[c].bad;
+    }
+    if (bad == 0) {
+        return 0;
+    }
+
+    for (uint16_t c = 0; c < num_chirps; c++) {
+        if (!stats[c].bad) {
+            continue;
+        }
+        int16_t *chirp = &samples[c * RADAR_NUM_SAMPLES];
+        const int16_t *prev = (c > 0 && !stats[c - 1].bad) ? chirp - RADAR_NUM_SAMPLES : NULL;
+        const int16_t *next = (c + 1 < num_chirps && !stats[c + 1].bad) ? chirp + RADAR_NUM_SAMPLES : NULL;
+
+        for (int s = 0; s < RADAR_NUM_SAMPLES; s++) {
+            chirp_acc[s] -= chirp[s] + stats[c].mean + offset[s];
+            if (prev && next) {
+                chirp[s] = (int16_t)((prev[s] + next[s]) / 2);
+            } else if (prev || next) {
+                chirp[s] = (prev ? prev : next)[s];
+            } else {
+                chirp[s] = 0;
+            }
+        }
+    }
+
+    for (uint16_t c = 1; c < num_chirps; c++) {
+        if (stats[c].bad || stats[c - 1].bad) {
+            motion[c] = chirp_motion(samples, c);
+        }
+    }
+    return bad;
+}
+
+/*
+ * Read samples from FIFO into dev->frame using burst mode
+ * Samples are 12-bit packed: 2 samples in 3 bytes
+ * Output: unpacked to 16-bit signed values, with static clutter
+ * removed according to dev->clutter_mode in the same pass
+ * motion_energy: mean squared difference between each sample and the
+ * same sample of the previous chirp, accumulated during unpack
+ * Chirp statistics (range, clipping, energy) come out of the same
+ * pass; chirp_repair() then replaces interference before anything
+ * downstream sees the frame.
+ *
+ * The burst lands in the last 3/4 of the output itself and is expanded
+ * front to back: sample pair k (bytes 4k..4k+3) is written only after
+ * packed bytes 3k..3k+2 at offset num_samples / 2 were read, and
+ * 4k + 4 <= num_samples / 2 + 3k + 3 for every pair, so the output
+ * never overtakes unread input. (Back to front would not work: the
+ * last pair overwrites the start of the second-to-last triple.)
+ */
+static bool avian_read_fifo(radar_dev_t *dev, uint16_t num_samples, bool salvage)
+{
+    radar_frame_t *frame = &dev->frame;
+    int16_t *samples = frame->samples;
+
+    /* Calculate bytes to read (2 samples = 3 bytes) */
+    uint16_t bytes_to_read = (num_samples * 3) / 2;
+    uint8_t *packed = (uint8_t *)samples + (num_samples * sizeof(int16_t) - bytes_to_read);
+
+    if (!avian_burst_read(dev, packed, bytes_to_read, salvage)) {
         return false;  /* FIFO overflow error */
     }
+    trace_begin(TRACE_UNPACK, num_samples);
 
-    /* Burst read the packed data */
-    memset(packed_buf, 0, bytes_to_read);
-    spi_transfer_buffer(NULL, packed_buf, bytes_to_read);
+    /* Offset per sample index: 12-bit mid-scale, or the clutter map */
+    int32_t offset[RADAR_NUM_SAMPLES];
+    int32_t chirp_acc[RADAR_NUM_SAMPLES];    /* Raw sum over chirps (map update) */
+    uint32_t motion[RADAR_NUM_CHIRPS];       /* Change from the previous chirp */
+    int32_t *clutter_map = dev->clutter_map;
+    bool use_map = (dev->clutter_mode == RADAR_CLUTTER_MTI) && dev->clutter_seeded;
+    bool remove_mean = (dev->clutter_mode != RADAR_CLUTTER_NONE);
 
-    spi_deselect();
+    for (int s = 0; s < RADAR_NUM_SAMPLES; s++) {
+        offset[s] = use_map ? (clutter_map[s] + 0x8000) >> 16 : RADAR_ADC_MID;
+        chirp_acc[s] = 0;
+    }
 
-    /* Unpack 12-bit samples to 16-bit
+    /* Unpack 12-bit samples to 16-bit, one chirp at a time
      * Input:  [B0][B1][B2] = Sample0[11:0], Sample1[11:0]
      *         B0 = S0[11:4]
      *         B1 = S0[3:0] | S1[11:8]
      *         B2 = S1[7:0]
+     * Chirps hold an even number of samples, so pairs never straddle
+     * a chirp boundary. The per-chirp fix-up touches only the chirp
+     * just written (still in cache, and behind the input), not the
+     * frame.
      */
-    for (uint16_t i = 0; i < num_samples; i += 2) {
-        uint16_t byte_idx = (i * 3) / 2;
-
-        uint8_t b0 = packed_buf[byte_idx];
-        uint8_t b1 = packed_buf[byte_idx + 1];
-        uint8_t b2 = packed_buf[byte_idx + 2];
-
-        /* Extract sample 0: B0[7:0] << 4 | B1[7:4] */
-        uint16_t s0_raw = ((uint16_t)b0 << 4) | (b1 >> 4);
-
-        /* Extract sample 1: B1[3:0] << 8 | B2[7:0] */
-        uint16_t s1_raw = ((uint16_t)(b1 & 0x0F) << 8) | b2;
-
-        /* Convert 12-bit unsigned to signed 16-bit
-         * 12-bit value: 0-4095, center at 2048
-         * Convert to signed: subtract 2048
-         */
-        samples[i] = (int16_t)(s0_raw) - 2048;
-        if (i + 1 < num_samples) {
-            samples[i + 1] = (int16_t)(s1_raw) - 2048;
+    const uint8_t *src = packed;
+    uint16_t num_chirps = num_samples / RADAR_NUM_SAMPLES;
+    uint16_t frame_min = RADAR_ADC_MAX;
+    uint16_t frame_max = 0;
+    uint16_t frame_clips = 0;
+
+    for (uint16_t c = 0; c < num_chirps; c++) {
+        int16_t *chirp = &samples[c * RADAR_NUM_SAMPLES];
+        radar_chirp_stats_t *st = &dev->chirp_stats[c];
+        int32_t chirp_sum = 0;
+        int32_t lo = RADAR_ADC_MAX;
+        int32_t hi = 0;
+
+        for (int s = 0; s < RADAR_NUM_SAMPLES; s += 2) {
+            uint8_t b0 = src[0];
+            uint8_t b1 = src[1];
+            uint8_t b2 = src[2];
+            src += 3;
+
+            /* Sample 0: B0[7:0] << 4 | B1[7:4], sample 1: B1[3:0] << 8 | B2[7:0] */
+            int32_t s0_raw = ((int32_t)b0 << 4) | (b1 >> 4);
+            int32_t s1_raw = ((int32_t)(b1 & 0x0F) << 8) | b2;
+
+            chirp_acc[s] += s0_raw;
+            chirp_acc[s + 1] += s1_raw;
+            lo = (s0_raw < lo) ? s0_raw : lo;
+            hi = (s0_raw > hi) ? s0_raw : hi;
+            lo = (s1_raw < lo) ? s1_raw : lo;
+            hi = (s1_raw > hi) ? s1_raw : hi;
+
+            int32_t v0 = s0_raw - offset[s];
+            int32_t v1 = s1_raw - offset[s + 1];
+            chirp[s] = (int16_t)v0;
+            chirp[s + 1] = (int16_t)v1;
+            chirp_sum += v0 + v1;
+        }
+
+        /* Per-chirp mean removal, energy and chirp-to-chirp change;
+         * clipped samples are only counted when the range hit a rail */
+        int32_t mean = remove_mean ? chirp_sum / RADAR_NUM_SAMPLES : 0;
+        bool railed = (lo == 0) || (hi == RADAR_ADC_MAX);
+        uint32_t energy = 0;
+        uint32_t change = 0;
+        uint32_t clips = 0;
+        for (int s = 0; s < RADAR_NUM_SAMPLES; s++) {
+            if (railed) {
+                int32_t raw = chirp[s] + offset[s];
+                clips += (raw == 0) || (raw == RADAR_ADC_MAX);
+            }
+            int32_t v = chirp[s] - mean;
+            chirp[s] = (int16_t)v;
+            energy += (uint32_t)(v * v);
+            if (c > 0) {
+                int32_t d = v - chirp[s - RADAR_NUM_SAMPLES];
+                change += (uint32_t)(d * d);
+            }
         }
+
+        st->energy = energy / RADAR_NUM_SAMPLES;
+        st->min = (uint16_t)lo;
+        st->max = (uint16_t)hi;
+        st->mean = (int16_t)mean;
+        st->clips = (uint8_t)clips;
+        motion[c] = change;
+        frame_clips += clips;
+        frame_min = (lo < frame_min) ? (uint16_t)lo : frame_min;
+        frame_max = (hi > frame_max) ? (uint16_t)hi : frame_max;
+    }
+
+    uint16_t bad = chirp_repair(dev, samples, num_chirps, motion, chirp_acc, offset);
+    uint64_t motion_sum = 0;
+    for (uint16_t c = 1; c < num_chirps; c++) {
+        motion_sum += motion[c];
     }
 
+    frame->motion_energy = (uint32_t)(motion_sum / (num_samples - RADAR_NUM_SAMPLES));
+    frame->clips = frame_clips;
+    frame->bad_chirps = (uint8_t)bad;
+    frame->flags = (frame_clips ? RADAR_FRAME_CLIPPED : 0) | (bad ? RADAR_FRAME_INTERFERENCE : 0);
+    frame->peak = (uint16_t)((RADAR_ADC_MID - frame_min > frame_max - RADAR_ADC_MID) ?
+                             RADAR_ADC_MID - frame_min : frame_max - RADAR_ADC_MID);
+    frame->chirp_stats = dev->chirp_stats;
+
+    /* Clutter map follows the mean chirp: map += (mean - map) * 2^-SHIFT
+     * (over the chirps that passed the checks) */
+    uint16_t good = num_chirps - bad;
+    if (dev->clutter_mode == RADAR_CLUTTER_MTI && good > 0) {
+        for (int s = 0; s < RADAR_NUM_SAMPLES; s++) {
+            int32_t mean_q16 = (int32_t)(((int64_t)chirp_acc[s] << 16) / good);
+            if (dev->clutter_seeded) {
+                clutter_map[s] += (mean_q16 - clutter_map[s]) >> RADAR_CLUTTER_SHIFT;
+            } else {
+                clutter_map[s] = mean_q16;
+            }
+        }
+        dev->clutter_seeded = true;
+    }
+
+    trace_end(TRACE_UNPACK, num_samples);
     return true;
 }
 
@@ -185,147 +555,1002 @@ static bool avian_read_fifo(int16_t *samples, uint16_t num_samples)
  * Check if frame acquisition is complete
  * Uses STAT1 frame_end bit or FIFO fill level
  */
-static bool avian_frame_complete(void)
+static bool avian_frame_complete(radar_dev_t *dev)
 {
     /* Check FIFO fill level */
-    uint16_t fifo_count = avian_get_fifo_count();
+    uint16_t fifo_count = radar_dev_fifo_status(dev) & AVIAN_FSTAT_FILL_MASK;
 
     /* Frame is complete when we have all samples */
-    return (fifo_count >= SAMPLES_PER_FRAME);
+    return (fifo_count >= SAMPLES_PER_FRAME(dev));
 }
 
 /*
- * Initialize radar sensor
+ * Initialize one sensor
  */
-bool radar_init(void)
+bool radar_dev_init(radar_dev_t *dev, const spi_cs_t *cs)
 {
-    /* 1. Hardware reset */
-    avian_hardware_reset();
+    spi_cs_t pin = *cs;     /* cs may point into *dev */
+    int16_t *samples = dev->frame.samples;
+    uint32_t capacity = dev->frame_capacity;
+
+    memset(dev, 0, sizeof(*dev));
+    dev->cs = pin;
+    dev->frame.samples = samples;
+    dev->frame_capacity = capacity;
+    dev->frame_chirps = RADAR_NUM_CHIRPS;
+    dev->stream.period_us = AVIAN_FRAME_TIME_MS * 1000UL;
+    dev->cs.scbr = SPI_SCBR_DEFAULT;        /* Until radar_dev_link_train() */
+    dev->cs.wide = false;
+    dev->link.scbr = SPI_SCBR_DEFAULT;
+    dev->link.hs_read = true;               /* avian_detect(), then the export */
+    dev->link.clock_hz = SPI_CLOCK_HZ(SPI_SCBR_DEFAULT);
+    spi_cs_init(&dev->cs);
 
-    /* 2. Detect device */
-    if (!avian_detect()) {
+    /* 1. Detect device */
+    if (!avian_detect(dev)) {
         return false;
     }
 
-    /* 3. Software reset */
-    avian_write_reg(AVIAN_REG_MAIN, AVIAN_MAIN_SW_RESET);
+    /* 2. Software reset: all registers back to their reset values */
+    avian_main(dev, AVIAN_MAIN_SW_RESET);
+    shadow_invalidate(dev);
     delay_ms(10);
 
-    /* 4. Reset FIFO and FSM */
-    avian_write_reg(AVIAN_REG_MAIN, AVIAN_MAIN_FIFO_RESET | AVIAN_MAIN_FSM_RESET);
+    /* 3. Reset FIFO and FSM */
+    avian_main(dev, AVIAN_MAIN_FIFO_RESET | AVIAN_MAIN_FSM_RESET);
     delay_ms(5);
-    avian_write_reg(AVIAN_REG_MAIN, 0);
+    avian_main(dev, 0);
     delay_ms(5);
 
-    /* 5. Program all registers from exported configuration */
-    for (uint32_t i = 0; i < AVIAN_NUM_REGS; i++) {
-        uint32_t reg_data = avian_register_config[i];
-        uint8_t addr = (reg_data >> 24) & 0xFF;
-        uint32_t value = reg_data & 0xFFFFFF;
+    /* 4. Program all registers from exported configuration (shadow is
+     * empty, so everything is written, in bursts where contiguous); the
+     * IF gain starts at the exported CSU1_2 setting */
+    if (!radar_dev_write_config(dev, avian_register_config, AVIAN_NUM_REGS)) {
+        return false;
+    }
+    dev->link.hs_read = (avian_reg_get(dev, AVIAN_REG_SFCTL) & AVIAN_SFCTL_MISO_HS_READ) != 0;
+
+    /* 5. Frame buffer starts invalid (cleared above) */
+    return true;
+}
+
+void radar_dev_set_frame_buffer(radar_dev_t *dev, int16_t *buf, uint32_t num_samples)
+{
+    dev->frame.samples = buf;
+    dev->frame_capacity = buf ? num_samples : 0;
+    dev->frame.valid = false;
+}
+
+/*
+ * IF gain reference from the CSU1_2 just written: every RX channel
+ * must carry the same, valid VGA gain and high-pass. Otherwise the
+ * gain stays fixed (ref_valid false) and frames are tagged 0 dB.
+ */
+static void gain_decode_reference(radar_dev_t *dev)
+{
+    radar_gain_t *g = &dev->gain;
+    uint32_t csx2 = avian_reg_get(dev, AVIAN_REG_CSU1_2);
+    uint8_t vga = (csx2 >> AVIAN_CSX_2_VGA_GAIN_POS(0)) & AVIAN_CSX_2_VGA_GAIN_MASK;
+    uint8_t hpf = (csx2 >> AVIAN_CSX_2_HPF_SEL_POS(0)) & AVIAN_CSX_2_HPF_SEL_MASK;
+
+    g->ref_valid = (vga <= AVIAN_VGA_GAIN_MAX) && (hpf <= AVIAN_HPF_SEL_MAX);
+    for (int n = 1; n < RADAR_NUM_RX_ANTENNAS; n++) {
+        g->ref_valid &= (((csx2 >> AVIAN_CSX_2_VGA_GAIN_POS(n)) & AVIAN_CSX_2_VGA_GAIN_MASK) == vga) &&
+                        (((csx2 >> AVIAN_CSX_2_HPF_SEL_POS(n)) & AVIAN_CSX_2_HPF_SEL_MASK) == hpf);
+    }
+    if (!g->ref_valid) {
+        vga = 0;
+        hpf = 0;
+    }
+    g->ref_vga = g->vga = g->prev_vga = g->next_vga = vga;
+    g->ref_hpf = g->hpf = g->prev_hpf = g->next_hpf = hpf;
+    g->pending = false;
+}
+
+/*
+ * Register access through the shadow
+ */
+bool radar_dev_write_config(radar_dev_t *dev, const uint32_t *config, uint32_t num_regs)
+{
+    /* Entries are ADDR << 25 | 1 << 24 | DATA */
+    for (uint32_t i = 0; i < num_regs; i++) {
+        if ((config[i] >> 25) >= AVIAN_NUM_REG_ADDR || !(config[i] & (1UL << 24))) {
+            return false;
+        }
+    }
+
+    bool gain = false;
+    for (uint32_t i = 0; i < num_regs; i++) {
+        avian_reg_stage(dev, (uint8_t)(config[i] >> 25), config[i] & 0xFFFFFF);
+        gain |= ((config[i] >> 25) == AVIAN_REG_CSU1_2);
+    }
+    avian_reg_flush(dev);
+    if (gain) {
+        gain_decode_reference(dev);
+    }
+    return true;
+}
+
+void radar_dev_write_reg(radar_dev_t *dev, uint8_t addr, uint32_t value)
+{
+    if (addr == AVIAN_REG_MAIN || !avian_reg_cacheable(addr)) {
+        avian_write_reg(dev, addr, value);
+    } else if (avian_reg_stage(dev, addr, value)) {
+        avian_reg_flush(dev);
+    }
+}
+
+uint32_t radar_dev_read_reg(radar_dev_t *dev, uint8_t addr)
+{
+    return avian_reg_get(dev, addr);
+}
+
+/*
+ * SPI link training
+ *
+ * Every write (SFCTL, FIFO reset) goes out at the default clock, so a
+ * failing step cannot corrupt the sensor configuration. The candidate
+ * setting only reads: registers whose value was just read at the
+ * default clock, and the FIFO test pattern.
+ */
+uint16_t radar_test_pattern_next(uint16_t word)
+{
+    uint16_t bit = ((word >> 11) ^ (word >> 10) ^ (word >> 9) ^ (word >> 3)) & 1;
+    return (uint16_t)(((word << 1) | bit) & 0x0FFF);
+}
+
+static void link_use(radar_dev_t *dev, uint8_t scbr, bool wide)
+{
+    dev->cs.scbr = scbr;
+    dev->cs.wide = wide;
+}
+
+/* Registers read back by the link checks: the chip id, then the
+ * exported configuration (varied bit patterns, none changes on read) */
+static uint8_t link_readback_addr(uint32_t k)
+{
+    if (k == 0) {
+        return AVIAN_REG_CHIP_ID;
+    }
+    return (uint8_t)(avian_register_config[(k - 1) % AVIAN_NUM_REGS] >> 25);
+}
+
+/* Register reads at the test setting against the same reads at the
+ * default clock; returns failed words. Nothing is written. */
+static uint32_t link_readback(radar_dev_t *dev, const spi_cs_t *test)
+{
+    uint32_t expected[RADAR_LINK_READBACKS];
+    uint32_t errors = 0;
+
+    link_use(dev, SPI_SCBR_DEFAULT, false);
+    for (uint32_t k = 0; k < RADAR_LINK_READBACKS; k++) {
+        expected[k] = avian_read_reg(dev, link_readback_addr(k));
+    }
+
+    link_use(dev, test->scbr, test->wide);
+    for (uint32_t k = 0; k < RADAR_LINK_READBACKS; k++) {
+        if (avian_read_reg(dev, link_readback_addr(k)) != expected[k]) {
+            errors++;
+        }
+    }
+
+    link_use(dev, SPI_SCBR_DEFAULT, false);
+    return errors;
+}
+
+/* FIFO test pattern at the test setting; returns failed words.
+ * The packed words land in the (idle) frame buffer. */
+#define LINK_PATTERN_BYTES  (RADAR_LINK_TEST_WORDS * 3 / 2)
+
+static uint32_t link_pattern(radar_dev_t *dev, const spi_cs_t *test, uint32_t sfctl)
+{
+    uint8_t *buf = (uint8_t *)dev->frame.samples;
+    uint32_t errors = 0;
+
+    /* Pattern restarts at the seed on FIFO reset */
+    link_use(dev, SPI_SCBR_DEFAULT, false);
+    avian_write_reg(dev, AVIAN_REG_SFCTL, sfctl | AVIAN_SFCTL_LFSR_EN);
+    avian_main(dev, AVIAN_MAIN_FIFO_RESET);
+    avian_main(dev, 0);
+
+    link_use(dev, test->scbr, test->wide);
+    if (!avian_burst_read(dev, buf, LINK_PATTERN_BYTES, false)) {
+        errors = RADAR_LINK_TEST_WORDS;
+    } else {
+        uint16_t expected = AVIAN_TEST_PATTERN_SEED;
+        for (uint32_t i = 0; i < LINK_PATTERN_BYTES; i += 3) {
+            uint16_t w0 = (uint16_t)((buf[i] << 4) | (buf[i + 1] >> 4));
+            uint16_t w1 = (uint16_t)(((buf[i + 1] & 0x0F) << 8) | buf[i + 2]);
+            errors += (w0 != expected);
+            expected = radar_test_pattern_next(expected);
+            errors += (w1 != expected);
+            expected = radar_test_pattern_next(expected);
+        }
+    }
+
+    link_use(dev, SPI_SCBR_DEFAULT, false);
+    avian_write_reg(dev, AVIAN_REG_SFCTL, sfctl);
+    avian_main(dev, AVIAN_MAIN_FIFO_RESET);
+    avian_main(dev, 0);
+    return errors;
+}
+
+/* Validate one setting RADAR_LINK_REPEATS times */
+static bool link_step(radar_dev_t *dev, uint8_t scbr, bool hs_read, uint32_t sfctl_base)
+{
+    spi_cs_t test = dev->cs;
+    uint32_t sfctl = hs_read ? (sfctl_base | AVIAN_SFCTL_MISO_HS_READ)
+                             : (sfctl_base & ~AVIAN_SFCTL_MISO_HS_READ);
+    test.scbr = scbr;
+    test.wide = true;
+
+    dev->link.steps_tested++;
+    link_use(dev, SPI_SCBR_DEFAULT, false);
+    avian_write_reg(dev, AVIAN_REG_SFCTL, sfctl);
+
+    for (int r = 0; r < RADAR_LINK_REPEATS; r++) {
+        uint32_t rb = link_readback(dev, &test);
+        uint32_t pt = link_pattern(dev, &test, sfctl);
+        dev->link.readback_errors += rb;
+        dev->link.pattern_errors += pt;
+        if (rb || pt) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void link_apply(radar_dev_t *dev, uint8_t scbr, bool hs_read, bool wide, uint32_t sfctl_base)
+{
+    link_use(dev, SPI_SCBR_DEFAULT, false);
+    avian_write_reg(dev, AVIAN_REG_SFCTL, hs_read ? (sfctl_base | AVIAN_SFCTL_MISO_HS_READ)
+                                                  : (sfctl_base & ~AVIAN_SFCTL_MISO_HS_READ));
+    link_use(dev, scbr, wide);
+    dev->link.scbr = scbr;
+    dev->link.hs_read = hs_read;
+    dev->link.wide = wide;
+    dev->link.clock_hz = SPI_CLOCK_HZ(scbr);
+}
+
+bool radar_dev_link_train(radar_dev_t *dev)
+{
+    if (dev->acquisition_running || dev->frame_capacity * sizeof(int16_t) < LINK_PATTERN_BYTES) {
+        return false;       /* Busy or no scratch: keep the current setting */
+    }
+    dev->frame.valid = false;
+
+    link_use(dev, SPI_SCBR_DEFAULT, false);
+    uint32_t sfctl_base = avian_reg_get(dev, AVIAN_REG_SFCTL) & ~AVIAN_SFCTL_LFSR_EN;
+
+    dev->link.steps_tested = 0;
+    int best = -1;
+    bool best_hs = true;
+
+    for (unsigned s = 0; s < LINK_NUM_STEPS; s++) {
+        /* High-speed read first (set by avian_detect), then without */
+        bool passed = false;
+        for (int hs = 1; hs >= 0 && !passed; hs--) {
+            if (link_step(dev, link_scbr_steps[s], hs != 0, sfctl_base)) {
+                best = (int)s;
+                best_hs = (hs != 0);
+                passed = true;
+            }
+        }
+        if (!passed) {
+            break;      /* Faster steps will not pass either */
+        }
+    }
+
+    if (best < 0) {
+        link_apply(dev, SPI_SCBR_DEFAULT, true, false, sfctl_base);
+        return false;
+    }
+
+    link_apply(dev, link_scbr_steps[best], best_hs, true, sfctl_base);
+    return true;
+}
+
+bool radar_dev_link_check(radar_dev_t *dev)
+{
+    spi_cs_t test = dev->cs;
+
+    if (dev->acquisition_running) {
+        return false;       /* Refused: reads would land between FIFO drains */
+    }
+    uint32_t errors = link_readback(dev, &test);
+
+    dev->link.checks++;
+    dev->link.readback_errors += errors;
+    link_use(dev, test.scbr, test.wide);
+    if (errors == 0) {
+        return true;
+    }
+
+    /* Step down to the next slower divider */
+    dev->link.check_failures++;
+    for (unsigned s = 1; s < LINK_NUM_STEPS; s++) {
+        if (link_scbr_steps[s] == dev->link.scbr) {
+            dev->link.scbr = link_scbr_steps[s - 1];
+            break;
+        }
+    }
+    dev->link.clock_hz = SPI_CLOCK_HZ(dev->link.scbr);
+    link_use(dev, dev->link.scbr, test.wide);
+    return false;
+}
+
+/*
+ * Initialize radar sensor
+ */
+bool radar_init(void)
+{
+    radar_hardware_reset();
+    return radar_dev_init(&default_dev, &default_dev.cs);
+}
+
+/*
+ * Continuous mode: expected completion of the first frame of a new
+ * sequence, started now
+ */
+static void stream_anchor_start(radar_dev_t *dev)
+{
+    dev->stream.anchor_index = dev->frame_counter;
+    dev->stream.anchor_tick = rtt_now() + US_TO_RTT_TICKS((uint32_t)dev->frame_chirps * CHIRP_TIME_US);
+    dev->stream.fill = 0;
+    dev->stream.fill_tick = rtt_now();
+}
+
+/*
+ * Continuous mode: restart the sequence after a FIFO overflow. The
+ * frames the sensor's cadence would have completed until the first
+ * frame of the new sequence are counted as missed (at least the one
+ * that overflowed), so indices stay on the frame grid.
+ */
+static void stream_recover(radar_dev_t *dev)
+{
+    uint32_t period_ticks = US_TO_RTT_TICKS(dev->stream.period_us);
+    uint32_t last_tick = dev->stream.anchor_tick;
+    uint32_t last_index = dev->stream.anchor_index;
+
+    radar_dev_reset_fifo(dev);
+    avian_main(dev, AVIAN_MAIN_FRAME_START);
+    stream_anchor_start(dev);
+
+    uint32_t index = last_index;
+    if (period_ticks > 0) {
+        index += (dev->stream.anchor_tick - last_tick + period_ticks / 2) / period_ticks;
+    }
+    if (index <= dev->frame_counter) {
+        index = dev->frame_counter + 1;
+    }
+
+    dev->stream.missed += index - dev->frame_counter;
+    dev->stream.gap += index - dev->frame_counter;
+    dev->stream.restarts++;
+    dev->frame_counter = index;
+    dev->stream.anchor_index = index;
+}
+
+/*
+ * Continuous mode: index of the last frame completed by `now` on the
+ * anchor grid, and the RTT ticks since its completion in *phase
+ */
+static uint32_t stream_grid(const radar_dev_t *dev, uint32_t now, uint32_t *phase)
+{
+    int32_t period = (int32_t)US_TO_RTT_TICKS(dev->stream.period_us);
+    int32_t since = (int32_t)(now - dev->stream.anchor_tick);
+    int32_t k = since / period;
+
+    if (since < 0 && k * period != since) {
+        k--;                                /* Floor */
+    }
+    *phase = (uint32_t)(since - k * period);
+    return dev->stream.anchor_index + (uint32_t)k;
+}
+
+/*
+ * Continuous mode: whether the acquisition leaves a usable gap between
+ * frames (at least a guard on either side)
+ */
+static bool stream_has_gap(const radar_dev_t *dev)
+{
+    uint32_t period = US_TO_RTT_TICKS(dev->stream.period_us);
+    uint32_t acquisition = US_TO_RTT_TICKS((uint32_t)dev->frame_chirps * CHIRP_TIME_US);
+
+    return period > 0 && acquisition + 2 * STREAM_GUARD_TICKS(period) < period;
+}
+
+/*
+ * Continuous mode: FIFO error at readout. The frames queued ahead of
+ * the overflowed one are complete and are drained first (the FIFO
+ * level from the last status read says how many); the FIFO reset then
+ * waits for a gap between frames, so the FSM and with it the frame
+ * grid keep running. Without a usable gap (acquisition fills the
+ * period) the sequence is restarted instead.
+ */
+static void stream_overflow(radar_dev_t *dev)
+{
+    if (!dev->stream.timing) {
+        dev->stream.overflow_tick = rtt_now();
+        dev->stream.timing = true;
+    }
+
+    if (!stream_has_gap(dev)) {
+        stream_recover(dev);
+        return;
+    }
+
+    dev->stream.resync = true;
+    dev->stream.salvage = dev->stream.fill / SAMPLES_PER_FRAME(dev);
+}
+
+/*
+ * Continuous mode: whether the grid puts the sensor between frames now
+ * (the last one completed at least a guard ago, the next acquisition
+ * starts at least a guard from now); *next is the next frame's index
+ */
+static bool stream_in_gap(const radar_dev_t *dev, uint32_t now, uint32_t *next)
+{
+    uint32_t period = US_TO_RTT_TICKS(dev->stream.period_us);
+    uint32_t acquisition = US_TO_RTT_TICKS((uint32_t)dev->frame_chirps * CHIRP_TIME_US);
+    uint32_t guard = STREAM_GUARD_TICKS(period);
+    uint32_t phase;
+
+    *next = stream_grid(dev, now, &phase) + 1;
+    return phase >= guard && phase + guard <= period - acquisition;
+}
+
+/*
+ * Continuous mode, after an overflow: reset the FIFO alone once the
+ * sensor is between frames. Whatever the FIFO holds now sits behind
+ * the overflowed frame's partial data and is lost with it; the next
+ * frame lands clean.
+ */
+static void stream_resync(radar_dev_t *dev)
+{
+    uint32_t now = rtt_now();
+    uint32_t next;
+
+    if (!stream_in_gap(dev, now, &next)) {
+        return;
+    }
+
+    avian_main(dev, AVIAN_MAIN_FIFO_RESET);     /* Self-clearing; the FSM keeps running */
+
+    uint32_t lost = ((int32_t)(next - dev->frame_counter) > 0) ? next - dev->frame_counter : 0;
+    dev->frame_counter += lost;
+    dev->stream.missed += lost;
+    dev->stream.gap += lost;
+    dev->stream.recoveries++;
+    dev->stream.resync = false;
+    dev->stream.fill = 0;
+    dev->stream.fill_tick = now;
+    trace_event(TRACE_FIFO_RESYNC, (uint16_t)lost);
+}
+
+/*
+ * IF gain: write a requested setting while no frame is being acquired.
+ * One change at a time: the next waits until the frames acquired with
+ * the previous setting were read (frame tags, clutter map).
+ */
+static void gain_poll(radar_dev_t *dev)
+{
+    radar_gain_t *g = &dev->gain;
+    uint32_t from;
+
+    if (!g->pending || g->clutter_stale) {
+        return;
+    }
+    if (!dev->acquisition_running) {
+        from = dev->frame_counter;
+    } else if (!dev->stream.continuous || dev->stream.resync) {
+        return;
+    } else if (!stream_in_gap(dev, rtt_now(), &from)) {
+        if (stream_has_gap(dev)) {
+            return;
+        }
+        from++;                             /* No gap: the frame in flight is mixed */
+    }
 
-        avian_write_reg(addr, value);
-        delay_ms(1);
+    uint32_t csx2 = avian_reg_get(dev, AVIAN_REG_CSU1_2);
+    for (int n = 0; n < RADAR_NUM_RX_ANTENNAS; n++) {
+        csx2 &= ~((AVIAN_CSX_2_HPF_SEL_MASK << AVIAN_CSX_2_HPF_SEL_POS(n)) |
+                  (AVIAN_CSX_2_VGA_GAIN_MASK << AVIAN_CSX_2_VGA_GAIN_POS(n)));
+        csx2 |= ((uint32_t)g->next_hpf << AVIAN_CSX_2_HPF_SEL_POS(n)) |
+                ((uint32_t)g->next_vga << AVIAN_CSX_2_VGA_GAIN_POS(n));
     }
+    if (avian_reg_stage(dev, AVIAN_REG_CSU1_2, csx2)) {
+        avian_reg_flush(dev);
+    }
+
+    g->prev_vga = g->vga;
+    g->prev_hpf = g->hpf;
+    g->vga = g->next_vga;
+    g->hpf = g->next_hpf;
+    g->from_index = from;
+    g->pending = false;
+    g->clutter_stale = true;
+    g->steps++;
+    trace_event(TRACE_IF_GAIN, (uint16_t)(g->vga | (g->hpf << 8)));
+}
 
-    /* 6. Initialize frame buffer */
-    memset(&current_frame, 0, sizeof(current_frame));
-    current_frame.valid = false;
-    acquisition_running = false;
-    frame_counter = 0;
+/*
+ * Clutter map (raw ADC codes around mid-scale, Q16) from one VGA gain
+ * to another: 10^(5/20) per step
+ */
+static void clutter_scale(int32_t *dst, const int32_t *src, uint8_t from_vga, uint8_t to_vga)
+{
+    int64_t scale = 1 << 16;
+    int steps = (to_vga > from_vga) ? to_vga - from_vga : from_vga - to_vga;
 
+    for (int k = 0; k < steps; k++) {
+        scale = (scale * 116541) >> 16;         /* 10^(5/20), Q16 */
+    }
+    if (to_vga < from_vga) {
+        scale = ((int64_t)1 << 32) / scale;
+    }
+    int32_t mid = (int32_t)RADAR_ADC_MID << 16;
+    for (int s = 0; s < RADAR_NUM_SAMPLES; s++) {
+        dst[s] = mid + (int32_t)(((int64_t)(src[s] - mid) * scale) >> 16);
+    }
+}
+
+/*
+ * IF gain: the first frame acquired with the new setting is about to be
+ * unpacked. The clutter map follows a gain step; a new high-pass
+ * changes its shape, so it is reseeded.
+ */
+static void gain_clutter_update(radar_dev_t *dev)
+{
+    radar_gain_t *g = &dev->gain;
+
+    if (g->hpf != g->prev_hpf) {
+        dev->clutter_seeded = false;
+    } else if (g->vga != g->prev_vga && dev->clutter_seeded) {
+        clutter_scale(dev->clutter_map, dev->clutter_map, g->prev_vga, g->vga);
+    }
+    g->clutter_stale = false;
+}
+
+static const uint8_t hpf_khz[AVIAN_HPF_SEL_MAX + 1] = { 20, 45, 70, 80, 160 };
+
+uint8_t radar_hpf_khz(uint8_t hpf)
+{
+    return hpf_khz[hpf <= AVIAN_HPF_SEL_MAX ? hpf : AVIAN_HPF_SEL_MAX];
+}
+
+bool radar_dev_set_if_gain(radar_dev_t *dev, uint8_t vga, uint8_t hpf)
+{
+    if (!dev->gain.ref_valid || vga > AVIAN_VGA_GAIN_MAX || hpf > AVIAN_HPF_SEL_MAX) {
+        return false;
+    }
+    dev->gain.next_vga = vga;
+    dev->gain.next_hpf = hpf;
+    dev->gain.pending = (vga != dev->gain.vga) || (hpf != dev->gain.hpf);
+    gain_poll(dev);
     return true;
 }
 
 /*
  * Start continuous frame acquisition
  */
-void radar_start(void)
+void radar_dev_start(radar_dev_t *dev)
 {
+    /* Frame count 0: the sensor repeats frames until stopped */
+    avian_reg_stage(dev, AVIAN_REG_CCR2, avian_reg_get(dev, AVIAN_REG_CCR2) & ~AVIAN_CCR2_MAX_FRAME_CNT_MASK);
+    avian_reg_flush(dev);
+
     /* Reset FIFO before starting */
-    radar_reset_fifo();
+    radar_dev_reset_fifo(dev);
 
     /* Start frame acquisition */
-    avian_write_reg(AVIAN_REG_MAIN, AVIAN_MAIN_FRAME_START);
-    acquisition_running = true;
+    avian_main(dev, AVIAN_MAIN_FRAME_START);
+    dev->acquisition_running = true;
+    dev->stream.continuous = true;
+    dev->stream.resync = false;
+    dev->stream.gap = 0;
+    dev->stream.timing = false;
+    stream_anchor_start(dev);
 }
 
 /*
  * Trigger single frame acquisition
  */
-void radar_start_frame(void)
+void radar_dev_start_frame(radar_dev_t *dev)
 {
-    if (!acquisition_running) {
+    if (!dev->acquisition_running) {
         /* Reset FIFO and start new frame */
-        radar_reset_fifo();
-        avian_write_reg(AVIAN_REG_MAIN, AVIAN_MAIN_FRAME_START);
-        acquisition_running = true;
+        radar_dev_reset_fifo(dev);
+        avian_main(dev, AVIAN_MAIN_FRAME_START);
+        dev->acquisition_running = true;
+    }
+}
+
+/*
+ * Trigger single frame without resetting FIFO/FSM
+ */
+void radar_dev_trigger_frame(radar_dev_t *dev)
+{
+    if (!dev->acquisition_running) {
+        avian_main(dev, AVIAN_MAIN_FRAME_START);
+        dev->acquisition_running = true;
     }
 }
 
+/*
+ * Select sensor power mode between frames
+ */
+void radar_dev_set_frame_power(radar_dev_t *dev, radar_frame_power_t mode)
+{
+    uint32_t ccr1 = avian_reg_get(dev, AVIAN_REG_CCR1) & ~AVIAN_CCR1_PD_MODE_MASK;
+    uint32_t ccr2 = avian_reg_get(dev, AVIAN_REG_CCR2) & ~AVIAN_CCR2_MAX_FRAME_CNT_MASK;
+
+    if (mode == RADAR_FRAME_POWER_DEEP_SLEEP) {
+        ccr1 |= (uint32_t)AVIAN_PD_MODE_DEEP_SLEEP << AVIAN_CCR1_PD_MODE_POS;
+        ccr2 |= 1;  /* Single frame, then enter PD_MODE */
+    } else {
+        ccr1 |= (uint32_t)AVIAN_PD_MODE_ACTIVE << AVIAN_CCR1_PD_MODE_POS;
+    }
+
+    /* Registers only take effect on the next FRAME_START */
+    radar_dev_stop(dev);
+    avian_reg_stage(dev, AVIAN_REG_CCR1, ccr1);
+    avian_reg_stage(dev, AVIAN_REG_CCR2, ccr2);
+    avian_reg_flush(dev);
+}
+
+/*
+ * Reprogram chirps per frame and frame repetition period
+ */
+bool radar_dev_set_frame_timing(radar_dev_t *dev, uint16_t num_chirps, uint32_t frame_period_us)
+{
+    uint32_t acquisition_us = (uint32_t)num_chirps * CHIRP_TIME_US;
+
+    if (num_chirps < 2 || num_chirps > RADAR_NUM_CHIRPS ||
+        (dev->frame.samples && (uint32_t)num_chirps * RADAR_NUM_SAMPLES > dev->frame_capacity) ||
+        frame_period_us <= acquisition_us) {
+        return false;
+    }
+
+    /* Encode frame end delay: TR_FED * 8 * 2^MUL clocks, TR_FED <= 255 */
+    uint32_t clocks = (uint32_t)(((uint64_t)(frame_period_us - acquisition_us) *
+                                  (AVIAN_SYS_CLK_HZ / 1000000UL)) / 8);
+    uint32_t mul = 0;
+    while (clocks > AVIAN_CCR1_TR_FED_MASK) {
+        clocks >>= 1;
+        mul++;
+    }
+    if (mul > (AVIAN_CCR1_TR_FED_MUL_MASK >> AVIAN_CCR1_TR_FED_MUL_POS)) {
+        return false;
+    }
+
+    uint32_t ccr1 = avian_reg_get(dev, AVIAN_REG_CCR1) &
+                    ~(AVIAN_CCR1_TR_FED_MASK | AVIAN_CCR1_TR_FED_MUL_MASK);
+    ccr1 |= clocks | (mul << AVIAN_CCR1_TR_FED_MUL_POS);
+
+    uint32_t ccr2 = avian_reg_get(dev, AVIAN_REG_CCR2) & ~AVIAN_CCR2_FRAME_LEN_MASK;
+    ccr2 |= (uint32_t)(num_chirps - 1) << AVIAN_CCR2_FRAME_LEN_POS;
+
+    /* Unchanged values (same profile again) cost no SPI traffic */
+    avian_reg_stage(dev, AVIAN_REG_CCR1, ccr1);
+    avian_reg_stage(dev, AVIAN_REG_CCR2, ccr2);
+    avian_reg_flush(dev);
+    dev->frame_chirps = num_chirps;
+    dev->stream.period_us = frame_period_us;
+
+    /* A running sequence keeps its timing until restarted */
+    if (dev->stream.continuous) {
+        radar_dev_start(dev);
+    }
+
+    return true;
+}
+
+/*
+ * Select static clutter removal
+ */
+void radar_dev_set_clutter_filter(radar_dev_t *dev, radar_clutter_t mode)
+{
+    dev->clutter_mode = mode;
+    dev->clutter_seeded = false;
+}
+
+bool radar_dev_get_clutter_map(const radar_dev_t *dev, int32_t *map)
+{
+    if (!dev->clutter_seeded) {
+        return false;
+    }
+    clutter_scale(map, dev->clutter_map, dev->gain.vga, dev->gain.ref_vga);
+    return true;
+}
+
+void radar_dev_set_clutter_map(radar_dev_t *dev, const int32_t *map)
+{
+    clutter_scale(dev->clutter_map, map, dev->gain.ref_vga, dev->gain.vga);
+    dev->clutter_seeded = true;
+}
+
+static uint32_t fnv1a_word(uint32_t hash, uint32_t word)
+{
+    for (int b = 0; b < 4; b++) {
+        hash ^= (word >> (8 * b)) & 0xFF;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+/*
+ * FNV-1a over the exported register words, the clutter mode and the
+ * running frame timing and baseband setting from the shadow (CCR1,
+ * CCR2, CSU1_2). Left out: power mode and frame count (switched by the
+ * power scheduler), and the AGC's VGA gain and high-pass, replaced by
+ * the reference setting that frames and clutter map are scaled to
+ * (as written while the reference is invalid and the gain fixed).
+ */
+uint32_t radar_dev_config_hash(const radar_dev_t *dev)
+{
+    uint32_t hash = 2166136261UL;
+
+    for (uint32_t i = 0; i < AVIAN_NUM_REGS; i++) {
+        hash = fnv1a_word(hash, avian_register_config[i]);
+    }
+    hash = fnv1a_word(hash, (uint32_t)dev->clutter_mode);
+
+    uint32_t csx2 = dev->shadow.value[AVIAN_REG_CSU1_2];
+    for (int n = 0; n < RADAR_NUM_RX_ANTENNAS && dev->gain.ref_valid; n++) {
+        csx2 &= ~((AVIAN_CSX_2_HPF_SEL_MASK << AVIAN_CSX_2_HPF_SEL_POS(n)) |
+                  (AVIAN_CSX_2_VGA_GAIN_MASK << AVIAN_CSX_2_VGA_GAIN_POS(n)));
+        csx2 |= ((uint32_t)dev->gain.ref_hpf << AVIAN_CSX_2_HPF_SEL_POS(n)) |
+                ((uint32_t)dev->gain.ref_vga << AVIAN_CSX_2_VGA_GAIN_POS(n));
+    }
+    hash = fnv1a_word(hash, dev->shadow.value[AVIAN_REG_CCR1] & ~AVIAN_CCR1_PD_MODE_MASK);
+    hash = fnv1a_word(hash, dev->shadow.value[AVIAN_REG_CCR2] & ~AVIAN_CCR2_MAX_FRAME_CNT_MASK);
+    hash = fnv1a_word(hash, csx2);
+
+    return hash;
+}
+
 /*
  * Stop frame acquisition
  */
-void radar_stop(void)
+void radar_dev_stop(radar_dev_t *dev)
 {
-    avian_write_reg(AVIAN_REG_MAIN, 0);
-    acquisition_running = false;
+    avian_main(dev, 0);
+    dev->acquisition_running = false;
+    dev->stream.continuous = false;
+    dev->stream.resync = false;
 }
 
 /*
  * Reset the FIFO
  */
-void radar_reset_fifo(void)
+void radar_dev_reset_fifo(radar_dev_t *dev)
+{
+    avian_main(dev, AVIAN_MAIN_FIFO_RESET | AVIAN_MAIN_FSM_RESET);
+    delay_ms(1);
+    avian_main(dev, 0);
+    dev->frame.valid = false;
+}
+
+void radar_dev_rearm(radar_dev_t *dev)
 {
-    avian_write_reg(AVIAN_REG_MAIN, AVIAN_MAIN_FIFO_RESET | AVIAN_MAIN_FSM_RESET);
+    if (dev->stream.continuous) {
+        return;     /* The sensor's own frame repetition is running */
+    }
+    avian_main(dev, AVIAN_MAIN_FIFO_RESET | AVIAN_MAIN_FSM_RESET);
     delay_ms(1);
-    avian_write_reg(AVIAN_REG_MAIN, 0);
-    current_frame.valid = false;
+    avian_main(dev, 0);
+    avian_main(dev, AVIAN_MAIN_FRAME_START);
+    dev->acquisition_running = true;
+}
+
+uint32_t radar_dev_fifo_status(radar_dev_t *dev)
+{
+    uint32_t fstat = avian_read_reg(dev, AVIAN_REG_FSTAT);
+    uint16_t fill = fstat & AVIAN_FSTAT_FILL_MASK;
+    uint32_t now = rtt_now();
+
+    /* Continuous mode: a frame seen completing between two close polls
+     * re-anchors the index grid against the RTT (keeps clock drift
+     * out of recovery) */
+    if (dev->stream.continuous && dev->stream.fill < SAMPLES_PER_FRAME(dev) &&
+        fill >= SAMPLES_PER_FRAME(dev) && fill < 2 * SAMPLES_PER_FRAME(dev) &&
+        !(fstat & AVIAN_FSTAT_FOU_ERR) &&
+        now - dev->stream.fill_tick <= US_TO_RTT_TICKS(dev->stream.period_us) / 16) {
+        dev->stream.anchor_index = dev->frame_counter;
+        dev->stream.anchor_tick = now;
+    }
+    dev->stream.fill = fill;
+    dev->stream.fill_tick = now;
+
+    return fstat;
+}
+
+uint16_t radar_dev_frame_samples(const radar_dev_t *dev)
+{
+    return SAMPLES_PER_FRAME(dev);
 }
 
 /*
  * Check if frame is ready
  */
-bool radar_frame_ready(void)
+bool radar_dev_frame_ready(radar_dev_t *dev)
 {
-    if (!acquisition_running) {
+    if (!dev->acquisition_running) {
+        return false;
+    }
+
+    gain_poll(dev);
+
+    /* Overflow recovery: drain what is left, then wait for the gap */
+    if (dev->stream.resync) {
+        if (dev->stream.salvage > 0) {
+            return true;
+        }
+        stream_resync(dev);
         return false;
     }
 
     /* Check if FIFO has complete frame */
-    return avian_frame_complete();
+    return avian_frame_complete(dev);
 }
 
 /*
  * Get the current radar frame
  */
-const radar_frame_t* radar_get_frame(void)
+const radar_frame_t* radar_dev_get_frame(radar_dev_t *dev)
 {
-    if (!acquisition_running) {
+    radar_frame_t *frame = &dev->frame;
+
+    if (!dev->acquisition_running || dev->frame_capacity < SAMPLES_PER_FRAME(dev)) {
         return NULL;
     }
 
-    /* Check for FIFO errors */
-    if (avian_check_fifo_error()) {
-        /* FIFO overflow - reset and return NULL */
-        radar_reset_fifo();
-        acquisition_running = false;
-        return NULL;
+    bool salvage = dev->stream.resync;
+    if (salvage && dev->stream.salvage == 0) {
+        return NULL;                        /* Waiting for the gap (radar_dev_frame_ready) */
     }
 
-    /* Read samples from FIFO */
-    if (!avian_read_fifo(current_frame.samples, SAMPLES_PER_FRAME)) {
-        /* Read error */
-        radar_reset_fifo();
-        acquisition_running = false;
-        return NULL;
+    radar_gain_t *gain = &dev->gain;
+    if (gain->clutter_stale && (int32_t)(dev->frame_counter - gain->from_index) >= 0) {
+        gain_clutter_update(dev);
+    }
+
+    /* Read samples from FIFO. No separate FSTAT read: the GSR0 byte
+     * returned with the burst command carries the FIFO error flag */
+    trace_event(TRACE_FRAME_READY, (uint16_t)dev->frame_counter);
+    if (!avian_read_fifo(dev, SAMPLES_PER_FRAME(dev), salvage)) {
+        trace_event(TRACE_FIFO_ERROR, dev->shadow.gsr0);
+        dev->fifo_errors++;
+        if (!dev->stream.continuous) {
+            /* FIFO overflow - reset and return NULL */
+            radar_dev_reset_fifo(dev);
+            dev->acquisition_running = false;
+            return NULL;
+        }
+
+        stream_overflow(dev);               /* Stays running */
+        salvage = dev->stream.resync;
+        if (!salvage || dev->stream.salvage == 0) {
+            return NULL;
+        }
+        avian_read_fifo(dev, SAMPLES_PER_FRAME(dev), true);
     }
 
     /* Mark frame as valid */
-    current_frame.valid = true;
-    current_frame.timestamp = frame_counter++;
+    frame->num_chirps = dev->frame_chirps;
+    frame->valid = true;
+    frame->timestamp = dev->frame_counter++;
+    frame->gap = dev->stream.gap;
+    dev->stream.gap = 0;
+
+    bool new_gain = (int32_t)(frame->timestamp - gain->from_index) >= 0;
+    uint8_t vga = new_gain ? gain->vga : gain->prev_vga;
+    frame->gain_db = (int8_t)(((int)vga - (int)gain->ref_vga) * AVIAN_VGA_STEP_DB);
+    frame->hpf_khz = radar_hpf_khz(new_gain ? gain->hpf : gain->prev_hpf);
+    frame->hpf_ref_khz = radar_hpf_khz(gain->ref_hpf);
+
+    if (salvage) {
+        dev->stream.salvage--;
+        return frame;
+    }
+
+    if (dev->stream.continuous) {
+        if (dev->stream.timing) {
+            uint32_t ticks = rtt_now() - dev->stream.overflow_tick;
+            dev->stream.recovery_ticks = ticks;
+            if (ticks > dev->stream.recovery_ticks_max) {
+                dev->stream.recovery_ticks_max = ticks;
+            }
+            dev->stream.timing = false;
+        }
+
+        /* Next frame already (partly) recorded: drained late */
+        if (dev->stream.fill > SAMPLES_PER_FRAME(dev)) {
+            dev->stream.late++;
+            dev->stream.fill -= SAMPLES_PER_FRAME(dev);
+        } else {
+            dev->stream.fill = 0;
+        }
+        return frame;
+    }
 
     /* Stop acquisition (will be restarted by radar_start_frame) */
-    acquisition_running = false;
+    dev->acquisition_running = false;
+    gain_poll(dev);
+
+    return frame;
+}
 
-    return &current_frame;
+/*
+ * Single-sensor API on the default device
+ */
+radar_dev_t* radar_default_dev(void)
+{
+    return &default_dev;
+}
+
+void radar_start(void)
+{
+    radar_dev_start(&default_dev);
+}
+
+void radar_stop(void)
+{
+    radar_dev_stop(&default_dev);
+}
+
+void radar_start_frame(void)
+{
+    radar_dev_start_frame(&default_dev);
+}
+
+void radar_trigger_frame(void)
+{
+    radar_dev_trigger_frame(&default_dev);
+}
+
+void radar_set_frame_power(radar_frame_power_t mode)
+{
+    radar_dev_set_frame_power(&default_dev, mode);
+}
+
+bool radar_set_frame_timing(uint16_t num_chirps, uint32_t frame_period_us)
+{
+    return radar_dev_set_frame_timing(&default_dev, num_chirps, frame_period_us);
+}
+
+void radar_set_clutter_filter(radar_clutter_t mode)
+{
+    radar_dev_set_clutter_filter(&default_dev, mode);
+}
+
+bool radar_get_clutter_map(int32_t *map)
+{
+    return radar_dev_get_clutter_map(&default_dev, map);
+}
+
+void radar_set_clutter_map(const int32_t *map)
+{
+    radar_dev_set_clutter_map(&default_dev, map);
+}
+
+uint32_t radar_config_hash(void)
+{
+    return radar_dev_config_hash(&default_dev);
+}
+
+void radar_reset_fifo(void)
+{
+    radar_dev_reset_fifo(&default_dev);
+}
+
+bool radar_frame_ready(void)
+{
+    return radar_dev_frame_ready(&default_dev);
+}
+
+const radar_frame_t* radar_get_frame(void)
+{
+    return radar_dev_get_frame(&default_dev);
 }
@@ -1,6 +1,11 @@
 /*
  * Avian Radar Driver for BGT60TR13C
  * Handles sensor initialization and frame acquisition
+ *
+ * All sensor state lives in a radar_dev_t, so several BGT60s can share
+ * SPI0 with one chip select each (radar_dev_* API, scheduled by
+ * radar_bus.h). The radar_* functions without a device operate on the
+ * default device on SPI_CS_DEFAULT.
  */
 
 #ifndef AVIAN_RADAR_H
@@ -8,16 +13,22 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "spi.h"
 
 /* Avian register addresses */
 #define AVIAN_REG_MAIN          0x00
 #define AVIAN_REG_ADC0          0x01
 #define AVIAN_REG_CHIP_ID       0x02
-#define AVIAN_REG_STAT0         0x03
-#define AVIAN_REG_STAT1         0x04
-#define AVIAN_REG_PACR1         0x05
-#define AVIAN_REG_PACR2         0x06
-#define AVIAN_REG_SFCTL         0x07
+#define AVIAN_REG_STAT1         0x03
+#define AVIAN_REG_PACR1         0x04
+#define AVIAN_REG_PACR2         0x05
+#define AVIAN_REG_SFCTL         0x06
+#define AVIAN_REG_SADC_CTRL     0x07
+#define AVIAN_REG_CSU1_2        0x12    /* Active chirp baseband: high-pass, gain */
+#define AVIAN_REG_CCR0          0x2C    /* Chirp/frame control */
+#define AVIAN_REG_CCR1          0x2D
+#define AVIAN_REG_CCR2          0x2E
+#define AVIAN_REG_CCR3          0x2F
 #define AVIAN_REG_FSTAT         0x5A    /* FIFO status register */
 
 /* Main control register bits */
@@ -25,6 +36,52 @@
 #define AVIAN_MAIN_SW_RESET     (1 << 1)
 #define AVIAN_MAIN_FSM_RESET    (1 << 2)
 #define AVIAN_MAIN_FIFO_RESET   (1 << 3)
+#define AVIAN_MAIN_CMD_MASK     0x0F    /* Self-clearing command bits; the rest is configuration */
+
+/* GSR0: status byte clocked out with the first byte of every transaction */
+#define AVIAN_GSR0_CLOCK_NUMBER_ERR (1 << 0)
+#define AVIAN_GSR0_SPI_BURST_ERR    (1 << 1)
+#define AVIAN_GSR0_MISO_HS_READ     (1 << 2)
+#define AVIAN_GSR0_FOU_ERR          (1 << 3)    /* FIFO overflow/underflow */
+
+/* Register file below the FIFO address, mirrored by the driver */
+#define AVIAN_NUM_REG_ADDR      0x60
+#define AVIAN_REG_BURST_MIN     4       /* Registers from which a burst write beats single writes */
+
+/* CCR1: power mode entered after each frame */
+#define AVIAN_CCR1_PD_MODE_POS      22
+#define AVIAN_CCR1_PD_MODE_MASK     (0x3 << AVIAN_CCR1_PD_MODE_POS)
+#define AVIAN_PD_MODE_ACTIVE        0   /* Stay active */
+#define AVIAN_PD_MODE_IDLE          1   /* Idle (PLL off) */
+#define AVIAN_PD_MODE_DEEP_SLEEP    2   /* Deep sleep (only SPI alive) */
+
+/* CCR1: frame end delay = TR_FED * 8 * 2^TR_FED_MUL system clocks */
+#define AVIAN_CCR1_TR_FED_MASK      0xFF
+#define AVIAN_CCR1_TR_FED_MUL_POS   8
+#define AVIAN_CCR1_TR_FED_MUL_MASK  (0x1F << AVIAN_CCR1_TR_FED_MUL_POS)
+#define AVIAN_SYS_CLK_HZ            80000000UL
+
+/* CCR2: number of frames per FRAME_START (0 = run forever) */
+#define AVIAN_CCR2_MAX_FRAME_CNT_MASK   0xFFF
+#define AVIAN_CCR2_FRAME_LEN_POS        12      /* Chirps per frame - 1 */
+#define AVIAN_CCR2_FRAME_LEN_MASK       (0x3F << AVIAN_CCR2_FRAME_LEN_POS)
+
+/* CSU1_2: per RX channel n (0..2) high-pass cut-off and VGA gain;
+ * total IF gain = HP gain (18/30 dB, left as exported) + VGA gain */
+#define AVIAN_CSX_2_HPF_SEL_POS(n)  (4 * (n))
+#define AVIAN_CSX_2_HPF_SEL_MASK    0x7
+#define AVIAN_CSX_2_VGA_GAIN_POS(n) (12 + 3 * (n))
+#define AVIAN_CSX_2_VGA_GAIN_MASK   0x7
+#define AVIAN_HPF_SEL_MAX           4       /* 20, 45, 70, 80, 160 kHz */
+#define AVIAN_VGA_GAIN_MAX          6       /* 0..30 dB */
+#define AVIAN_VGA_STEP_DB           5
+
+/* SFCTL: SPI / FIFO control */
+#define AVIAN_SFCTL_MISO_HS_READ    (1UL << 20) /* MISO shifted for high-speed reads */
+#define AVIAN_SFCTL_LFSR_EN         (1UL << 17) /* FIFO reads return the test pattern */
+
+/* FIFO test pattern: 12-bit Fibonacci LFSR x^12 + x^11 + x^10 + x^4 + 1 */
+#define AVIAN_TEST_PATTERN_SEED     0x001
 
 /* STAT1 register bits */
 #define AVIAN_STAT1_FRAME_END   (1 << 0)
@@ -41,32 +98,347 @@
 
 /* Radar configuration for presence detection
  * Must match values from Radar Fusion GUI export
+ * RADAR_FRAME_SIZE is the full frame of all antennas; the frame buffer
+ * is sized for what is actually read (radar_dev_set_frame_buffer).
  */
 #define RADAR_NUM_SAMPLES       64
-#define RADAR_NUM_CHIRPS        64
+#define RADAR_NUM_CHIRPS        64      /* Maximum; runtime value in radar_frame_t */
 #define RADAR_NUM_RX_ANTENNAS   3
 #define RADAR_FRAME_SIZE        (RADAR_NUM_SAMPLES * RADAR_NUM_CHIRPS * RADAR_NUM_RX_ANTENNAS)
 
 /* FIFO burst read address */
 #define AVIAN_FIFO_READ_ADDR    0x60
 
+/* Clutter map update: alpha = 2^-RADAR_CLUTTER_SHIFT per frame (~80 s at 13 Hz) */
+#define RADAR_CLUTTER_SHIFT     10
+
+/* Chirp checks in unpack: a chirp is interference when its mean square
+ * exceeds RADAR_CHIRP_OUTLIER x the frame's median chirp (plus a floor),
+ * or when it has RADAR_CHIRP_CLIP_SAMPLES clipped samples while fewer
+ * than a quarter of the chirps do (saturation of the whole frame is a
+ * strong target, not interference) */
+#define RADAR_ADC_MAX           4095    /* 12-bit full scale */
+#define RADAR_ADC_MID           2048
+#define RADAR_CHIRP_OUTLIER     8       /* ~9 dB */
+#define RADAR_CHIRP_FLOOR       16      /* Mean square floor (4 LSB rms) */
+#define RADAR_CHIRP_CLIP_SAMPLES 8
+
+/* radar_frame_t flags */
+#define RADAR_FRAME_CLIPPED     0x01    /* Samples at ADC full scale */
+#define RADAR_FRAME_INTERFERENCE 0x02   /* Chirps failed the checks and were replaced */
+
+/* SPI link training */
+#define RADAR_LINK_TEST_WORDS   1024    /* Test pattern words per step (1536 bytes) */
+#define RADAR_LINK_READBACKS    8       /* Register reads compared per step */
+#define RADAR_LINK_REPEATS      3       /* Passes required at the chosen setting */
+
+/*
+ * Sensor behaviour between frames
+ */
+typedef enum {
+    RADAR_FRAME_POWER_ACTIVE = 0,   /* Free-running frames, sensor stays active */
+    RADAR_FRAME_POWER_DEEP_SLEEP    /* One frame per trigger, deep sleep after it */
+} radar_frame_power_t;
+
+/*
+ * Static clutter removal applied while unpacking
+ */
+typedef enum {
+    RADAR_CLUTTER_NONE = 0,         /* Raw samples (offset binary re-centred) */
+    RADAR_CLUTTER_CHIRP_MEAN,       /* Subtract each chirp's mean (DC) */
+    RADAR_CLUTTER_MTI               /* Chirp mean + slow-time mean-chirp (clutter map) */
+} radar_clutter_t;
+
+/*
+ * Per-chirp statistics, a by-product of the unpack pass
+ */
+typedef struct {
+    uint32_t energy;                    /* Mean square of the unpacked chirp (as received) */
+    uint16_t min;                       /* Raw ADC code range */
+    uint16_t max;
+    int16_t mean;                       /* Chirp mean removed (0 without clutter removal) */
+    uint8_t clips;                      /* Samples at 0 or RADAR_ADC_MAX */
+    bool bad;                           /* Replaced: interpolated from its neighbours, or zeroed */
+} radar_chirp_stats_t;
+
 /*
  * Radar frame data structure
  */
 typedef struct {
-    int16_t samples[RADAR_FRAME_SIZE];  /* Raw ADC samples (12-bit unpacked to 16-bit) */
+    int16_t *samples;                   /* Raw ADC samples (12-bit unpacked to 16-bit), chirp-major */
     uint32_t timestamp;
+    uint32_t motion_energy;             /* Mean squared chirp-to-chirp difference (from unpack) */
+    uint16_t num_chirps;                /* Chirps in this frame (<= RADAR_NUM_CHIRPS) */
+    uint16_t gap;                       /* Frames lost right before this one (FIFO overflow) */
+    uint8_t flags;                      /* RADAR_FRAME_* (chirp checks) */
+    uint8_t bad_chirps;                 /* Chirps replaced */
+    uint16_t clips;                     /* Clipped samples in the frame */
+    uint16_t peak;                      /* Largest raw excursion from RADAR_ADC_MID */
+    uint32_t chirp_energy;              /* Median chirp mean square */
+    const radar_chirp_stats_t *chirp_stats;     /* num_chirps entries */
+    int8_t gain_db;                     /* IF gain acquired with, relative to the export */
+    uint8_t hpf_khz;                    /* High-pass cut-off acquired with */
+    uint8_t hpf_ref_khz;                /* ... and the exported one */
     bool valid;
 } radar_frame_t;
 
 /*
- * Initialize radar sensor
+ * SPI link setting and error counters of one sensor
+ */
+typedef struct {
+    uint8_t scbr;                       /* SPI clock = MCK / scbr */
+    bool hs_read;                       /* Sensor MISO high-speed read */
+    bool wide;                          /* 16-bit SPI words */
+    uint32_t clock_hz;
+    uint16_t steps_tested;              /* Settings tried by the last training */
+    uint32_t readback_errors;           /* Register words read back wrong */
+    uint32_t pattern_errors;            /* Test pattern words read back wrong */
+    uint32_t checks;                    /* radar_dev_link_check() calls */
+    uint32_t check_failures;            /* ... that failed (and stepped the clock down) */
+} radar_link_t;
+
+/*
+ * Driver copy of the sensor registers
+ *
+ * value[] holds what was last written (or read) for every address whose
+ * bit is set in known[]. Writes through the shadow are skipped when the
+ * value is unchanged, and staged changes go out as one burst per run of
+ * contiguous addresses. MAIN holds only its configuration bits; commands
+ * are always sent. Status registers (FSTAT, STAT1) are never cached.
+ */
+typedef struct {
+    uint32_t value[AVIAN_NUM_REG_ADDR];
+    uint32_t known[(AVIAN_NUM_REG_ADDR + 31) / 32];
+    uint32_t dirty[(AVIAN_NUM_REG_ADDR + 31) / 32];    /* Staged, not yet written */
+    uint8_t gsr0;                       /* Status byte of the last transaction */
+
+    /* Statistics */
+    uint32_t words_written;             /* Register words sent */
+    uint32_t words_skipped;             /* Writes dropped as unchanged */
+    uint32_t bursts;                    /* Burst writes */
+    uint32_t reads_saved;               /* Reads answered from the shadow */
+} radar_shadow_t;
+
+/*
+ * Continuous acquisition (radar_dev_start): the sensor's frame
+ * repetition (CCR2 MAX_FRAME_CNT = 0, period from CCR1 frame-end delay)
+ * runs without software re-arm and the driver drains one frame per
+ * radar_dev_get_frame(). Frame timestamps are frame indices on the
+ * sensor's cadence; frames lost to a FIFO overflow advance the index.
+ *
+ * A FIFO overflow does not stop the sequence: the complete frames
+ * queued ahead of the overflowed one are still drained, then the FIFO
+ * alone is reset in the gap between two frames (on the anchor grid)
+ * and the next frame is clean. The frame after a recovery carries the
+ * number of frames lost in frame.gap.
+ */
+typedef struct {
+    bool continuous;
+    uint32_t period_us;                 /* Frame period (radar_dev_set_frame_timing) */
+    uint16_t fill;                      /* FIFO level seen by the last status read */
+    uint32_t fill_tick;                 /* RTT tick of that read */
+
+    /* Index anchor for recovery: frame `anchor_index` completes at RTT `anchor_tick` */
+    uint32_t anchor_index;
+    uint32_t anchor_tick;
+
+    /* Overflow recovery */
+    bool resync;                        /* Waiting for the gap before the next frame */
+    uint16_t salvage;                   /* Complete frames still to drain before the reset */
+    uint16_t gap;                       /* Frames lost, reported with the next frame */
+    bool timing;                        /* Recovery latency open until the next clean frame */
+    uint32_t overflow_tick;             /* RTT tick the overflow was seen */
+
+    /* Statistics */
+    uint32_t late;                      /* Drained with the next frame already in the FIFO */
+    uint32_t missed;                    /* Lost to FIFO overflow (estimated from the RTT) */
+    uint32_t restarts;                  /* Frame sequence restarts after an overflow */
+    uint32_t recoveries;                /* Overflows recovered with a FIFO reset alone */
+    uint32_t recovery_ticks;            /* Overflow to next clean frame, last (RTT ticks) */
+    uint32_t recovery_ticks_max;
+} radar_stream_t;
+
+/*
+ * IF gain and high-pass of the active chirp (CSU1_2 fields, all RX
+ * channels alike), set by the AGC. A change is written only between
+ * frames (at once while acquisition is stopped, in continuous mode in
+ * the gap on the anchor grid); frames carry the setting they were
+ * acquired with.
+ */
+typedef struct {
+    uint8_t vga;                        /* VGA_GAIN field in effect */
+    uint8_t hpf;                        /* HPF_SEL field in effect */
+    uint8_t prev_vga;                   /* For frames before from_index */
+    uint8_t prev_hpf;
+    uint8_t ref_vga;                    /* Decoded from the CSU1_2 last written by */
+    uint8_t ref_hpf;                    /* radar_dev_write_config */
+    bool ref_valid;                     /* Fields in range, all channels alike */
+    uint8_t next_vga;                   /* Requested */
+    uint8_t next_hpf;
+    bool pending;                       /* Waiting for a gap between frames */
+    bool clutter_stale;                 /* Clutter map still at the previous setting */
+    uint32_t from_index;                /* First frame acquired with vga / hpf */
+    uint32_t steps;                     /* Changes written */
+} radar_gain_t;
+
+/*
+ * One sensor: chip select, frame buffer and acquisition state
+ */
+typedef struct {
+    spi_cs_t cs;
+    radar_frame_t frame;
+    volatile bool acquisition_running;
+    volatile uint32_t frame_counter;    /* Index of the next frame */
+    uint16_t frame_chirps;
+    uint32_t frame_capacity;            /* Samples frame.samples can hold */
+    radar_stream_t stream;
+
+    /* Static clutter removal state */
+    radar_clutter_t clutter_mode;
+    int32_t clutter_map[RADAR_NUM_SAMPLES];     /* Mean chirp, Q16 */
+    bool clutter_seeded;
+
+    radar_chirp_stats_t chirp_stats[RADAR_NUM_CHIRPS];
+    radar_gain_t gain;
+
+    uint32_t fifo_errors;               /* Frames lost to FIFO overflow / read errors */
+    radar_link_t link;
+    radar_shadow_t shadow;
+} radar_dev_t;
+
+/*
+ * Pulse the (shared) sensor reset line; call once before radar_dev_init()
+ */
+void radar_hardware_reset(void);
+
+/*
+ * Initialize one sensor on chip select `cs`: detect, software reset,
+ * program the exported register configuration
+ * Returns true if initialization successful
+ */
+bool radar_dev_init(radar_dev_t *dev, const spi_cs_t *cs);
+
+/*
+ * Frame buffer for `num_samples` samples (RADAR_NUM_SAMPLES x the most
+ * chirps any profile uses), e.g. from the memory arena. Kept across
+ * radar_dev_init(); frames need one, and link training uses it as
+ * scratch. Frame timings that do not fit are rejected.
+ */
+void radar_dev_set_frame_buffer(radar_dev_t *dev, int16_t *buf, uint32_t num_samples);
+
+/*
+ * SPI link training: steps the clock up from SPI_SCBR_DEFAULT to
+ * SPI_SCBR_FASTEST, with and without the sensor's MISO high-speed read,
+ * in 16-bit word mode. Each step is validated with register reads
+ * (compared with the same reads at the default clock) and the FIFO
+ * test pattern (LFSR); nothing is written at the candidate setting.
+ * The fastest setting that passes RADAR_LINK_REPEATS times is kept in
+ * dev->link and dev->cs. Only while acquisition is stopped (after
+ * radar_dev_init, with a frame buffer set).
+ * Returns false if not even the default clock passes (8-bit, default
+ * clock are restored), or without running while acquisition runs.
+ */
+bool radar_dev_link_train(radar_dev_t *dev);
+
+/*
+ * Register reads at the current setting against the default clock
+ * (nothing written). On failure the clock steps down one divider.
+ * Refused while acquisition runs (returns false, nothing counted).
+ * Returns true if the link passed.
+ */
+bool radar_dev_link_check(radar_dev_t *dev);
+
+/*
+ * Next word of the FIFO test pattern
+ */
+uint16_t radar_test_pattern_next(uint16_t word);
+
+/*
+ * Reprogram from a register export (entries ADDR << 25 | 1 << 24 | DATA,
+ * as avian_register_config). Only registers whose value differs from
+ * the shadow are written, contiguous changes in one burst.
+ * Returns false (nothing written) if an entry is malformed.
+ *
+ * An export containing CSU1_2 sets the IF gain and its reference to the
+ * VGA gain and high-pass written. If a field is out of range or the RX
+ * channels differ, the reference is invalid: radar_dev_set_if_gain
+ * refuses (no AGC) and frames are tagged with the reference setting.
+ */
+bool radar_dev_write_config(radar_dev_t *dev, const uint32_t *config, uint32_t num_regs);
+
+/*
+ * Register access through the shadow: the write is skipped if the
+ * value is unchanged, the read is answered without SPI traffic once
+ * the value is known
+ */
+void radar_dev_write_reg(radar_dev_t *dev, uint8_t addr, uint32_t value);
+uint32_t radar_dev_read_reg(radar_dev_t *dev, uint8_t addr);
+
+/*
+ * Request an IF gain / high-pass setting (CSU1_2 VGA_GAIN and HPF_SEL
+ * field values, all RX channels; only that register is written). Takes
+ * effect at once while acquisition is stopped, otherwise between two
+ * frames (dev->gain.pending until then; a newer request replaces it).
+ * Returns false if a value is out of range.
+ */
+bool radar_dev_set_if_gain(radar_dev_t *dev, uint8_t vga, uint8_t hpf);
+
+/*
+ * High-pass cut-off of an HPF_SEL value (kHz)
+ */
+uint8_t radar_hpf_khz(uint8_t hpf);
+
+/*
+ * Per-device variants of the functions below
+ */
+void radar_dev_start(radar_dev_t *dev);
+void radar_dev_stop(radar_dev_t *dev);
+void radar_dev_start_frame(radar_dev_t *dev);
+void radar_dev_trigger_frame(radar_dev_t *dev);
+void radar_dev_set_frame_power(radar_dev_t *dev, radar_frame_power_t mode);
+bool radar_dev_set_frame_timing(radar_dev_t *dev, uint16_t num_chirps, uint32_t frame_period_us);
+void radar_dev_set_clutter_filter(radar_dev_t *dev, radar_clutter_t mode);
+bool radar_dev_get_clutter_map(const radar_dev_t *dev, int32_t *map);
+void radar_dev_set_clutter_map(radar_dev_t *dev, const int32_t *map);
+uint32_t radar_dev_config_hash(const radar_dev_t *dev);
+const radar_frame_t* radar_dev_get_frame(radar_dev_t *dev);
+bool radar_dev_frame_ready(radar_dev_t *dev);
+void radar_dev_reset_fifo(radar_dev_t *dev);
+
+/*
+ * Reset FIFO/FSM and start the next frame right after a frame was
+ * read; dev->frame stays valid until the next radar_dev_get_frame().
+ * No-op in continuous mode.
+ */
+void radar_dev_rearm(radar_dev_t *dev);
+
+/*
+ * FIFO status register (fill level AVIAN_FSTAT_FILL_MASK, error and
+ * empty/full flags; one SPI read, also refreshes dev->shadow.gsr0)
+ */
+uint32_t radar_dev_fifo_status(radar_dev_t *dev);
+
+/*
+ * Samples of one frame at the current frame timing
+ */
+uint16_t radar_dev_frame_samples(const radar_dev_t *dev);
+
+/*
+ * Default device (SPI_CS_DEFAULT), used by the single-sensor API
+ */
+radar_dev_t* radar_default_dev(void);
+
+/*
+ * Initialize radar sensor (hardware reset + default device)
  * Returns true if initialization successful
  */
 bool radar_init(void);
 
 /*
- * Start continuous frame acquisition mode
+ * Start continuous frame acquisition mode: the sensor repeats frames
+ * at the configured period on its own, radar_get_frame() drains them
+ * (dev->stream counts late and missed frames). Ends with radar_stop()
+ * or radar_set_frame_power(); a frame timing change restarts it.
  */
 void radar_start(void);
 
@@ -80,6 +452,55 @@ void radar_stop(void);
  */
 void radar_start_frame(void);
 
+/*
+ * Trigger one frame with a single MAIN register write
+ * No FIFO/FSM reset: use after the previous frame was read completely
+ */
+void radar_trigger_frame(void);
+
+/*
+ * Select sensor power mode between frames
+ * Rewrites only the CCR1 power-down and CCR2 frame-count fields
+ */
+void radar_set_frame_power(radar_frame_power_t mode);
+
+/*
+ * Reprogram frame timing: chirps per frame (2..RADAR_NUM_CHIRPS; motion
+ * energy needs a chirp-to-chirp difference) and
+ * frame repetition period. Writes only CCR1 frame-end delay and CCR2
+ * frame length; takes effect on the next frame start.
+ * Returns false if the values are out of range.
+ */
+bool radar_set_frame_timing(uint16_t num_chirps, uint32_t frame_period_us);
+
+/*
+ * Select static clutter removal (default RADAR_CLUTTER_NONE)
+ * RADAR_CLUTTER_MTI subtracts a per-sample clutter map, the mean chirp
+ * averaged over frames, and updates it from each frame. The map is
+ * seeded from the first frame after selecting the mode.
+ */
+void radar_set_clutter_filter(radar_clutter_t mode);
+
+/*
+ * Copy the clutter map (RADAR_NUM_SAMPLES values, Q16), scaled to the
+ * exported VGA gain so a saved map stays valid across AGC steps
+ * Returns false if the map is not seeded yet
+ */
+bool radar_get_clutter_map(int32_t *map);
+
+/*
+ * Load a saved clutter map (exported VGA gain; marks it seeded)
+ */
+void radar_set_clutter_map(const int32_t *map);
+
+/*
+ * Hash of the active register profile, clutter filter mode, frame
+ * timing (chirps, period) and reference IF gain
+ * Identifies state (backgrounds, clutter map) that is only valid for
+ * this configuration
+ */
+uint32_t radar_config_hash(void);
+
 /*
  * Get the current radar frame (non-blocking)
  * Returns pointer to frame data, or NULL if not ready
@@ -16,6 +16,8 @@
 #define AVIAN_NUM_CHIRPS        64
 #define AVIAN_NUM_RX_ANTENNAS   3
 #define AVIAN_SAMPLE_RATE_HZ    2000000UL       /* 2 MHz */
+#define AVIAN_BANDWIDTH_HZ      (AVIAN_END_FREQ_HZ - AVIAN_START_FREQ_HZ)  /* 5.5 GHz */
+#define AVIAN_BIN_HZ            (AVIAN_SAMPLE_RATE_HZ / AVIAN_NUM_SAMPLES)  /* Beat frequency per FFT bin */
 
 /* Frame timing */
 #define AVIAN_CHIRP_TIME_US     591             /* ~591 us */
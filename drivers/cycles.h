@@ -0,0 +1,32 @@
+/*
+ * Cycle counter for ATSAMS70Q21
+ * Uses the Cortex-M7 DWT CYCCNT register (counts CPU clocks at 300MHz)
+ */
+
+#ifndef CYCLES_H
+#define CYCLES_H
+
+#include <stdint.h>
+#include "sams70.h"
+
+/*
+ * Enable the DWT cycle counter. The count is not reset: it is shared
+ * by the trace time stamps, the scheduler and the benchmarks.
+ */
+static inline void cycles_init(void)
+{
+    DEMCR |= DEMCR_TRCENA;
+    DWT_LAR = DWT_LAR_KEY;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+}
+
+/*
+ * Read current cycle count (wraps every ~14 s at 300MHz)
+ * Use unsigned subtraction for intervals
+ */
+static inline uint32_t cycles_now(void)
+{
+    return DWT_CYCCNT;
+}
+
+#endif /* CYCLES_H */
@@ -0,0 +1,97 @@
+/*
+ * Internal flash (EEFC) driver implementation
+ *
+ * Flash cannot be read while a command runs, so the command issue and
+ * busy-wait execute from RAM (.ramfunc) with interrupts masked; the
+ * CPU is stalled for the duration (page write ~1.5 ms, 16-page erase
+ * tens of ms).
+ */
+
+#include "flash.h"
+
+/* Issue a command and wait for completion; returns FSR (read clears errors) */
+__attribute__((section(".ramfunc"), noinline, long_call))
+static uint32_t flash_command(uint32_t fcr)
+{
+    uint32_t fsr;
+
+    EFC->EEFC_FCR = fcr;
+    do {
+        fsr = EFC->EEFC_FSR;
+    } while (!(fsr & EEFC_FSR_FRDY));
+
+    return fsr;
+}
+
+static bool flash_run(uint8_t cmd, uint32_t arg)
+{
+    uint32_t fsr;
+
+    __asm volatile ("cpsid i" ::: "memory");
+    fsr = flash_command(EEFC_FCR_FKEY | EEFC_FCR_FARG(arg) | EEFC_FCR_FCMD(cmd));
+    __asm volatile ("cpsie i" ::: "memory");
+
+    return (fsr & (EEFC_FSR_FCMDE | EEFC_FSR_FLOCKE | EEFC_FSR_FLERR)) == 0;
+}
+
+static bool in_storage(uint32_t addr, uint32_t len)
+{
+    return addr >= FLASH_STORAGE_ADDR &&
+           addr + len <= FLASH_STORAGE_ADDR + FLASH_STORAGE_SIZE;
+}
+
+bool flash_erase_block(uint32_t addr)
+{
+    addr &= ~(FLASH_ERASE_BLOCK_SIZE - 1);
+    if (!in_storage(addr, FLASH_ERASE_BLOCK_SIZE)) {
+        return false;
+    }
+
+    uint32_t page = (addr - IFLASH_ADDR) / IFLASH_PAGE_SIZE;
+    return flash_run(EEFC_FCMD_EPA, page | EEFC_EPA_16_PAGES);
+}
+
+bool flash_write(uint32_t addr, const void *data, uint32_t len)
+{
+    const uint32_t *src = (const uint32_t *)data;
+
+    if ((addr & (IFLASH_PAGE_SIZE - 1)) || (len & 3) || !in_storage(addr, len)) {
+        return false;
+    }
+
+    while (len > 0) {
+        uint32_t chunk = len < IFLASH_PAGE_SIZE ? len : IFLASH_PAGE_SIZE;
+        volatile uint32_t *latch = (volatile uint32_t *)(uintptr_t)addr;
+
+        /* Fill the page latch through the page's address range; words
+         * not written keep the erased value */
+        for (uint32_t i = 0; i < chunk / 4; i++) {
+            latch[i] = *src++;
+        }
+        for (uint32_t i = chunk / 4; i < IFLASH_PAGE_SIZE / 4; i++) {
+            latch[i] = 0xFFFFFFFF;
+        }
+        __asm volatile ("dsb" ::: "memory");
+
+        if (!flash_run(EEFC_FCMD_WP, (addr - IFLASH_ADDR) / IFLASH_PAGE_SIZE)) {
+            return false;
+        }
+
+        addr += IFLASH_PAGE_SIZE;
+        len -= chunk;
+    }
+
+    return true;
+}
+
+bool flash_is_blank(uint32_t addr, uint32_t len)
+{
+    const uint32_t *p = (const uint32_t *)(uintptr_t)addr;
+
+    for (uint32_t i = 0; i < len / 4; i++) {
+        if (p[i] != 0xFFFFFFFF) {
+            return false;
+        }
+    }
+    return true;
+}
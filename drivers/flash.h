@@ -0,0 +1,38 @@
+/*
+ * Internal flash (EEFC) driver for ATSAMS70Q21
+ * Page programming and 16-page erase of the reserved storage area
+ *
+ * The storage area is the last FLASH_STORAGE_SIZE bytes of flash and
+ * is excluded from the FLASH region in link.ld.
+ */
+
+#ifndef FLASH_H
+#define FLASH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sams70.h"
+
+#define FLASH_STORAGE_SIZE      0x4000      /* 16 KB = 2 erase blocks */
+#define FLASH_STORAGE_ADDR      (IFLASH_ADDR + IFLASH_SIZE - FLASH_STORAGE_SIZE)
+#define FLASH_ERASE_BLOCK_SIZE  (16 * IFLASH_PAGE_SIZE)
+
+/*
+ * Erase the 16-page block containing addr (8 KB aligned)
+ * Returns false on a controller error or an address outside storage
+ */
+bool flash_erase_block(uint32_t addr);
+
+/*
+ * Program len bytes (multiple of 4) at a page-aligned storage address
+ * The target pages must be erased
+ * Returns false on a controller error or an address outside storage
+ */
+bool flash_write(uint32_t addr, const void *data, uint32_t len);
+
+/*
+ * True if len bytes at addr read as erased (0xFF)
+ */
+bool flash_is_blank(uint32_t addr, uint32_t len);
+
+#endif /* FLASH_H */
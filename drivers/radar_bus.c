@@ -0,0 +1,76 @@
+/*
+ * Multi-sensor SPI bus scheduler implementation
+ *
+ * One poll costs an FSTAT read (4 bytes) per running sensor plus, when
+ * a frame is complete, its burst readout. All SPI traffic happens in
+ * the caller's context, so transactions never interleave.
+ */
+
+#include "radar_bus.h"
+#include <string.h>
+
+void radar_bus_init(radar_bus_t *bus)
+{
+    memset(bus, 0, sizeof(*bus));
+}
+
+bool radar_bus_add(radar_bus_t *bus, radar_dev_t *dev)
+{
+    if (bus->num_devs >= RADAR_BUS_MAX_DEVICES) {
+        return false;
+    }
+    bus->dev[bus->num_devs++] = dev;
+    return true;
+}
+
+radar_dev_t* radar_bus_poll(radar_bus_t *bus)
+{
+    if (bus->num_devs == 0) {
+        return NULL;
+    }
+
+    /* Fullest FIFO with a complete frame, scanning from the device
+     * after the last one read so that ties go round-robin. A FIFO
+     * error wins: it is cleared by the read attempt (counted in
+     * dev->fifo_errors) and the device is re-armed on the next poll. */
+    int best = -1;
+    uint32_t best_level = 0;
+
+    for (uint8_t k = 1; k <= bus->num_devs; k++) {
+        uint8_t idx = (uint8_t)((bus->last + k) % bus->num_devs);
+        radar_dev_t *dev = bus->dev[idx];
+
+        if (!dev->acquisition_running) {
+            radar_dev_start_frame(dev);     /* New device or after an error */
+            continue;
+        }
+
+        uint32_t fstat = radar_dev_fifo_status(dev);
+        uint32_t level = (fstat & AVIAN_FSTAT_FOU_ERR) ? UINT32_MAX : (fstat & AVIAN_FSTAT_FILL_MASK);
+        if (level >= radar_dev_frame_samples(dev) && level > best_level) {
+            best = idx;
+            best_level = level;
+        }
+    }
+
+    if (best < 0) {
+        bus->idle_polls++;
+        return NULL;
+    }
+
+    radar_dev_t *dev = bus->dev[best];
+    bus->last = (uint8_t)best;
+    if (best_level != UINT32_MAX && best_level > bus->max_level[best]) {
+        bus->max_level[best] = (uint16_t)best_level;
+    }
+
+    if (!radar_dev_get_frame(dev)) {
+        return NULL;                        /* Re-armed on the next poll */
+    }
+
+    /* Next frame records while the caller processes this one */
+    radar_dev_rearm(dev);
+    bus->frames[best]++;
+
+    return dev;
+}
@@ -0,0 +1,53 @@
+/*
+ * Multi-sensor SPI bus scheduler
+ *
+ * Several BGT60s share SPI0, one chip select each. Sensors record
+ * frames into their own FIFOs autonomously, so the bus is only needed
+ * for the readout: radar_bus_poll() reads one complete frame per call,
+ * choosing the sensor whose FIFO is fullest (closest to overflow; ties
+ * round-robin), and immediately re-arms that sensor. The caller
+ * processes the returned frame while all sensors record their next
+ * frame, so readout and processing of one sensor overlap acquisition
+ * of the others. Readouts end up staggered on their own, which also
+ * keeps the sensors' chirps apart in time.
+ */
+
+#ifndef RADAR_BUS_H
+#define RADAR_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "avian_radar.h"
+
+#define RADAR_BUS_MAX_DEVICES   4
+
+typedef struct {
+    radar_dev_t *dev[RADAR_BUS_MAX_DEVICES];
+    uint8_t num_devs;
+    uint8_t last;                                   /* Index of the last device read */
+
+    /* Statistics */
+    uint32_t frames[RADAR_BUS_MAX_DEVICES];         /* Frames read per device */
+    uint16_t max_level[RADAR_BUS_MAX_DEVICES];      /* Highest FIFO level at readout */
+    uint32_t idle_polls;                            /* Polls without a complete frame */
+} radar_bus_t;
+
+/*
+ * Initialize an empty bus
+ */
+void radar_bus_init(radar_bus_t *bus);
+
+/*
+ * Add an initialized device; returns false if the bus is full
+ */
+bool radar_bus_add(radar_bus_t *bus, radar_dev_t *dev);
+
+/*
+ * Arm idle devices and read at most one complete frame.
+ * Returns the device whose frame (dev->frame) was read, or NULL.
+ * Devices that lost a frame to a FIFO error are re-armed on the next
+ * call (dev->fifo_errors counts them).
+ */
+radar_dev_t* radar_bus_poll(radar_bus_t *bus);
+
+#endif /* RADAR_BUS_H */
@@ -0,0 +1,81 @@
+/*
+ * Real-time Timer (RTT) driver implementation
+ *
+ * The RTT counts slow clock ticks and keeps running while the core is
+ * in sleep mode. An alarm interrupt wakes the core from WFI; the
+ * handler only clears the status, the sleeping code re-checks time.
+ */
+
+#include "rtt.h"
+#include "sams70.h"
+#include "trace.h"
+
+static volatile bool alarm_fired = false;
+
+void rtt_init(void)
+{
+    /* Restart counter with prescaler, alarm interrupt enabled later */
+    RTT->RTT_MR = RTT_MR_RTPRES(RTT_PRESCALER) | RTT_MR_RTTRST;
+
+    /* Sleep mode (not deep sleep): peripherals and SPI keep their state */
+    SCB_SCR &= ~SCB_SCR_SLEEPDEEP;
+
+    NVIC_ICPR0 = (1 << ID_RTT);
+    NVIC_ISER0 = (1 << ID_RTT);
+}
+
+uint32_t rtt_now(void)
+{
+    /* RTT_VR is asynchronous to MCK: read until two reads agree */
+    uint32_t a = RTT->RTT_VR;
+    uint32_t b = RTT->RTT_VR;
+
+    while (a != b) {
+        a = b;
+        b = RTT->RTT_VR;
+    }
+    return a;
+}
+
+void rtt_sleep_until(uint32_t tick)
+{
+    /* Signed difference handles counter wrap */
+    while ((int32_t)(tick - rtt_now()) > 0) {
+        alarm_fired = false;
+
+        /* Alarm triggers when the counter reaches AR + 1 */
+        RTT->RTT_AR = tick - 1;
+        RTT->RTT_MR |= RTT_MR_ALMIEN;
+
+        /* Re-check after arming so a passed deadline cannot hang WFI */
+        if ((int32_t)(tick - rtt_now()) <= 0) {
+            break;
+        }
+
+        /* Mask IRQs around the check: WFI still wakes on the pending
+         * alarm, so it cannot fire between the check and the sleep
+         */
+        __asm volatile ("cpsid i" ::: "memory");
+        if (!alarm_fired) {
+            __asm volatile ("wfi");
+        }
+        __asm volatile ("cpsie i" ::: "memory");
+    }
+
+    RTT->RTT_MR &= ~RTT_MR_ALMIEN;
+}
+
+/*
+ * RTT interrupt: acknowledge alarm and wake the sleeper
+ */
+void RTT_Handler(void)
+{
+    uint32_t sr = RTT->RTT_SR;  /* Reading clears status */
+
+    trace_event(TRACE_IRQ_RTT, (uint16_t)sr);
+
+    if (sr & RTT_SR_ALMS) {
+        RTT->RTT_MR &= ~RTT_MR_ALMIEN;
+        alarm_fired = true;
+    }
+}
@@ -0,0 +1,36 @@
+/*
+ * Real-time Timer (RTT) driver
+ * Low-power timebase and wakeup source for duty-cycled acquisition
+ */
+
+#ifndef RTT_H
+#define RTT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Tick rate: 32768 Hz slow clock / RTT_PRESCALER */
+#define RTT_PRESCALER       32
+#define RTT_TICK_HZ         (32768UL / RTT_PRESCALER)   /* 1024 Hz */
+
+/* Convert between milliseconds and RTT ticks */
+#define RTT_MS_TO_TICKS(ms) (((uint32_t)(ms) * RTT_TICK_HZ + 500) / 1000)
+#define RTT_TICKS_TO_MS(t)  (((uint32_t)(t) * 1000 + RTT_TICK_HZ / 2) / RTT_TICK_HZ)
+
+/*
+ * Start the RTT at RTT_TICK_HZ and enable its interrupt in the NVIC
+ */
+void rtt_init(void);
+
+/*
+ * Read current tick count (consistent read)
+ */
+uint32_t rtt_now(void);
+
+/*
+ * Sleep (WFI, core clock stopped) until the RTT reaches `tick`
+ * Returns immediately if `tick` is already in the past
+ */
+void rtt_sleep_until(uint32_t tick);
+
+#endif /* RTT_H */
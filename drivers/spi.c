@@ -6,7 +6,8 @@
  *   MISO = PD20 (Peripheral B)
  *   MOSI = PD21 (Peripheral B)
  *   SPCK = PD22 (Peripheral B)
- *   CS   = PA11 (GPIO - manual control)
+ *   CS   = PA11 (GPIO - manual control), further sensors on other
+ *          GPIOs via spi_cs_t
  */
 
 #include "spi.h"
@@ -18,11 +19,38 @@
 #define SPI0_SPCK_PIN   (1 << 22)  /* PD22 - SPCK (Peripheral B) */
 
 /* CS pin on PIOA - from connector.h: csn0 = PA11 */
-#define SPI0_CS_PIN     (1 << 11)  /* PA11 - CSN0 (GPIO for manual control) */
+static const spi_cs_t default_cs = SPI_CS_DEFAULT;
 
 /* Track CS state */
 static volatile int cs_active = 0;
 
+/* Timing currently programmed in SPI_CSR[0] */
+static uint8_t cur_scbr;
+static bool cur_wide;
+
+/*
+ * Chip select 0 timing (all devices use CSR0; CS itself is a GPIO)
+ * CPOL = 0, NCPHA = 1 (CPHA = 0) -> SPI Mode 0
+ * CSAAT: CS stays low between transfers
+ */
+static void spi_apply_timing(uint8_t scbr, bool wide)
+{
+    if (scbr == 0) {
+        scbr = SPI_SCBR_DEFAULT;
+    }
+    if (scbr == cur_scbr && wide == cur_wide) {
+        return;
+    }
+
+    SPI0->SPI_CSR[0] = SPI_CSR_SCBR(scbr) |
+                       (wide ? SPI_CSR_BITS_16 : SPI_CSR_BITS_8) |
+                       SPI_CSR_NCPHA |
+                       SPI_CSR_CSAAT |
+                       SPI_CSR_DLYBCT(0);
+    cur_scbr = scbr;
+    cur_wide = wide;
+}
+
 void spi_init(void)
 {
     /* Enable peripheral clocks */
@@ -37,9 +65,7 @@ void spi_init(void)
     PIOD->PIO_ABCDSR[1] &= ~(SPI0_MISO_PIN | SPI0_MOSI_PIN | SPI0_SPCK_PIN);
 
     /* Configure CS pin (PA11) as GPIO for manual control */
-    PIOA->PIO_PER = SPI0_CS_PIN;      /* Enable PIO control */
-    PIOA->PIO_OER = SPI0_CS_PIN;      /* Output enable */
-    PIOA->PIO_SODR = SPI0_CS_PIN;     /* Set high (deselected) */
+    spi_cs_init(&default_cs);
 
     /* Reset SPI */
     SPI0->SPI_CR = SPI_CR_SWRST;
@@ -56,15 +82,10 @@ void spi_init(void)
     /* Configure chip select 0 settings (used as default timing)
      * SCBR: SPI clock = MCK / SCBR
      * MCK = 150 MHz, target ~10 MHz -> SCBR = 15
-     * CPOL = 0, NCPHA = 1 (CPHA = 0) -> SPI Mode 0
      * 8 bits per transfer
-     * CSAAT: CS stays low between transfers
      */
-    SPI0->SPI_CSR[0] = SPI_CSR_SCBR(15) |
-                       SPI_CSR_BITS_8 |
-                       SPI_CSR_NCPHA |
-                       SPI_CSR_CSAAT |
-                       SPI_CSR_DLYBCT(0);
+    cur_scbr = 0;
+    spi_apply_timing(SPI_SCBR_DEFAULT, false);
 
     /* Enable SPI */
     SPI0->SPI_CR = SPI_CR_SPIEN;
@@ -72,27 +93,45 @@ void spi_init(void)
     cs_active = 0;
 }
 
+void spi_cs_init(const spi_cs_t *cs)
+{
+    cs->port->PIO_PER = cs->pin;      /* Enable PIO control */
+    cs->port->PIO_OER = cs->pin;      /* Output enable */
+    cs->port->PIO_SODR = cs->pin;     /* Set high (deselected) */
+}
+
 /*
  * Assert chip select (active low)
  */
-void spi_select(void)
+void spi_select_cs(const spi_cs_t *cs)
 {
-    PIOA->PIO_CODR = SPI0_CS_PIN;  /* Clear = low = selected */
+    spi_apply_timing(cs->scbr, cs->wide);
+    cs->port->PIO_CODR = cs->pin;  /* Clear = low = selected */
     cs_active = 1;
 }
 
 /*
  * Deassert chip select
  */
-void spi_deselect(void)
+void spi_deselect_cs(const spi_cs_t *cs)
 {
     /* Wait for any pending transfer to complete */
     while (!(SPI0->SPI_SR & SPI_SR_TXEMPTY));
 
-    PIOA->PIO_SODR = SPI0_CS_PIN;  /* Set = high = deselected */
+    cs->port->PIO_SODR = cs->pin;  /* Set = high = deselected */
     cs_active = 0;
 }
 
+void spi_select(void)
+{
+    spi_select_cs(&default_cs);
+}
+
+void spi_deselect(void)
+{
+    spi_deselect_cs(&default_cs);
+}
+
 uint8_t spi_transfer(uint8_t data)
 {
     /* Wait for TX ready */
@@ -108,8 +147,33 @@ uint8_t spi_transfer(uint8_t data)
     return (uint8_t)SPI0->SPI_RDR;
 }
 
+static uint16_t spi_transfer16(uint16_t data)
+{
+    while (!(SPI0->SPI_SR & SPI_SR_TDRE));
+    SPI0->SPI_TDR = data;
+    while (!(SPI0->SPI_SR & SPI_SR_RDRF));
+    return (uint16_t)SPI0->SPI_RDR;
+}
+
 void spi_transfer_buffer(const uint8_t *tx_buf, uint8_t *rx_buf, uint32_t len)
 {
+    if (cur_wide) {
+        if ((len & 1) == 0) {
+            for (uint32_t i = 0; i < len; i += 2) {
+                uint16_t tx_data = tx_buf ? (uint16_t)((tx_buf[i] << 8) | tx_buf[i + 1]) : 0xFFFF;
+                uint16_t rx_data = spi_transfer16(tx_data);
+                if (rx_buf) {
+                    rx_buf[i] = (uint8_t)(rx_data >> 8);
+                    rx_buf[i + 1] = (uint8_t)rx_data;
+                }
+            }
+            return;
+        }
+        /* Odd length: byte transfers (CS stays asserted) */
+        while (!(SPI0->SPI_SR & SPI_SR_TXEMPTY));
+        spi_apply_timing(cur_scbr, false);
+    }
+
     for (uint32_t i = 0; i < len; i++) {
         uint8_t tx_data = tx_buf ? tx_buf[i] : 0xFF;
         uint8_t rx_data = spi_transfer(tx_data);
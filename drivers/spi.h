@@ -7,6 +7,29 @@
 #define SPI_H
 
 #include <stdint.h>
+#include <stdbool.h>
+#include "sams70.h"
+#include "clock.h"
+
+/* SPI clock = MCK / SCBR */
+#define SPI_SCBR_DEFAULT    15      /* 10 MHz, safe without link training */
+#define SPI_SCBR_FASTEST    3       /* 50 MHz, Avian SPI maximum */
+#define SPI_CLOCK_HZ(scbr)  (MCK_FREQ / (scbr))
+
+/*
+ * One SPI device: chip select line (GPIO, active low) and its link
+ * settings. Several sensors share SPI0 with their own CS pin; clock
+ * and word size are applied when the device is selected.
+ */
+typedef struct {
+    PIO_TypeDef *port;
+    uint32_t pin;
+    uint8_t scbr;           /* Clock divider; 0 = SPI_SCBR_DEFAULT */
+    bool wide;              /* 16-bit transfers for even-length buffers */
+} spi_cs_t;
+
+/* CSN0 = PA11 (the BGT60 on the BJT60 board) */
+#define SPI_CS_DEFAULT  { PIOA, (1u << 11), SPI_SCBR_DEFAULT, false }
 
 /*
  * Initialize SPI0 in master mode
@@ -22,13 +45,29 @@ uint8_t spi_transfer(uint8_t data);
 
 /*
  * Transfer multiple bytes
+ * In 16-bit mode even-length buffers go out as big-endian 16-bit words
+ * (same bytes on the wire, half the TDR/RDR accesses)
  */
 void spi_transfer_buffer(const uint8_t *tx_buf, uint8_t *rx_buf, uint32_t len);
 
 /*
- * Manual chip select control for burst transfers
+ * Manual chip select control for burst transfers (SPI_CS_DEFAULT)
  */
 void spi_select(void);
 void spi_deselect(void);
 
+/*
+ * Configure a chip select pin as GPIO output, deselected
+ * (SPI_CS_DEFAULT is configured by spi_init)
+ */
+void spi_cs_init(const spi_cs_t *cs);
+
+/*
+ * Chip select control for a given device; only one device may be
+ * selected at a time. Selecting applies the device's clock and word
+ * size.
+ */
+void spi_select_cs(const spi_cs_t *cs);
+void spi_deselect_cs(const spi_cs_t *cs);
+
 #endif /* SPI_H */
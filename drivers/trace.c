@@ -0,0 +1,52 @@
+/*
+ * Event trace ring implementation
+ *
+ * Records are claimed with an atomic increment of trace_head (LDREX/
+ * STREX on the M7), so an interrupt recording in the middle of another
+ * record gets its own slot. The reader runs in the main loop only.
+ */
+
+#include "trace.h"
+#include <string.h>
+
+trace_record_t trace_ring[TRACE_RECORDS];
+uint32_t trace_head;
+
+static uint32_t lost;
+
+void trace_init(void)
+{
+#ifndef TRACE_CLOCK_FN
+    cycles_init();
+#endif
+    memset(trace_ring, 0, sizeof(trace_ring));
+    __atomic_store_n(&trace_head, 0, __ATOMIC_RELAXED);
+    lost = 0;
+}
+
+uint32_t trace_read(uint32_t *cursor, trace_record_t *out, uint32_t max)
+{
+    uint32_t head = __atomic_load_n(&trace_head, __ATOMIC_RELAXED);
+    uint32_t seq = *cursor;
+
+    if (head - seq > TRACE_RECORDS) {
+        lost += head - seq - TRACE_RECORDS;
+        seq = head - TRACE_RECORDS;
+    }
+
+    uint32_t n = head - seq;
+    if (n > max) {
+        n = max;
+    }
+    for (uint32_t k = 0; k < n; k++) {
+        out[k] = trace_ring[(seq + k) & (TRACE_RECORDS - 1)];
+    }
+
+    *cursor = seq + n;
+    return n;
+}
+
+uint32_t trace_lost(void)
+{
+    return lost;
+}
@@ -0,0 +1,107 @@
+/*
+ * Event trace ring
+ *
+ * Binary timeline of the frame pipeline: 8-byte records (CYCCNT time
+ * stamp, event ID, argument) in a fixed RAM ring, streamed over
+ * telemetry (TELEMETRY_TYPE_TRACE) and turned into a timeline with
+ * latencies by tools/telemetry_decode.py. Recording is an atomic index
+ * increment and three stores (no locks, callable from interrupts), so
+ * tracing stays on in production builds; build with -DTRACE_DISABLE
+ * to compile it out.
+ *
+ * Stages are recorded as begin/end pairs (TRACE_END set on the end
+ * record); the decoder pairs them up. The ring keeps the most recent
+ * TRACE_RECORDS events; older ones are overwritten if not yet sent.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "cycles.h"
+
+#define TRACE_RECORDS       256         /* Power of two */
+#define TRACE_END           0x8000      /* Set in the ID of a stage's end record */
+
+/* Event IDs (arguments in brackets) */
+typedef enum {
+    TRACE_IRQ_RTT = 0x01,       /* RTT interrupt (RTT_SR) */
+    TRACE_FRAME_READY,          /* Frame complete in the FIFO, readout starts (frame index) */
+    TRACE_FIFO_ERROR,           /* Readout lost to a FIFO error (GSR0) */
+    TRACE_FIFO_RESYNC,          /* FIFO reset between frames after an overflow (frames lost) */
+    TRACE_IF_GAIN,              /* IF gain written (VGA_GAIN | HPF_SEL << 8) */
+
+    /* Stages (begin / end) */
+    TRACE_SPI_BURST = 0x10,     /* FIFO burst read (bytes) */
+    TRACE_UNPACK,               /* 12-bit unpack + clutter removal (samples) */
+    TRACE_PRESENCE,             /* presence_update (end: presence) */
+    TRACE_TRACKING,             /* Background store, occupancy, zones (end: zone mask) */
+    TRACE_GESTURE,              /* gesture_update (end: gesture class) */
+    TRACE_FEATURES,             /* wave_features_update */
+    TRACE_CLASSIFIER,           /* wave_detect (end: class) */
+    TRACE_VITALS,               /* vital_signs_update */
+    TRACE_OUTPUT,               /* LED and status telemetry (end: presence | waving << 1) */
+} trace_id_t;
+
+typedef struct {
+    uint32_t cycles;            /* CYCCNT */
+    uint16_t id;                /* trace_id_t, | TRACE_END */
+    uint16_t arg;
+} trace_record_t;
+
+/* Time stamp source: host tests substitute a simulated clock */
+#ifdef TRACE_CLOCK_FN
+uint32_t TRACE_CLOCK_FN(void);
+#define TRACE_CLOCK()       TRACE_CLOCK_FN()
+#else
+#define TRACE_CLOCK()       cycles_now()
+#endif
+
+extern trace_record_t trace_ring[TRACE_RECORDS];
+extern uint32_t trace_head;     /* Records written since trace_init() */
+
+/*
+ * Record an event
+ */
+static inline void trace_event(uint16_t id, uint16_t arg)
+{
+#ifndef TRACE_DISABLE
+    uint32_t i = __atomic_fetch_add(&trace_head, 1, __ATOMIC_RELAXED) & (TRACE_RECORDS - 1);
+    trace_ring[i].cycles = TRACE_CLOCK();
+    trace_ring[i].id = id;
+    trace_ring[i].arg = arg;
+#else
+    (void)id;
+    (void)arg;
+#endif
+}
+
+static inline void trace_begin(trace_id_t id, uint16_t arg)
+{
+    trace_event((uint16_t)id, arg);
+}
+
+static inline void trace_end(trace_id_t id, uint16_t arg)
+{
+    trace_event((uint16_t)(id | TRACE_END), arg);
+}
+
+/*
+ * Empty the ring (also starts the cycle counter)
+ */
+void trace_init(void);
+
+/*
+ * Copy up to `max` records starting at sequence number *cursor into
+ * `out` and advance *cursor. Records already overwritten are skipped
+ * (counted in trace_lost()); the first copied record has sequence
+ * number *cursor - return value on return.
+ */
+uint32_t trace_read(uint32_t *cursor, trace_record_t *out, uint32_t max);
+
+/*
+ * Records overwritten before they were read
+ */
+uint32_t trace_lost(void);
+
+#endif /* TRACE_H */
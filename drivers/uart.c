@@ -0,0 +1,85 @@
+/*
+ * UART driver implementation
+ *
+ * Writes go into a ring buffer; the TXRDY interrupt feeds the
+ * transmitter so the main loop never waits on the link.
+ */
+
+#include "uart.h"
+#include "sams70.h"
+#include "clock.h"
+
+#define UART0_TX_PIN    (1 << 10)   /* PA10 - UTXD0 (Peripheral A) */
+
+static uint8_t tx_buf[UART_TX_BUF_SIZE];
+static volatile uint32_t tx_head = 0;   /* Written by uart_write */
+static volatile uint32_t tx_tail = 0;   /* Written by the interrupt */
+static volatile uint32_t tx_dropped = 0;
+
+void uart_init(void)
+{
+    PMC_PCER0 = (1 << ID_UART0) | (1 << ID_PIOA);
+
+    /* PA10 to Peripheral A: ABCDSR[0]=0, ABCDSR[1]=0 */
+    PIOA->PIO_ABCDSR[0] &= ~UART0_TX_PIN;
+    PIOA->PIO_ABCDSR[1] &= ~UART0_TX_PIN;
+    PIOA->PIO_PDR = UART0_TX_PIN;
+
+    UART0->UART_CR = UART_CR_RSTRX | UART_CR_RSTTX | UART_CR_RXDIS | UART_CR_TXDIS;
+    UART0->UART_MR = UART_MR_PAR_NO | UART_MR_CHMODE_NORMAL;
+
+    /* Baud = MCK / (16 * CD) */
+    UART0->UART_BRGR = (MCK_FREQ + 8 * UART_BAUD) / (16 * UART_BAUD);
+
+    UART0->UART_IDR = 0xFFFFFFFF;
+    tx_head = 0;
+    tx_tail = 0;
+
+    NVIC_ICPR0 = (1 << ID_UART0);
+    NVIC_ISER0 = (1 << ID_UART0);
+
+    UART0->UART_CR = UART_CR_TXEN;
+}
+
+uint32_t uart_tx_free(void)
+{
+    return UART_TX_BUF_SIZE - 1 - ((tx_head - tx_tail) & (UART_TX_BUF_SIZE - 1));
+}
+
+uint32_t uart_tx_dropped(void)
+{
+    return tx_dropped;
+}
+
+bool uart_write(const uint8_t *data, uint32_t len)
+{
+    if (len > uart_tx_free()) {
+        tx_dropped++;
+        return false;
+    }
+
+    uint32_t head = tx_head;
+    for (uint32_t i = 0; i < len; i++) {
+        tx_buf[head] = data[i];
+        head = (head + 1) & (UART_TX_BUF_SIZE - 1);
+    }
+    tx_head = head;
+
+    /* Interrupt fires immediately if the transmitter is idle */
+    UART0->UART_IER = UART_IER_TXRDY;
+    return true;
+}
+
+/*
+ * UART0 interrupt: move one byte per TXRDY, stop when empty
+ */
+void UART0_Handler(void)
+{
+    if (tx_tail == tx_head) {
+        UART0->UART_IDR = UART_IER_TXRDY;
+        return;
+    }
+
+    UART0->UART_THR = tx_buf[tx_tail];
+    tx_tail = (tx_tail + 1) & (UART_TX_BUF_SIZE - 1);
+}
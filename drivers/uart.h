@@ -0,0 +1,38 @@
+/*
+ * UART driver for ATSAMS70Q21
+ * UART0 transmit-only telemetry link, interrupt driven
+ *
+ *   UTXD0 = PA10 (Peripheral A)
+ */
+
+#ifndef UART_H
+#define UART_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UART_BAUD           921600UL
+#define UART_TX_BUF_SIZE    2048        /* Power of 2 */
+
+/*
+ * Initialize UART0 at UART_BAUD, 8N1
+ */
+void uart_init(void);
+
+/*
+ * Queue bytes for transmission (non-blocking)
+ * Returns false (and queues nothing) if the buffer lacks space
+ */
+bool uart_write(const uint8_t *data, uint32_t len);
+
+/*
+ * Free space in the transmit buffer
+ */
+uint32_t uart_tx_free(void);
+
+/*
+ * Number of writes rejected because the buffer was full
+ */
+uint32_t uart_tx_dropped(void);
+
+#endif /* UART_H */
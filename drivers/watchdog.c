@@ -27,13 +27,13 @@ void watchdog_init(uint32_t timeout_ms)
      * - WDD: Delta value (set same as WDV for simple operation)
      * - WDRSTEN: Enable reset on timeout
      * - WDDBGHLT: Halt watchdog when debugger connected
-     * - WDIDLEHLT: Halt watchdog in idle mode
+     * - WDIDLEHLT left clear: the watchdog keeps counting in WFI sleep
+     *   (LOW_POWER profile), so a hang waiting for a frame still resets
      */
     WDT->WDT_MR = WDT_MR_WDV(wdv) |
                   WDT_MR_WDD(wdv) |
                   WDT_MR_WDRSTEN |
-                  WDT_MR_WDDBGHLT |
-                  WDT_MR_WDIDLEHLT;
+                  WDT_MR_WDDBGHLT;
 }
 
 void watchdog_reset(void)
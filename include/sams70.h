@@ -169,11 +169,55 @@ typedef struct {
 #define UART_CR_TXEN        (1 << 6)
 #define UART_CR_TXDIS       (1 << 7)
 
+/* UART Mode Register bits */
+#define UART_MR_PAR_NO      (4 << 9)    /* No parity */
+#define UART_MR_CHMODE_NORMAL (0 << 14)
+
+/* UART Interrupt bits (IER/IDR/IMR) */
+#define UART_IER_TXRDY      (1 << 1)
+
 /* UART Status Register bits */
 #define UART_SR_RXRDY       (1 << 0)
 #define UART_SR_TXRDY       (1 << 1)
 #define UART_SR_TXEMPTY     (1 << 9)
 
+/*
+ * Enhanced Embedded Flash Controller (EEFC)
+ * 512-byte pages; erase in groups of 4/8/16/32 pages (EPA)
+ */
+#define EFC_BASE            (PERIPH_BASE + 0x000E0C00UL)
+
+typedef struct {
+    volatile uint32_t EEFC_FMR;     /* 0x00 Flash Mode Register */
+    volatile uint32_t EEFC_FCR;     /* 0x04 Flash Command Register */
+    volatile uint32_t EEFC_FSR;     /* 0x08 Flash Status Register */
+    volatile uint32_t EEFC_FRR;     /* 0x0C Flash Result Register */
+} EFC_TypeDef;
+
+#define EFC                 ((EFC_TypeDef *)EFC_BASE)
+
+/* EEFC Command Register */
+#define EEFC_FCR_FCMD(x)    ((x) & 0xFF)
+#define EEFC_FCR_FARG(x)    (((x) & 0xFFFF) << 8)
+#define EEFC_FCR_FKEY       (0x5A << 24)
+
+#define EEFC_FCMD_WP        0x01    /* Write page */
+#define EEFC_FCMD_EPA       0x07    /* Erase pages */
+
+/* EPA argument: first page (aligned to the count) | count code */
+#define EEFC_EPA_16_PAGES   2
+
+/* EEFC Status Register */
+#define EEFC_FSR_FRDY       (1 << 0)        /* Ready for a new command */
+#define EEFC_FSR_FCMDE      (1 << 1)        /* Command error */
+#define EEFC_FSR_FLOCKE     (1 << 2)        /* Lock error */
+#define EEFC_FSR_FLERR      (1 << 3)        /* Flash error */
+
+/* Flash memory */
+#define IFLASH_ADDR         0x00400000UL
+#define IFLASH_SIZE         0x00200000UL
+#define IFLASH_PAGE_SIZE    512
+
 /*
  * Watchdog Timer (WDT)
  * Used to auto-reset MCU if code hangs
@@ -206,4 +250,61 @@ typedef struct {
 #define WDT_SR_WDUNF        (1 << 0)        /* Underflow */
 #define WDT_SR_WDERR        (1 << 1)        /* Error */
 
+/*
+ * Real-time Timer (RTT)
+ * Runs from the 32.768 kHz slow clock, keeps counting in sleep modes
+ */
+#define RTT_BASE            (PERIPH_BASE + 0x000E1830UL)
+
+typedef struct {
+    volatile uint32_t RTT_MR;       /* 0x00 Mode Register */
+    volatile uint32_t RTT_AR;       /* 0x04 Alarm Register */
+    volatile uint32_t RTT_VR;       /* 0x08 Value Register */
+    volatile uint32_t RTT_SR;       /* 0x0C Status Register */
+} RTT_TypeDef;
+
+#define RTT                 ((RTT_TypeDef *)RTT_BASE)
+
+/* RTT Mode Register */
+#define RTT_MR_RTPRES(x)    ((x) & 0xFFFF)          /* Prescaler */
+#define RTT_MR_ALMIEN       (1 << 16)               /* Alarm interrupt enable */
+#define RTT_MR_RTTINCIEN    (1 << 17)               /* Increment interrupt enable */
+#define RTT_MR_RTTRST       (1 << 18)               /* Restart counter */
+#define RTT_MR_RTTDIS       (1 << 20)               /* Disable counter */
+
+/* RTT Status Register */
+#define RTT_SR_ALMS         (1 << 0)        /* Alarm status */
+#define RTT_SR_RTTINC       (1 << 1)        /* Increment status */
+
+/* Peripheral ID */
+#define ID_RTT              3
+
+/*
+ * Cortex-M7 core: NVIC and System Control Block
+ */
+#define NVIC_ISER0          (*(volatile uint32_t *)0xE000E100UL)
+#define NVIC_ICER0          (*(volatile uint32_t *)0xE000E180UL)
+#define NVIC_ICPR0          (*(volatile uint32_t *)0xE000E280UL)
+#define SCB_SCR             (*(volatile uint32_t *)0xE000ED10UL)
+
+#define SCB_SCR_SLEEPDEEP   (1 << 2)
+
+/* Tightly coupled data memory (size set by GPNVM bits 7..8) */
+#define SCB_DTCMCR          (*(volatile uint32_t *)0xE000EF94UL)
+#define SCB_DTCMCR_EN       (1 << 0)
+#define DTCM_BASE           0x20000000UL
+
+/*
+ * Cortex-M7 Data Watchpoint and Trace (DWT) cycle counter
+ * Used for on-target cycle benchmarks
+ */
+#define DEMCR               (*(volatile uint32_t *)0xE000EDFCUL)
+#define DWT_CTRL            (*(volatile uint32_t *)0xE0001000UL)
+#define DWT_CYCCNT          (*(volatile uint32_t *)0xE0001004UL)
+#define DWT_LAR             (*(volatile uint32_t *)0xE0001FB0UL)
+
+#define DEMCR_TRCENA        (1 << 24)       /* Enable DWT/ITM */
+#define DWT_CTRL_CYCCNTENA  (1 << 0)        /* Enable cycle counter */
+#define DWT_LAR_KEY         0xC5ACCE55UL    /* Unlock key */
+
 #endif /* SAMS70_H */
@@ -0,0 +1,117 @@
+/*
+ * IF Gain Control Implementation
+ *
+ * Decisions use only the chirps that passed the unpack checks: an
+ * interfering radar clips a chirp or two, which are replaced anyway
+ * and must not cost the whole scene 5 dB.
+ */
+
+#include "agc.h"
+#include <string.h>
+
+void agc_init(agc_t *agc, radar_dev_t *dev, uint32_t frame_period_ms)
+{
+    memset(agc, 0, sizeof(*agc));
+    agc->dev = dev;
+    agc->frame_period_ms = frame_period_ms;
+    agc->since_step_ms = AGC_INTERVAL_MS;
+}
+
+void agc_set_frame_period(agc_t *agc, uint32_t frame_period_ms)
+{
+    agc->frame_period_ms = frame_period_ms;
+}
+
+/* Largest excursion from mid-scale and clipping over the good chirps */
+static uint16_t frame_peak(const radar_frame_t *frame, bool *clipped)
+{
+    if (!frame->chirp_stats || frame->bad_chirps == 0) {
+        *clipped = (frame->clips > 0);
+        return frame->peak;
+    }
+
+    uint16_t num_chirps = frame->num_chirps ? frame->num_chirps : RADAR_NUM_CHIRPS;
+    uint16_t peak = 0;
+    *clipped = false;
+    for (uint16_t c = 0; c < num_chirps; c++) {
+        const radar_chirp_stats_t *st = &frame->chirp_stats[c];
+        if (st->bad) {
+            continue;
+        }
+        uint16_t lo = (st->min < RADAR_ADC_MID) ? RADAR_ADC_MID - st->min : 0;
+        uint16_t hi = (st->max > RADAR_ADC_MID) ? st->max - RADAR_ADC_MID : 0;
+        peak = (lo > peak) ? lo : peak;
+        peak = (hi > peak) ? hi : peak;
+        *clipped |= (st->clips > 0);
+    }
+    return peak;
+}
+
+bool agc_update(agc_t *agc, const radar_frame_t *frame)
+{
+    const radar_gain_t *g = &agc->dev->gain;
+
+    if (!frame || !frame->valid) {
+        return false;
+    }
+    uint32_t elapsed = (uint32_t)(frame->gap + 1) * agc->frame_period_ms;
+    if (agc->since_step_ms < AGC_UP_AFTER_DOWN_MS) {
+        agc->since_step_ms += elapsed;
+    }
+
+    /* Step in flight, or the frame predates it */
+    int8_t gain_db = (int8_t)(((int)g->vga - (int)g->ref_vga) * AVIAN_VGA_STEP_DB);
+    if (g->pending || frame->gain_db != gain_db || frame->hpf_khz != radar_hpf_khz(g->hpf)) {
+        return false;
+    }
+
+    bool clipped;
+    uint16_t peak = frame_peak(frame, &clipped);
+    bool high = clipped || (peak > AGC_PEAK_HIGH);
+    bool quiet = (peak < AGC_PEAK_LOW) && (frame->chirp_energy < AGC_NOISE_HIGH);
+
+    agc->clipped_frames += clipped;
+    if (!quiet) {
+        agc->quiet_ms = 0;
+    } else if (agc->quiet_ms < AGC_UP_HOLD_MS) {
+        agc->quiet_ms += elapsed;
+    }
+
+    uint8_t vga = g->vga;
+    uint8_t hpf = g->hpf;
+    bool down = false;
+
+    /* Down at once: every frame near full scale distorts the range profile */
+    if (high && agc->since_step_ms >= AGC_INTERVAL_MS) {
+        if (vga > 0) {
+            vga--;
+        } else if (hpf < AVIAN_HPF_SEL_MAX) {
+            hpf++;
+        }
+        down = true;
+    } else if (agc->quiet_ms >= AGC_UP_HOLD_MS &&
+               agc->since_step_ms >= (agc->last_down ? AGC_UP_AFTER_DOWN_MS : AGC_INTERVAL_MS)) {
+        if (hpf > g->ref_hpf) {
+            hpf--;
+        } else if (vga < AVIAN_VGA_GAIN_MAX) {
+            vga++;
+        }
+    }
+
+    if (vga == g->vga && hpf == g->hpf) {
+        return false;                       /* No step wanted, or at the limit */
+    }
+    if (!radar_dev_set_if_gain(agc->dev, vga, hpf)) {
+        return false;
+    }
+
+    agc->last_down = down;
+    agc->since_step_ms = 0;
+    agc->quiet_ms = 0;
+    if (down) {
+        agc->steps_down++;
+    } else {
+        agc->steps_up++;
+    }
+    return true;
+}
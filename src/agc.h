@@ -0,0 +1,69 @@
+/*
+ * IF Gain Control (AGC)
+ *
+ * Adjusts the Avian's VGA gain and high-pass cut-off (CSU1_2) from the
+ * per-frame unpack statistics, between frames:
+ *   down  at the first frame with clipped samples or a peak above
+ *         AGC_PEAK_HIGH, outside replaced (interference) chirps. At
+ *         the lowest VGA gain the high-pass moves up one step instead
+ *         (near, strong reflectors sit at low beat frequencies).
+ *   up    the peak stayed below AGC_PEAK_LOW and the noise (median
+ *         chirp mean square) below AGC_NOISE_HIGH for AGC_UP_HOLD_MS:
+ *         a raised high-pass comes back toward the exported cut-off
+ *         first, then the VGA gain goes up. Above AGC_NOISE_HIGH the IF
+ *         noise already dominates the ADC's, more gain would not help.
+ * One step (5 dB, or one cut-off) at most per AGC_INTERVAL_MS, and
+ * AGC_UP_AFTER_DOWN_MS before stepping up after a step down; the
+ * thresholds are 11 dB apart, more than a step, so a stable scene
+ * does not oscillate.
+ *
+ * Frames carry the setting they were acquired with; presence detection
+ * scales them back to the exported setting (presence_update), so a step
+ * does not move its backgrounds.
+ */
+
+#ifndef AGC_H
+#define AGC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "avian_radar.h"
+
+#define AGC_INTERVAL_MS         1000
+#define AGC_UP_HOLD_MS          5000
+#define AGC_UP_AFTER_DOWN_MS    30000
+#define AGC_PEAK_HIGH           (RADAR_ADC_MID * 7 / 8)    /* Excursion from mid-scale */
+#define AGC_PEAK_LOW            (RADAR_ADC_MID / 4)
+#define AGC_NOISE_HIGH          64                          /* Mean square (8 LSB rms) */
+
+typedef struct {
+    radar_dev_t *dev;
+    uint32_t frame_period_ms;
+    uint32_t since_step_ms;         /* Time since the last step */
+    uint32_t quiet_ms;              /* Time with headroom for a step up */
+    bool last_down;
+
+    /* Statistics (telemetry) */
+    uint32_t clipped_frames;
+    uint16_t steps_up;
+    uint16_t steps_down;
+} agc_t;
+
+/*
+ * Start at the device's current setting
+ */
+void agc_init(agc_t *agc, radar_dev_t *dev, uint32_t frame_period_ms);
+
+/*
+ * New frame period (frame rate profile change)
+ */
+void agc_set_frame_period(agc_t *agc, uint32_t frame_period_ms);
+
+/*
+ * Update with a frame's statistics; requests a new setting from the
+ * driver (written between frames). Frames acquired before the last
+ * step took effect are skipped. Returns true if a step was requested.
+ */
+bool agc_update(agc_t *agc, const radar_frame_t *frame);
+
+#endif /* AGC_H */
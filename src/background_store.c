@@ -0,0 +1,209 @@
+/*
+ * Persistent Background Model Implementation
+ */
+
+#include "background_store.h"
+#include "flash.h"
+#include "rtt.h"
+#include "avian_radar.h"
+#include <stddef.h>
+#include <string.h>
+
+#define BG_SLOTS_PER_BLOCK      (FLASH_ERASE_BLOCK_SIZE / BG_SLOT_SIZE)
+#define BG_RANGE_BINS           (RADAR_NUM_SAMPLES / 2)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t config_hash;
+    uint8_t version;
+    uint8_t domain;
+    uint8_t num_bins;
+    uint8_t reserved;
+    float threshold;
+    float bin_threshold[BG_RANGE_BINS];
+    uint8_t bins[PRESENCE_MAX_SPARSE_BINS];
+    float slow_avg[BG_RANGE_BINS];
+    float fast_avg[BG_RANGE_BINS];
+    int32_t clutter_map[RADAR_NUM_SAMPLES];
+    uint32_t crc;                       /* CRC-32 of everything above */
+} bg_record_t;
+
+_Static_assert(sizeof(bg_record_t) <= BG_SLOT_SIZE, "record exceeds slot");
+_Static_assert(BG_NUM_SLOTS * BG_SLOT_SIZE == FLASH_STORAGE_SIZE, "slots must fill storage");
+
+static bg_record_t record;
+static int32_t latest_slot = -1;
+static uint32_t latest_sequence = 0;
+static uint32_t last_save_tick = 0;
+static int32_t erase_slot = -1;         /* First slot of the block to erase ahead, -1: none */
+static uint32_t boot_hash = 0;          /* Configuration a record must match at boot */
+
+static uint32_t crc32(const void *data, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= p[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static const bg_record_t *slot_record(int32_t slot)
+{
+    return (const bg_record_t *)(uintptr_t)(FLASH_STORAGE_ADDR + (uint32_t)slot * BG_SLOT_SIZE);
+}
+
+static bool record_valid(const bg_record_t *rec)
+{
+    return rec->magic == BG_RECORD_MAGIC &&
+           rec->version == BG_RECORD_VERSION &&
+           rec->crc == crc32(rec, offsetof(bg_record_t, crc));
+}
+
+static uint32_t slot_addr(int32_t slot)
+{
+    return FLASH_STORAGE_ADDR + (uint32_t)slot * BG_SLOT_SIZE;
+}
+
+/* Erase the next block ahead of the writer once the newest record is
+ * in the other block, so a save programs pages only */
+static void plan_erase(void)
+{
+    int32_t next = (latest_slot + 1) % BG_NUM_SLOTS;
+    if (next % BG_SLOTS_PER_BLOCK == 0 && !flash_is_blank(slot_addr(next), FLASH_ERASE_BLOCK_SIZE)) {
+        erase_slot = next;
+    }
+}
+
+void background_store_init(void)
+{
+    latest_slot = -1;
+    latest_sequence = 0;
+
+    for (int32_t slot = 0; slot < BG_NUM_SLOTS; slot++) {
+        const bg_record_t *rec = slot_record(slot);
+        if (record_valid(rec) && (latest_slot < 0 || rec->sequence > latest_sequence)) {
+            latest_slot = slot;
+            latest_sequence = rec->sequence;
+        }
+    }
+
+    erase_slot = -1;
+    if (latest_slot >= 0) {
+        plan_erase();
+    }
+    boot_hash = radar_config_hash();
+    last_save_tick = rtt_now();
+}
+
+bool background_store_restore(presence_ctx_t *ctx)
+{
+    if (latest_slot < 0) {
+        return false;
+    }
+
+    const bg_record_t *rec = slot_record(latest_slot);
+    if (rec->config_hash != radar_config_hash() ||
+        rec->domain != (uint8_t)ctx->domain ||
+        rec->num_bins != ctx->num_bins ||
+        memcmp(rec->bins, ctx->bins, ctx->num_bins) != 0) {
+        return false;
+    }
+
+    for (int b = 0; b < ctx->num_bins; b++) {
+        int i = ctx->bins[b];
+        ctx->slow_avg[i] = rec->slow_avg[i];
+        ctx->fast_avg[i] = rec->fast_avg[i];
+    }
+    ctx->threshold = rec->threshold;
+    memcpy(ctx->bin_threshold, rec->bin_threshold, sizeof(ctx->bin_threshold));
+    ctx->first_run = false;
+
+    radar_set_clutter_map(rec->clutter_map);
+    return true;
+}
+
+bool background_store_save(const presence_ctx_t *ctx)
+{
+    if (ctx->first_run) {
+        return false;
+    }
+
+    /* Build the record */
+    memset(&record, 0, sizeof(record));
+    record.magic = BG_RECORD_MAGIC;
+    record.sequence = latest_sequence + 1;
+    record.config_hash = radar_config_hash();
+    record.version = BG_RECORD_VERSION;
+    record.domain = (uint8_t)ctx->domain;
+    record.num_bins = ctx->num_bins;
+    record.threshold = ctx->threshold;
+    memcpy(record.bin_threshold, ctx->bin_threshold, sizeof(record.bin_threshold));
+    memcpy(record.bins, ctx->bins, ctx->num_bins);
+    for (int b = 0; b < ctx->num_bins; b++) {
+        int i = ctx->bins[b];
+        record.slow_avg[i] = ctx->slow_avg[i];
+        record.fast_avg[i] = ctx->fast_avg[i];
+    }
+    radar_get_clutter_map(record.clutter_map);
+    record.crc = crc32(&record, offsetof(bg_record_t, crc));
+
+    /* Next slot. Its block is normally erased ahead (plan_erase); erase
+     * it here if that has not run yet, or skip to the next block if the
+     * slot was left dirty (interrupted write) */
+    int32_t slot = (latest_slot + 1) % BG_NUM_SLOTS;
+    uint32_t addr = slot_addr(slot);
+
+    if (!flash_is_blank(addr, BG_SLOT_SIZE)) {
+        if (slot % BG_SLOTS_PER_BLOCK != 0) {
+            slot = (slot / BG_SLOTS_PER_BLOCK + 1) * BG_SLOTS_PER_BLOCK % BG_NUM_SLOTS;
+            addr = slot_addr(slot);
+        }
+        if (!flash_erase_block(addr)) {
+            return false;
+        }
+        erase_slot = -1;
+    }
+
+    if (!flash_write(addr, &record, sizeof(record)) || !record_valid(slot_record(slot))) {
+        return false;
+    }
+
+    latest_slot = slot;
+    latest_sequence = record.sequence;
+    plan_erase();
+    return true;
+}
+
+bool background_store_update(const presence_ctx_t *ctx)
+{
+    uint32_t now = rtt_now();
+
+    if (ctx->presence_detected) {
+        return false;
+    }
+
+    /* One flash operation per frame: a pending erase goes first */
+    if (erase_slot >= 0) {
+        if (flash_erase_block(slot_addr(erase_slot))) {
+            erase_slot = -1;
+        }
+        return false;
+    }
+
+    if (now - last_save_tick < RTT_MS_TO_TICKS(BG_SAVE_PERIOD_MS)) {
+        return false;
+    }
+    /* Records from another frame rate profile would not restore at boot */
+    if (!ctx->full_evaluated || ctx->first_run || radar_config_hash() != boot_hash) {
+        return false;
+    }
+
+    last_save_tick = now;
+    return background_store_save(ctx);
+}
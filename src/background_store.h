@@ -0,0 +1,73 @@
+/*
+ * Persistent Background Model
+ *
+ * Snapshots the presence backgrounds (slow/fast averages of the
+ * configured bins), the calibrated thresholds and the radar clutter map
+ * to the reserved flash area, and restores them at boot so detection
+ * is reliable from the first frame instead of after the averages have
+ * converged.
+ *
+ * Wear leveling: the 16 KB area holds BG_NUM_SLOTS record slots in two
+ * 8 KB erase blocks, written round-robin. A block is erased once the
+ * newest record is in the other block, so that record survives a power
+ * loss during erase. The newest valid record wins at boot (highest
+ * sequence number with a good CRC).
+ *
+ * The CPU stalls with interrupts masked while flash is busy: a save
+ * programs two pages (~3 ms); the erase of the next block (tens of ms)
+ * runs on its own, at a later frame, ahead of the save that needs it.
+ *
+ * A record is only restored if its config hash (register profile,
+ * clutter mode, frame timing and reference gain, radar_config_hash())
+ * and its detection domain and bin set match the running
+ * configuration. Snapshots are only taken in the configuration of boot.
+ */
+
+#ifndef BACKGROUND_STORE_H
+#define BACKGROUND_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "presence_detection.h"
+
+#define BG_SLOT_SIZE            1024    /* Two flash pages per record */
+#define BG_NUM_SLOTS            16
+#define BG_RECORD_MAGIC         0x31474B42UL    /* "BKG1" */
+#define BG_RECORD_VERSION       2       /* 2: per-bin thresholds */
+
+/* Snapshot policy: every 30 min, only while the room is empty.
+ * 16 slots -> each block erased every 8 snapshots (4 h), ~10k erase
+ * cycles last > 4 years. */
+#define BG_SAVE_PERIOD_MS       (30UL * 60UL * 1000UL)
+
+/*
+ * Find the newest valid record (call once at boot, with the frame
+ * timing of boot programmed)
+ */
+void background_store_init(void);
+
+/*
+ * Load the newest record into ctx (and the radar clutter map) if it
+ * matches the running configuration; clears ctx->first_run.
+ * Call after the presence and clutter filter configuration is final.
+ * Returns true if restored.
+ */
+bool background_store_restore(presence_ctx_t *ctx);
+
+/*
+ * Write a snapshot now (blocks while flash is programmed; erases the
+ * block too if the erase ahead has not run)
+ */
+bool background_store_save(const presence_ctx_t *ctx);
+
+/*
+ * Per-frame policy hook; call at the end of the frame's processing.
+ * At most one flash operation per call, only without presence: a
+ * pending block erase, else a save when BG_SAVE_PERIOD_MS has passed
+ * since the last save (or boot), the frame was evaluated and the
+ * configuration is the one of boot.
+ * Returns true if a snapshot was written.
+ */
+bool background_store_update(const presence_ctx_t *ctx);
+
+#endif /* BACKGROUND_STORE_H */
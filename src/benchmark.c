@@ -0,0 +1,153 @@
+/*
+ * On-target cycle benchmarks
+ *
+ * Each benchmark runs BENCHMARK_ITERATIONS calls on synthetic inputs
+ * and stores the average cycles per call.
+ */
+
+#include "benchmark.h"
+#include "cycles.h"
+#include "wave_detector.h"
+#include "presence_detection.h"
+#include "gesture.h"
+#include "avian_registers.h"
+
+benchmark_results_t benchmark_results;
+
+static int16_t bench_samples[RADAR_NUM_SAMPLES * RADAR_NUM_CHIRPS];
+static radar_frame_t bench_frame = { .samples = bench_samples };
+static presence_ctx_t bench_presence;
+static gesture_t bench_gesture;
+
+/* Simple LCG so inputs differ between iterations */
+static uint32_t bench_seed = 12345;
+
+static float bench_rand01(void)
+{
+    bench_seed = bench_seed * 1664525UL + 1013904223UL;
+    return (float)(bench_seed >> 8) / 16777216.0f;
+}
+
+static void benchmark_wave(void)
+{
+    float window[WAVE_WINDOW_SIZE];
+    wave_result_t res_f, res_q;
+    uint32_t total_f = 0;
+    uint32_t total_q = 0;
+    uint32_t mismatches = 0;
+
+    for (int n = 0; n < BENCHMARK_ITERATIONS; n++) {
+        for (int i = 0; i < WAVE_WINDOW_SIZE; i++) {
+            window[i] = bench_rand01();
+        }
+
+        uint32_t t0 = cycles_now();
+        wave_detect(window, &res_f);
+        uint32_t t1 = cycles_now();
+        wave_detect_q8(window, &res_q);
+        uint32_t t2 = cycles_now();
+
+        total_f += t1 - t0;
+        total_q += t2 - t1;
+        if (res_f.predicted_class != res_q.predicted_class) {
+            mismatches++;
+        }
+    }
+
+    benchmark_results.wave_float_cycles = total_f / BENCHMARK_ITERATIONS;
+    benchmark_results.wave_q8_cycles = total_q / BENCHMARK_ITERATIONS;
+    benchmark_results.wave_mismatches = mismatches;
+}
+
+/* Average presence_detect() cycles with the current context config */
+static uint32_t benchmark_presence_once(void)
+{
+    uint32_t total = 0;
+
+    for (int n = 0; n < BENCHMARK_ITERATIONS; n++) {
+        for (int i = 0; i < RADAR_NUM_SAMPLES * RADAR_NUM_CHIRPS; i++) {
+            bench_frame.samples[i] = (int16_t)((bench_rand01() - 0.5f) * 400.0f);
+        }
+
+        uint32_t t0 = cycles_now();
+        presence_detect(&bench_presence, &bench_frame);
+        total += cycles_now() - t0;
+    }
+
+    return total / BENCHMARK_ITERATIONS;
+}
+
+static void benchmark_presence(void)
+{
+    uint8_t bins[BENCHMARK_SPARSE_BINS];
+
+    bench_frame.valid = true;
+    presence_init(&bench_presence);
+    presence_set_spectrum_mode(&bench_presence, PRESENCE_SPECTRUM_FULL);
+    benchmark_results.presence_full_cycles = benchmark_presence_once();
+
+    presence_set_domain(&bench_presence, PRESENCE_DOMAIN_POWER);
+    benchmark_results.presence_power_cycles = benchmark_presence_once();
+    presence_set_domain(&bench_presence, PRESENCE_DOMAIN_LOG2);
+    benchmark_results.presence_log2_cycles = benchmark_presence_once();
+    presence_set_domain(&bench_presence, PRESENCE_DOMAIN_LINEAR);
+
+    benchmark_results.sparse_crossover_bins = 0;
+    for (int k = 1; k <= BENCHMARK_SPARSE_BINS; k++) {
+        for (int i = 0; i < k; i++) {
+            bins[i] = (uint8_t)(DETECT_START_SAMPLE + i);
+        }
+        presence_init(&bench_presence);
+        presence_set_bins(&bench_presence, bins, (uint8_t)k);
+        presence_set_spectrum_mode(&bench_presence, PRESENCE_SPECTRUM_SPARSE);
+
+        uint32_t cycles = benchmark_presence_once();
+        benchmark_results.presence_sparse_cycles[k - 1] = cycles;
+        if (cycles < benchmark_results.presence_full_cycles) {
+            benchmark_results.sparse_crossover_bins = (uint32_t)k;
+        }
+    }
+}
+
+/* Gesture stages on a presence context left by benchmark_presence() */
+static void benchmark_gesture(void)
+{
+    uint32_t total_idle = 0;
+    uint32_t total_extract = 0;
+    uint32_t total_classify = 0;
+
+    presence_init(&bench_presence);
+    presence_detect(&bench_presence, &bench_frame);
+    presence_detect(&bench_presence, &bench_frame);
+    bench_presence.full_evaluated = true;
+    gesture_init(&bench_gesture, AVIAN_CHIRP_TIME_US);
+
+    for (int n = 0; n < BENCHMARK_ITERATIONS; n++) {
+        bench_frame.motion_energy = 100;   /* Constant: stays below the wake ratio */
+
+        uint32_t t0 = cycles_now();
+        gesture_update(&bench_gesture, &bench_presence, &bench_frame);
+        uint32_t t1 = cycles_now();
+        gesture_extract(&bench_gesture, &bench_presence, &bench_frame,
+                        &bench_gesture.window[n & (GESTURE_WINDOW - 1)]);
+        uint32_t t2 = cycles_now();
+        gesture_classify(&bench_gesture, GESTURE_WINDOW);
+        uint32_t t3 = cycles_now();
+
+        total_idle += t1 - t0;
+        total_extract += t2 - t1;
+        total_classify += t3 - t2;
+    }
+
+    benchmark_results.gesture_idle_cycles = total_idle / BENCHMARK_ITERATIONS;
+    benchmark_results.gesture_extract_cycles = total_extract / BENCHMARK_ITERATIONS;
+    benchmark_results.gesture_classify_cycles = total_classify / BENCHMARK_ITERATIONS;
+}
+
+void benchmark_run(void)
+{
+    cycles_init();
+    benchmark_wave();
+    benchmark_presence();
+    benchmark_gesture();
+}
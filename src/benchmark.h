@@ -0,0 +1,36 @@
+/*
+ * On-target cycle benchmarks
+ * Built only with `make BENCHMARK=1`; results are left in a global
+ * struct for inspection with the debugger.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdint.h>
+
+#define BENCHMARK_ITERATIONS    100
+#define BENCHMARK_SPARSE_BINS   16      /* Sparse spectrum sizes 1..N */
+
+typedef struct {
+    uint32_t wave_float_cycles;     /* wave_detect() per call */
+    uint32_t wave_q8_cycles;        /* wave_detect_q8() per call */
+    uint32_t wave_mismatches;       /* argmax disagreements over the run */
+    uint32_t presence_full_cycles;  /* presence_detect(), full FFT */
+    uint32_t presence_power_cycles; /* Same, PRESENCE_DOMAIN_POWER */
+    uint32_t presence_log2_cycles;  /* Same, PRESENCE_DOMAIN_LOG2 */
+    uint32_t presence_sparse_cycles[BENCHMARK_SPARSE_BINS]; /* [k-1]: k Goertzel bins */
+    uint32_t sparse_crossover_bins; /* Largest k where sparse beats full */
+    uint32_t gesture_idle_cycles;   /* gesture_update(), no motion (early exit) */
+    uint32_t gesture_extract_cycles;/* gesture_extract(), per active frame */
+    uint32_t gesture_classify_cycles; /* gesture_classify(), per segment */
+} benchmark_results_t;
+
+extern benchmark_results_t benchmark_results;
+
+/*
+ * Run all benchmarks (blocking)
+ */
+void benchmark_run(void);
+
+#endif /* BENCHMARK_H */
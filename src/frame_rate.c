@@ -0,0 +1,81 @@
+/*
+ * Adaptive Frame Rate Controller Implementation
+ *
+ * Switching happens between frames: only the CCR1/CCR2 timing fields
+ * are rewritten (radar_set_frame_timing) and take effect on the next
+ * frame start.
+ */
+
+#include "frame_rate.h"
+#include "avian_radar.h"
+#include "avian_registers.h"
+#include "power_scheduler.h"
+
+static const frame_rate_profile_t profiles[FRAME_RATE_NUM_PROFILES] = {
+    [FRAME_RATE_HIGH] = { RADAR_NUM_CHIRPS, AVIAN_FRAME_TIME_MS },  /* ~13 Hz */
+    [FRAME_RATE_LOW]  = { 16,               250 },                  /* 4 Hz */
+};
+
+/* Returns false (level kept) if the sensor rejected the timing */
+static bool apply_level(frame_rate_ctrl_t *ctrl, presence_ctx_t *presence,
+                        frame_rate_level_t level)
+{
+    const frame_rate_profile_t *p = &profiles[level];
+
+    if (!radar_set_frame_timing(p->num_chirps, (uint32_t)p->frame_period_ms * 1000UL)) {
+        return false;
+    }
+
+    power_scheduler_set_period(p->frame_period_ms,
+                               ((uint32_t)p->num_chirps * AVIAN_CHIRP_TIME_US + 999) / 1000);
+    presence_set_frame_period(presence, p->frame_period_ms);
+    ctrl->level = level;
+    return true;
+}
+
+void frame_rate_init(frame_rate_ctrl_t *ctrl, presence_ctx_t *presence)
+{
+    ctrl->idle_ms = 0;
+    ctrl->switches = 0;
+    apply_level(ctrl, presence, FRAME_RATE_HIGH);
+}
+
+bool frame_rate_update(frame_rate_ctrl_t *ctrl, presence_ctx_t *presence)
+{
+    /* Two-tier gate awake counts as motion even before presence is confirmed */
+    bool motion = presence->presence_detected ||
+                  (presence->mode == PRESENCE_MODE_TWO_TIER && presence->gate_awake);
+    frame_rate_level_t target = ctrl->level;
+
+    if (motion) {
+        ctrl->idle_ms = 0;
+        target = FRAME_RATE_HIGH;
+    } else {
+        ctrl->idle_ms += profiles[ctrl->level].frame_period_ms;
+        if (ctrl->idle_ms >= FRAME_RATE_IDLE_MS) {
+            target = FRAME_RATE_LOW;
+        }
+    }
+
+    if (target == ctrl->level || !apply_level(ctrl, presence, target)) {
+        return false;
+    }
+    ctrl->switches++;
+    return true;
+}
+
+const frame_rate_profile_t* frame_rate_profile(const frame_rate_ctrl_t *ctrl)
+{
+    return &profiles[ctrl->level];
+}
+
+uint16_t frame_rate_max_chirps(void)
+{
+    uint16_t max = 0;
+    for (int i = 0; i < FRAME_RATE_NUM_PROFILES; i++) {
+        if (profiles[i].num_chirps > max) {
+            max = profiles[i].num_chirps;
+        }
+    }
+    return max;
+}
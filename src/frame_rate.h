@@ -0,0 +1,61 @@
+/*
+ * Adaptive Frame Rate Controller
+ *
+ * Drops to a low-rate profile (fewer chirps, longer frame period) after
+ * FRAME_RATE_IDLE_MS without presence or motion, and returns to the
+ * high-rate profile on the first frame with motion. Worst-case extra
+ * first-detection latency is one low-rate frame period.
+ */
+
+#ifndef FRAME_RATE_H
+#define FRAME_RATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "presence_detection.h"
+
+/* Time without presence/motion before dropping to low rate */
+#define FRAME_RATE_IDLE_MS      10000
+
+typedef enum {
+    FRAME_RATE_HIGH = 0,
+    FRAME_RATE_LOW,
+    FRAME_RATE_NUM_PROFILES
+} frame_rate_level_t;
+
+typedef struct {
+    uint16_t num_chirps;
+    uint16_t frame_period_ms;
+} frame_rate_profile_t;
+
+typedef struct {
+    frame_rate_level_t level;
+    uint32_t idle_ms;               /* Time since last presence/motion */
+    uint32_t switches;              /* Profile changes since init */
+} frame_rate_ctrl_t;
+
+/*
+ * Initialize controller in the high-rate profile and program it
+ */
+void frame_rate_init(frame_rate_ctrl_t *ctrl, presence_ctx_t *presence);
+
+/*
+ * Update after each frame's presence_update()
+ * Reprograms sensor timing, scheduler period and presence alphas on a
+ * profile change. Returns true if the profile changed; a switch the
+ * sensor rejected leaves everything at the current profile (false) and
+ * is retried on the next frame.
+ */
+bool frame_rate_update(frame_rate_ctrl_t *ctrl, presence_ctx_t *presence);
+
+/*
+ * Active profile parameters
+ */
+const frame_rate_profile_t* frame_rate_profile(const frame_rate_ctrl_t *ctrl);
+
+/*
+ * Most chirps per frame of any profile (frame buffer size)
+ */
+uint16_t frame_rate_max_chirps(void);
+
+#endif /* FRAME_RATE_H */
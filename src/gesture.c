@@ -0,0 +1,291 @@
+/*
+ * Gesture Recognition Implementation
+ *
+ * Doppler: the target bin and its neighbours are evaluated per chirp
+ * with Goertzel (all bins in one pass over each chirp), the static
+ * component is removed by subtracting the mean over chirps, and the
+ * pulse-pair estimator gives the Doppler centroid from the phase of
+ * the lag-1 autocorrelation R1: v = lambda * arg(R1) / (4 pi Tc),
+ * unambiguous within +-lambda / (4 Tc) (~2.1 m/s at 591 us chirps).
+ */
+
+#include "gesture.h"
+#include "mem_arena.h"
+#include "avian_registers.h"
+#include <string.h>
+#include <math.h>
+
+#define GESTURE_PI      3.14159265f
+#define GESTURE_RANGE_BIN_M (299792458.0f / (2.0f * (float)AVIAN_BANDWIDTH_HZ))   /* ~2.7 cm */
+
+/* Per-chirp complex value of the Doppler bins (arena, first init) */
+static float (*chirp_bins)[RADAR_NUM_CHIRPS][2];
+
+static const char *gesture_names[GESTURE_NUM_CLASSES] = {
+    "none", "swipe", "push", "pull"
+};
+
+void gesture_init(gesture_t *g, uint32_t chirp_period_us)
+{
+    memset(g, 0, sizeof(gesture_t));
+    g->chirp_period_s = (float)chirp_period_us * 1e-6f;
+
+    if (chirp_bins == NULL) {
+        chirp_bins = mem_arena_alloc(sizeof(float) * GESTURE_DOPPLER_BINS * RADAR_NUM_CHIRPS * 2,
+                                     MEM_OWNER_GESTURE, MEM_PRIO_WARM);
+    }
+}
+
+const char *gesture_get_class_name(gesture_class_t gesture)
+{
+    return (gesture < GESTURE_NUM_CLASSES) ? gesture_names[gesture] : "unknown";
+}
+
+/* Range centroid, spread and energy from the fast-slow differences */
+static void range_features(const presence_ctx_t *presence, gesture_frame_t *out)
+{
+    float sum_w = 0.0f;
+    float sum_r = 0.0f;
+    float sum_r2 = 0.0f;
+
+    for (int b = 0; b < presence->num_bins; b++) {
+        int i = presence->bins[b];
+        float w = presence->fast_avg[i] - presence->slow_avg[i];
+        if (w <= 0.0f) {
+            continue;
+        }
+        float r = (float)i * GESTURE_RANGE_BIN_M;
+        sum_w += w;
+        sum_r += w * r;
+        sum_r2 += w * r * r;
+    }
+
+    out->energy = sum_w;
+    if (sum_w > 0.0f) {
+        float mean = sum_r / sum_w;
+        float var = sum_r2 / sum_w - mean * mean;
+        out->range_m = mean;
+        out->range_spread_m = var > 0.0f ? sqrtf(var) : 0.0f;
+    } else {
+        out->range_m = 0.0f;
+        out->range_spread_m = 0.0f;
+    }
+}
+
+/* Pulse-pair Doppler over the bins around the target */
+static void doppler_features(const gesture_t *g, const presence_ctx_t *presence,
+                             const radar_frame_t *frame, gesture_frame_t *out)
+{
+    int num_chirps = frame->num_chirps ? frame->num_chirps : RADAR_NUM_CHIRPS;
+    float coeff[GESTURE_DOPPLER_BINS];
+    float sin_w[GESTURE_DOPPLER_BINS];
+
+    if (chirp_bins == NULL) {
+        out->doppler_mps = 0.0f;
+        out->doppler_spread = 1.0f;
+        return;
+    }
+
+    /* Target bin and neighbours, kept off DC and Nyquist */
+    int first = (int)presence->max_idx - GESTURE_DOPPLER_BINS / 2;
+    if (first < 1) first = 1;
+    if (first > RADAR_NUM_SAMPLES / 2 - GESTURE_DOPPLER_BINS) {
+        first = RADAR_NUM_SAMPLES / 2 - GESTURE_DOPPLER_BINS;
+    }
+    for (int k = 0; k < GESTURE_DOPPLER_BINS; k++) {
+        float w = 2.0f * GESTURE_PI * (float)(first + k) / (float)RADAR_NUM_SAMPLES;
+        coeff[k] = 2.0f * cosf(w);
+        sin_w[k] = sinf(w);
+    }
+
+    /* Goertzel per chirp, all bins in one pass */
+    for (int c = 0; c < num_chirps; c++) {
+        const int16_t *chirp = &frame->samples[c * RADAR_NUM_SAMPLES];
+        float s1[GESTURE_DOPPLER_BINS] = {0};
+        float s2[GESTURE_DOPPLER_BINS] = {0};
+
+        for (int n = 0; n < RADAR_NUM_SAMPLES; n++) {
+            float x = (float)chirp[n];
+            for (int k = 0; k < GESTURE_DOPPLER_BINS; k++) {
+                float s0 = x + coeff[k] * s1[k] - s2[k];
+                s2[k] = s1[k];
+                s1[k] = s0;
+            }
+        }
+        for (int k = 0; k < GESTURE_DOPPLER_BINS; k++) {
+            chirp_bins[k][c][0] = s1[k] * 0.5f * coeff[k] - s2[k];
+            chirp_bins[k][c][1] = s1[k] * sin_w[k];
+        }
+    }
+
+    /* Static removal (mean chirp) and lag-0 / lag-1 autocorrelation */
+    float r0 = 0.0f;
+    float r1_re = 0.0f;
+    float r1_im = 0.0f;
+    float inv_chirps = 1.0f / (float)num_chirps;
+
+    for (int k = 0; k < GESTURE_DOPPLER_BINS; k++) {
+        float mean_re = 0.0f;
+        float mean_im = 0.0f;
+        for (int c = 0; c < num_chirps; c++) {
+            mean_re += chirp_bins[k][c][0];
+            mean_im += chirp_bins[k][c][1];
+        }
+        mean_re *= inv_chirps;
+        mean_im *= inv_chirps;
+
+        float prev_re = chirp_bins[k][0][0] - mean_re;
+        float prev_im = chirp_bins[k][0][1] - mean_im;
+        r0 += prev_re * prev_re + prev_im * prev_im;
+
+        for (int c = 1; c < num_chirps; c++) {
+            float re = chirp_bins[k][c][0] - mean_re;
+            float im = chirp_bins[k][c][1] - mean_im;
+            r0 += re * re + im * im;
+            /* x[c] * conj(x[c-1]) */
+            r1_re += re * prev_re + im * prev_im;
+            r1_im += im * prev_re - re * prev_im;
+            prev_re = re;
+            prev_im = im;
+        }
+    }
+
+    if (r0 > 0.0f) {
+        float mag = sqrtf(r1_re * r1_re + r1_im * r1_im);
+        out->doppler_mps = atan2f(r1_im, r1_re) * GESTURE_WAVELENGTH_M /
+                           (4.0f * GESTURE_PI * g->chirp_period_s);
+        out->doppler_spread = 1.0f - mag / r0;
+    } else {
+        out->doppler_mps = 0.0f;
+        out->doppler_spread = 1.0f;
+    }
+}
+
+void gesture_extract(const gesture_t *g, const presence_ctx_t *presence,
+                     const radar_frame_t *frame, gesture_frame_t *out)
+{
+    range_features(presence, out);
+    doppler_features(g, presence, frame, out);
+    out->angle_deg = 0.0f;     /* Single RX channel */
+}
+
+void gesture_classify(gesture_t *g, uint32_t frames)
+{
+    gesture_result_t *res = &g->result;
+
+    if (frames > GESTURE_WINDOW) {
+        frames = GESTURE_WINDOW;
+    }
+
+    /* Energy-weighted linear fit of range over the segment, Doppler
+     * mean and sign reversals of significant Doppler */
+    float sw = 0.0f, st = 0.0f, sr = 0.0f, stt = 0.0f, str = 0.0f, sd = 0.0f;
+    int last_sign = 0;
+    int reversals = 0;
+
+    for (uint32_t n = 0; n < frames; n++) {
+        const gesture_frame_t *f =
+            &g->window[(g->head - frames + n) & (GESTURE_WINDOW - 1)];
+        float w = f->energy;
+        float t = (float)n;
+
+        sw += w;
+        st += w * t;
+        sr += w * f->range_m;
+        stt += w * t * t;
+        str += w * t * f->range_m;
+        sd += w * f->doppler_mps;
+
+        if (fabsf(f->doppler_mps) >= GESTURE_DOPPLER_MIN_MPS) {
+            int sign = f->doppler_mps > 0.0f ? 1 : -1;
+            if (last_sign != 0 && sign != last_sign) {
+                reversals++;
+            }
+            last_sign = sign;
+        }
+    }
+
+    float change = 0.0f;
+    float doppler = 0.0f;
+    if (sw > 0.0f) {
+        float denom = sw * stt - st * st;
+        if (denom > 0.0f) {
+            change = (sw * str - st * sr) / denom * (float)(frames - 1);
+        }
+        doppler = sd / sw;
+    }
+
+    gesture_class_t gesture = GESTURE_NONE;
+    if (change <= -GESTURE_PUSH_PULL_M) {
+        gesture = GESTURE_PUSH;
+    } else if (change >= GESTURE_PUSH_PULL_M) {
+        gesture = GESTURE_PULL;
+    } else if (fabsf(change) <= GESTURE_SWIPE_MAX_M && reversals > 0) {
+        gesture = GESTURE_SWIPE;
+    }
+
+    res->gesture = gesture;
+    res->frames = (uint8_t)frames;
+    res->range_change_m = change;
+    res->doppler_mean_mps = doppler;
+    res->sequence++;
+}
+
+bool gesture_update(gesture_t *g, const presence_ctx_t *presence, const radar_frame_t *frame)
+{
+    if (!frame || !frame->valid) {
+        return false;
+    }
+
+    /* Back to the exported IF gain (power), as presence_gate: an AGC
+     * step alone must not start or end a segment */
+    float motion = (float)frame->motion_energy;
+    if (frame->gain_db != 0) {
+        motion *= powf(10.0f, -(float)frame->gain_db / 10.0f);
+    }
+    if (g->motion_background <= 0.0f) {
+        g->motion_background = motion;
+    }
+
+    bool active = presence->full_evaluated && !presence->first_run &&
+                  motion > GESTURE_MOTION_RATIO * g->motion_background;
+
+    if (active) {
+        gesture_extract(g, presence, frame, &g->window[g->head]);
+        g->head = (g->head + 1) & (GESTURE_WINDOW - 1);
+        g->active_frames++;
+        g->quiet_frames = 0;
+        return false;
+    }
+
+    /* Early exit: no motion, no per-chirp work */
+    if (g->active_frames == 0) {
+        g->motion_background += GESTURE_BG_ALPHA * (motion - g->motion_background);
+        return false;
+    }
+
+    if (++g->quiet_frames < GESTURE_END_FRAMES) {
+        return false;
+    }
+
+    /* Segment ended */
+    uint32_t frames = g->active_frames;
+    g->active_frames = 0;
+    g->quiet_frames = 0;
+
+    if (frames < GESTURE_MIN_FRAMES) {
+        return false;
+    }
+    if (frames > GESTURE_WINDOW) {
+        /* Too long for a gesture (walking, fidgeting) */
+        g->result.gesture = GESTURE_NONE;
+        g->result.frames = (uint8_t)GESTURE_WINDOW;
+        g->result.range_change_m = 0.0f;
+        g->result.doppler_mean_mps = 0.0f;
+        g->result.sequence++;
+        return true;
+    }
+
+    gesture_classify(g, frames);
+    return true;
+}
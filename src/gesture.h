@@ -0,0 +1,109 @@
+/*
+ * Gesture Recognition (swipe / push / pull)
+ *
+ * Per frame, a compact feature vector is built from the presence
+ * pipeline output and the raw chirps of the target range bins:
+ *
+ *   range centroid / spread   fast-slow difference over the configured bins
+ *   Doppler centroid / spread pulse-pair estimate across chirps
+ *   angle                     0 until more than one RX channel is read
+ *   energy                    sum of positive fast-slow differences
+ *
+ * Feature vectors go into a rolling window of GESTURE_WINDOW frames.
+ * Motion is segmented by the frame motion energy (scaled back to the
+ * exported IF gain with the frame's gain tag); when a segment ends
+ * the temporal model classifies it from the range trend (push/pull)
+ * and Doppler sign reversals (swipe: the hand approaches then recedes
+ * while crossing the beam).
+ *
+ * Early exit: frames without motion energy skip the per-chirp work and
+ * only advance the segmenter. Cycle costs per stage: make BENCHMARK=1.
+ */
+
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "presence_detection.h"
+
+#define GESTURE_WINDOW          16      /* Frames (~1.2 s at 13 Hz), power of 2 */
+#define GESTURE_DOPPLER_BINS    3       /* Range bins around the target for Doppler */
+
+/* Segmentation on frame->motion_energy relative to its idle level */
+#define GESTURE_MOTION_RATIO    3.0f    /* Active above this */
+#define GESTURE_BG_ALPHA        0.02f   /* Idle level adaptation */
+#define GESTURE_MIN_FRAMES      3       /* Shortest gesture */
+#define GESTURE_END_FRAMES      2       /* Quiet frames that end a segment */
+
+/* Temporal model thresholds (calibrate on recorded gestures) */
+#define GESTURE_PUSH_PULL_M     0.10f   /* Net range change for push/pull */
+#define GESTURE_SWIPE_MAX_M     0.06f   /* Max net range change for a swipe */
+#define GESTURE_DOPPLER_MIN_MPS 0.15f   /* Doppler magnitude that counts as motion */
+
+/* Geometry; the range bin comes from the exported ramp (gesture.c) */
+#define GESTURE_WAVELENGTH_M    0.005f
+
+typedef enum {
+    GESTURE_NONE = 0,
+    GESTURE_SWIPE,
+    GESTURE_PUSH,               /* Towards the sensor */
+    GESTURE_PULL,               /* Away from the sensor */
+    GESTURE_NUM_CLASSES
+} gesture_class_t;
+
+/* Per-frame features */
+typedef struct {
+    float range_m;
+    float range_spread_m;
+    float doppler_mps;
+    float doppler_spread;       /* 1 - |R1| / R0, 0 = pure tone */
+    float angle_deg;
+    float energy;
+} gesture_frame_t;
+
+typedef struct {
+    gesture_class_t gesture;
+    uint8_t frames;             /* Segment length */
+    float range_change_m;       /* End - start range centroid */
+    float doppler_mean_mps;     /* Energy-weighted */
+    uint32_t sequence;          /* Increments per classified segment */
+} gesture_result_t;
+
+typedef struct {
+    gesture_frame_t window[GESTURE_WINDOW];     /* Ring, newest at head - 1 */
+    uint32_t head;
+    uint32_t active_frames;     /* Frames in the current segment */
+    uint32_t quiet_frames;
+    float motion_background;
+    float chirp_period_s;
+    gesture_result_t result;    /* Last classified segment */
+} gesture_t;
+
+/*
+ * Initialize; chirp_period_us sets the Doppler scale
+ */
+void gesture_init(gesture_t *g, uint32_t chirp_period_us);
+
+/*
+ * Update with one frame; call after presence_update() on every frame.
+ * Returns true when a segment was classified (g->result updated, also
+ * for GESTURE_NONE).
+ */
+bool gesture_update(gesture_t *g, const presence_ctx_t *presence, const radar_frame_t *frame);
+
+/*
+ * Feature extraction for one frame (exposed for benchmarking)
+ */
+void gesture_extract(const gesture_t *g, const presence_ctx_t *presence,
+                     const radar_frame_t *frame, gesture_frame_t *out);
+
+/*
+ * Temporal model over the last `frames` window entries (exposed for
+ * benchmarking)
+ */
+void gesture_classify(gesture_t *g, uint32_t frames);
+
+const char *gesture_get_class_name(gesture_class_t gesture);
+
+#endif /* GESTURE_H */
@@ -2,22 +2,46 @@
  * BJT60 Presence Detection Firmware - SIMPLE DEBUG
  */
 
+#include <stddef.h>
 #include "clock.h"
 #include "gpio.h"
 #include "spi.h"
 #include "avian_radar.h"
+#include "avian_registers.h"
+#include "power_scheduler.h"
+#include "frame_rate.h"
+#include "vital_signs.h"
+#include "occupancy.h"
+#include "gesture.h"
+#include "zones.h"
+#include "telemetry.h"
+#include "background_store.h"
 #include "presence_detection.h"
+#include "wave_features.h"
+#include "mem_arena.h"
+#include "trace.h"
+#include "supervisor.h"
+#include "agc.h"
+#include "watchdog.h"
+#ifdef BENCHMARK
+#include "benchmark.h"
+#endif
 
 static presence_ctx_t presence_ctx;
-
-/*
- * Disable watchdog
- */
-static void disable_watchdog(void)
-{
-    volatile uint32_t *WDT_MR = (volatile uint32_t *)0x400E1854;
-    *WDT_MR = (1 << 15);
-}
+static wave_features_t wave_features;
+static frame_rate_ctrl_t frame_rate;
+static vital_signs_t vital_signs;
+static occupancy_t occupancy;
+static gesture_t gesture;
+static zones_t zones;
+static supervisor_t supervisor;
+static agc_t agc;
+
+/* Range zones of the room (within the presence bins, ~0.22..0.87 m) */
+static const zone_config_t zone_config[] = {
+    { .name = "desk",    .start_m = 0.25f, .end_m = 0.55f, .threshold = 0.0f, .hold_ms = 5000 },
+    { .name = "doorway", .start_m = 0.55f, .end_m = 0.85f, .threshold = 0.0f, .hold_ms = 2000 },
+};
 
 /*
  * Simple blink using direct register access
@@ -39,7 +63,12 @@ static void blink(int count)
  */
 int main(void)
 {
-    disable_watchdog();
+    /* The watchdog runs from reset (~16 s) until the supervisor arms it
+     * for frame supervision. Benchmarks take longer: without it there
+     * (WDT_MR is write-once, so supervision has no watchdog either) */
+#ifdef BENCHMARK
+    watchdog_disable();
+#endif
 
     /* Enable LED */
     *((volatile uint32_t *)(0x400E0610)) = (1 << 16);
@@ -64,20 +93,148 @@ int main(void)
     /* CHECKPOINT 4 */
     blink(4);
 
+    /* Frame buffer for the largest frame profile, in DTCM if built
+     * with TCM_KB; kept by radar_init() */
+    trace_init();
+    mem_arena_init();
+    uint32_t frame_samples = (uint32_t)RADAR_NUM_SAMPLES * frame_rate_max_chirps();
+    radar_dev_set_frame_buffer(radar_default_dev(),
+                               mem_arena_alloc(frame_samples * sizeof(int16_t),
+                                               MEM_OWNER_RADAR, MEM_PRIO_HOT),
+                               frame_samples);
+
     radar_init();
 
+    /* Fastest reliable SPI clock (shortens every FIFO readout) */
+    radar_dev_link_train(radar_default_dev());
+
     /* CHECKPOINT 5 */
     blink(5);
 
+    /* Static clutter (DC, antenna coupling, furniture) removed during unpack */
+    radar_set_clutter_filter(RADAR_CLUTTER_MTI);
+
+    telemetry_init();
+    telemetry_send_link(&radar_default_dev()->link);
+
     presence_init(&presence_ctx);
+    presence_set_mode(&presence_ctx, PRESENCE_MODE_TWO_TIER);
+    wave_features_init(&wave_features, WAVE_FEATURE_STRIDE);
+
+#ifdef BENCHMARK
+    benchmark_run();
+#endif
+
+    /* Profile can be switched at runtime with power_scheduler_set_profile() */
+    power_scheduler_init(AVIAN_FRAME_TIME_MS,
+                         (AVIAN_NUM_CHIRPS * AVIAN_CHIRP_TIME_US + 999) / 1000);
+    power_scheduler_set_profile(POWER_PROFILE_PERFORMANCE);
+    frame_rate_init(&frame_rate, &presence_ctx);
+    vital_signs_init(&vital_signs, frame_rate_profile(&frame_rate)->frame_period_ms);
+    occupancy_init(&occupancy, AVIAN_CHIRP_TIME_US);
+    gesture_init(&gesture, AVIAN_CHIRP_TIME_US);
+    zones_init(&zones, NULL, frame_rate_profile(&frame_rate)->frame_period_ms);
+    for (unsigned z = 0; z < sizeof(zone_config) / sizeof(zone_config[0]); z++) {
+        zones_add(&zones, &zone_config[z]);
+    }
+
+    /* Warm start: backgrounds, thresholds and clutter map from the last
+     * snapshot. Without one, calibrate the bin thresholds on the first
+     * frames (room assumed empty at install); adapt online afterwards. */
+    background_store_init();
+    if (background_store_restore(&presence_ctx)) {
+        presence_set_online_calibration(&presence_ctx, true, CAL_DEFAULT_PFA);
+    } else {
+        presence_calibrate(&presence_ctx, CAL_DEFAULT_FRAMES, CAL_DEFAULT_PFA, true);
+    }
+
     radar_start();
+    agc_init(&agc, radar_default_dev(), frame_rate_profile(&frame_rate)->frame_period_ms);
+    supervisor_init(&supervisor, &presence_ctx, frame_rate_profile(&frame_rate)->frame_period_ms);
 
-    /* SUCCESS - continuous slow blink */
+    /* Main loop: acquire frame -> presence -> features -> LED, telemetry.
+     * Only processed frames kick the watchdog (supervisor). */
+    uint32_t frame_count = 0;
+    uint32_t trace_cursor = 0;
     while (1) {
-        *((volatile uint32_t *)(0x400E1434)) = (1 << 5);
-        for (volatile int j = 0; j < 3000000; j++);
-        *((volatile uint32_t *)(0x400E1430)) = (1 << 5);
-        for (volatile int j = 0; j < 3000000; j++);
+        const radar_frame_t *frame = power_scheduler_next_frame();
+        if (!frame) {
+            continue;
+        }
+
+        supervisor_frame_begin(&supervisor);
+        supervisor_stage_begin(&supervisor, SUPERVISOR_STAGE_PRESENCE, 0);
+        bool present = presence_update(&presence_ctx, frame);
+        supervisor_stage_end(&supervisor, SUPERVISOR_STAGE_PRESENCE, present);
+        agc_update(&agc, frame);
+        if (frame_rate_update(&frame_rate, &presence_ctx)) {
+            /* Filters are designed for the frame rate */
+            vital_signs_init(&vital_signs, frame_rate_profile(&frame_rate)->frame_period_ms);
+            zones_set_frame_period(&zones, frame_rate_profile(&frame_rate)->frame_period_ms);
+            supervisor_set_frame_period(&supervisor, frame_rate_profile(&frame_rate)->frame_period_ms);
+            agc_set_frame_period(&agc, frame_rate_profile(&frame_rate)->frame_period_ms);
+        }
+        supervisor_stage_begin(&supervisor, SUPERVISOR_STAGE_TRACKING, 0);
+        occupancy_update(&occupancy, &presence_ctx, frame);
+        zones_update(&zones, &presence_ctx);
+        supervisor_stage_end(&supervisor, SUPERVISOR_STAGE_TRACKING, zones.occupied_mask);
+
+        /* Classifiers are the first thing dropped on overrun */
+        bool classify = supervisor_run_classifiers(&supervisor);
+        if (classify) {
+            supervisor_stage_begin(&supervisor, SUPERVISOR_STAGE_GESTURE, 0);
+            gesture_update(&gesture, &presence_ctx, frame);
+            supervisor_stage_end(&supervisor, SUPERVISOR_STAGE_GESTURE, (uint16_t)gesture.result.gesture);
+        }
+
+        /* Classifier and vital signs only run on frames that went through the FFT */
+        if (presence_ctx.full_evaluated) {
+            if (classify) {
+                supervisor_stage_begin(&supervisor, SUPERVISOR_STAGE_FEATURES, 0);
+                wave_features_update(&wave_features, &presence_ctx);
+                supervisor_stage_end(&supervisor, SUPERVISOR_STAGE_FEATURES, 0);
+            }
+            supervisor_stage_begin(&supervisor, SUPERVISOR_STAGE_VITALS, 0);
+            vital_signs_update(&vital_signs, &presence_ctx);
+            supervisor_stage_end(&supervisor, SUPERVISOR_STAGE_VITALS, 0);
+        }
+
+        bool waving = classify && presence_ctx.gate_awake &&
+                      wave_features.result.valid &&
+                      wave_features.result.predicted_class == WAVE_CLASS_WAVING;
+
+        supervisor_stage_begin(&supervisor, SUPERVISOR_STAGE_OUTPUT, 0);
+        if (present || waving) {
+            led_on();
+        } else {
+            led_off();
+        }
+
+        telemetry_status_t status = {
+            .frame = frame_count++,
+            .presence = present,
+            .waving = waving,
+            .max_idx = presence_ctx.max_idx,
+            .occupancy = occupancy.occupancy,
+            .wave_class = (uint8_t)wave_features.result.predicted_class,
+            .gesture = (uint8_t)gesture.result.gesture,
+            .gesture_seq = (uint8_t)gesture.result.sequence,
+            .breathing_bpm = vital_signs.valid ? (uint8_t)(vital_signs.breathing_bpm + 0.5f) : 0,
+            .heart_bpm = vital_signs.valid ? (uint8_t)(vital_signs.heart_bpm + 0.5f) : 0,
+            .zones = zones.occupied_mask,
+        };
+        telemetry_send_status(&status);
+        supervisor_stage_end(&supervisor, SUPERVISOR_STAGE_OUTPUT, (uint16_t)(present | (waving << 1)));
+
+        if (supervisor_frame_end(&supervisor, radar_default_dev()->stream.late)) {
+            telemetry_send_supervisor(&supervisor);
+        }
+
+        /* Timeline of this frame (and anything not sent before) */
+        telemetry_send_trace(&trace_cursor);
+
+        /* Flash stalls the CPU: after the frame's work, outside its timing */
+        background_store_update(&presence_ctx);
     }
 
     return 0;
@@ -0,0 +1,96 @@
+/*
+ * Static Memory Arena Implementation
+ *
+ * Two bump allocators. The DTCM pool is placed in the .dtcm output
+ * section (link.ld), which is NOLOAD: allocations are zeroed here.
+ */
+
+#include "mem_arena.h"
+#include "sams70.h"
+#include <string.h>
+
+#if MEM_DTCM_BYTES > 0
+static uint8_t dtcm_pool[MEM_DTCM_BYTES] __attribute__((section(".dtcm"), aligned(MEM_ALIGN)));
+#endif
+static uint8_t sram_pool[MEM_SRAM_BYTES] __attribute__((aligned(MEM_ALIGN)));
+
+static uint32_t pool_used[MEM_NUM_REGIONS];
+static mem_arena_stats_t stats;
+
+static uint8_t* pool_base(mem_region_t region)
+{
+#if MEM_DTCM_BYTES > 0
+    if (region == MEM_REGION_DTCM) {
+        return dtcm_pool;
+    }
+#endif
+    return (region == MEM_REGION_SRAM) ? sram_pool : NULL;
+}
+
+static uint32_t pool_size(mem_region_t region)
+{
+    return (region == MEM_REGION_DTCM) ? MEM_DTCM_BYTES : MEM_SRAM_BYTES;
+}
+
+void mem_arena_init(void)
+{
+#if MEM_DTCM_BYTES > 0
+    SCB_DTCMCR |= SCB_DTCMCR_EN;
+    __asm volatile ("dsb\n\tisb" ::: "memory");
+#endif
+    memset(pool_used, 0, sizeof(pool_used));
+    memset(&stats, 0, sizeof(stats));
+    for (int r = 0; r < MEM_NUM_REGIONS; r++) {
+        stats.free[r] = pool_size((mem_region_t)r);
+    }
+}
+
+static void* pool_alloc(mem_region_t region, uint32_t bytes, mem_owner_t owner)
+{
+    uint32_t size = (bytes + MEM_ALIGN - 1) & ~(uint32_t)(MEM_ALIGN - 1);
+    if (pool_base(region) == NULL || size > pool_size(region) - pool_used[region]) {
+        return NULL;
+    }
+
+    uint8_t *ptr = pool_base(region) + pool_used[region];
+    pool_used[region] += size;
+    stats.used[region][owner] += size;
+    stats.free[region] -= size;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+void* mem_arena_alloc(uint32_t bytes, mem_owner_t owner, mem_prio_t prio)
+{
+    mem_region_t first = (prio == MEM_PRIO_HOT) ? MEM_REGION_DTCM : MEM_REGION_SRAM;
+    mem_region_t second = (prio == MEM_PRIO_HOT) ? MEM_REGION_SRAM : MEM_REGION_DTCM;
+
+    if (owner >= MEM_NUM_OWNERS || bytes == 0) {
+        return NULL;
+    }
+
+    void *ptr = pool_alloc(first, bytes, owner);
+    if (ptr == NULL) {
+        ptr = pool_alloc(second, bytes, owner);
+    }
+    if (ptr == NULL) {
+        stats.failed++;
+    }
+    return ptr;
+}
+
+mem_region_t mem_arena_region(const void *ptr)
+{
+#if MEM_DTCM_BYTES > 0
+    if ((const uint8_t *)ptr >= dtcm_pool && (const uint8_t *)ptr < dtcm_pool + MEM_DTCM_BYTES) {
+        return MEM_REGION_DTCM;
+    }
+#endif
+    (void)ptr;
+    return MEM_REGION_SRAM;
+}
+
+const mem_arena_stats_t* mem_arena_stats(void)
+{
+    return &stats;
+}
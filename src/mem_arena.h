@@ -0,0 +1,80 @@
+/*
+ * Static Memory Arena
+ *
+ * Frame, scratch and model buffers whose size depends on the frame
+ * profile are allocated once at init from two fixed pools instead of
+ * being sized for the worst case in each module:
+ *   DTCM: zero wait state, no cache maintenance; MEM_PRIO_HOT buffers
+ *         (touched per sample) go here while it has room
+ *   SRAM: everything else, and HOT buffers that did not fit
+ * Nothing is ever freed. Per-owner use is kept for the budget report
+ * (tools/ram_report.py covers the static sections from the map file;
+ * the pools show up there as owner "arena").
+ *
+ * The DTCM pool exists only when the firmware is built with TCM_KB
+ * (make TCM_KB=32|64|128, matching the GPNVM TCM configuration, which
+ * takes twice that amount from SRAM for ITCM + DTCM).
+ */
+
+#ifndef MEM_ARENA_H
+#define MEM_ARENA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Pool sizes (bytes); MEM_DTCM_KB comes from the Makefile (TCM_KB) */
+#ifndef MEM_DTCM_KB
+#define MEM_DTCM_KB             0
+#endif
+#define MEM_DTCM_BYTES          (MEM_DTCM_KB * 1024)
+#define MEM_SRAM_BYTES          (16 * 1024)     /* Replaces the unused 16 KB heap */
+#define MEM_ALIGN               8       /* FPU double-word loads, DMA */
+
+typedef enum {
+    MEM_PRIO_HOT = 0,       /* Touched per sample every frame */
+    MEM_PRIO_WARM           /* Per frame, or rarely */
+} mem_prio_t;
+
+typedef enum {
+    MEM_OWNER_RADAR = 0,
+    MEM_OWNER_PRESENCE,
+    MEM_OWNER_GESTURE,
+    MEM_OWNER_VITALS,
+    MEM_NUM_OWNERS
+} mem_owner_t;
+
+typedef enum {
+    MEM_REGION_DTCM = 0,
+    MEM_REGION_SRAM,
+    MEM_NUM_REGIONS
+} mem_region_t;
+
+typedef struct {
+    uint32_t used[MEM_NUM_REGIONS][MEM_NUM_OWNERS];
+    uint32_t free[MEM_NUM_REGIONS];
+    uint32_t failed;                    /* Requests that fitted nowhere */
+} mem_arena_stats_t;
+
+/*
+ * Enable the DTCM (if configured) and empty both pools
+ */
+void mem_arena_init(void);
+
+/*
+ * Allocate `bytes` (zeroed, MEM_ALIGN aligned) for `owner`. HOT goes
+ * to DTCM first, WARM to SRAM first; either falls back to the other.
+ * Returns NULL if neither pool has room.
+ */
+void* mem_arena_alloc(uint32_t bytes, mem_owner_t owner, mem_prio_t prio);
+
+/*
+ * Region a pointer from mem_arena_alloc() lives in
+ */
+mem_region_t mem_arena_region(const void *ptr);
+
+/*
+ * Per-owner use and remaining space
+ */
+const mem_arena_stats_t* mem_arena_stats(void);
+
+#endif /* MEM_ARENA_H */
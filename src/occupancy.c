@@ -0,0 +1,325 @@
+/*
+ * Occupancy Counting Implementation
+ *
+ * Points: one per configured range bin whose fast-slow difference
+ * exceeds the bin's presence threshold. Velocity is the pulse-pair
+ * estimate over the frame's chirps, as in gesture.c: the bin is
+ * evaluated per chirp with Goertzel, the static component (mean over
+ * chirps) is removed and v = lambda * arg(R1) / (4 pi Tc) from the
+ * lag-1 autocorrelation R1. The chirps go through the presence window
+ * first, so a bin sees the targets of the spectrum that detected it;
+ * unwindowed, leakage drags a bin toward a neighbouring target's
+ * velocity and joins the two. The sums are accumulated chirp by chirp,
+ * so no per-chirp storage is needed. The driver reads a single RX
+ * antenna, so there is no angle estimate yet and every point gets
+ * angle 0 (the grid keeps the dimension for when more channels are
+ * read).
+ */
+
+#include "occupancy.h"
+#include "avian_registers.h"
+#include <string.h>
+#include <math.h>
+
+#define OCC_PI              3.14159265f
+#define OCC_RANGE_BIN_M     (299792458.0f / (2.0f * (float)AVIAN_BANDWIDTH_HZ))   /* ~2.7 cm */
+#define OCC_SLOT_EMPTY      0xFF
+
+/* Grid cell: key, union-find parent, aggregated points */
+typedef struct {
+    uint32_t key;
+    uint8_t parent;
+    uint8_t num_points;
+    float strength;
+    float range_sum;            /* Strength-weighted */
+    float velocity_sum;
+} occ_cell_t;
+
+static occ_cell_t cells[OCC_MAX_POINTS];
+static uint8_t slots[OCC_GRID_SLOTS];   /* Cell index per hash slot */
+static int8_t cell_coord[OCC_MAX_POINTS][3];
+
+static int8_t quantize(float value, float eps)
+{
+    float q = floorf(value / eps);
+    if (q > 127.0f) q = 127.0f;
+    if (q < -128.0f) q = -128.0f;
+    return (int8_t)q;
+}
+
+static uint32_t cell_key(int r, int a, int v)
+{
+    return ((uint32_t)(uint8_t)r << 16) | ((uint32_t)(uint8_t)a << 8) | (uint8_t)v;
+}
+
+static uint32_t slot_of(uint32_t key)
+{
+    return (key * 2654435761u) >> 26;   /* Top 6 bits = OCC_GRID_SLOTS */
+}
+
+/* Index of the cell with this key, or OCC_SLOT_EMPTY */
+static uint8_t cell_find(uint32_t key)
+{
+    uint32_t s = slot_of(key);
+    while (slots[s] != OCC_SLOT_EMPTY) {
+        if (cells[slots[s]].key == key) {
+            return slots[s];
+        }
+        s = (s + 1) & (OCC_GRID_SLOTS - 1);
+    }
+    return OCC_SLOT_EMPTY;
+}
+
+static uint8_t cell_insert(uint32_t key, uint8_t *num_cells)
+{
+    uint32_t s = slot_of(key);
+    while (slots[s] != OCC_SLOT_EMPTY) {
+        if (cells[slots[s]].key == key) {
+            return slots[s];
+        }
+        s = (s + 1) & (OCC_GRID_SLOTS - 1);
+    }
+
+    uint8_t c = (*num_cells)++;
+    memset(&cells[c], 0, sizeof(occ_cell_t));
+    cells[c].key = key;
+    cells[c].parent = c;
+    slots[s] = c;
+    return c;
+}
+
+static uint8_t cell_root(uint8_t c)
+{
+    while (cells[c].parent != c) {
+        cells[c].parent = cells[cells[c].parent].parent;   /* Path halving */
+        c = cells[c].parent;
+    }
+    return c;
+}
+
+static void cell_union(uint8_t a, uint8_t b)
+{
+    a = cell_root(a);
+    b = cell_root(b);
+    if (a != b) {
+        cells[b].parent = a;
+    }
+}
+
+/*
+ * Pulse-pair velocity of configured bin b over the frame's chirps. With
+ * S the sum over the N chirps and m = S / N, the mean-removed lag sums
+ * follow from running sums:
+ *   R0 = sum |x|^2 - N |m|^2
+ *   R1 = sum x[c] conj(x[c-1]) - conj(m) (S - x[0]) - m conj(S - x[N-1])
+ *        + (N - 1) |m|^2
+ */
+static float bin_velocity(const occupancy_t *occ, const presence_ctx_t *presence,
+                          const radar_frame_t *frame, int b)
+{
+    int num_chirps = frame->num_chirps ? frame->num_chirps : RADAR_NUM_CHIRPS;
+    const float *window = presence_window();
+    float coeff = presence->goertzel_coeff[b];
+    float sin_w = presence->goertzel_sin[b];
+    float sum_re = 0.0f, sum_im = 0.0f, energy = 0.0f;
+    float lag_re = 0.0f, lag_im = 0.0f;
+    float first_re = 0.0f, first_im = 0.0f;
+    float prev_re = 0.0f, prev_im = 0.0f;
+
+    for (int c = 0; c < num_chirps; c++) {
+        const int16_t *chirp = &frame->samples[c * RADAR_NUM_SAMPLES];
+        float s1 = 0.0f;
+        float s2 = 0.0f;
+        for (int n = 0; n < RADAR_NUM_SAMPLES; n++) {
+            float s0 = (float)chirp[n] * window[n] + coeff * s1 - s2;
+            s2 = s1;
+            s1 = s0;
+        }
+        float re = s1 * 0.5f * coeff - s2;
+        float im = s1 * sin_w;
+
+        if (c == 0) {
+            first_re = re;
+            first_im = im;
+        } else {
+            /* x[c] * conj(x[c-1]) */
+            lag_re += re * prev_re + im * prev_im;
+            lag_im += im * prev_re - re * prev_im;
+        }
+        sum_re += re;
+        sum_im += im;
+        energy += re * re + im * im;
+        prev_re = re;
+        prev_im = im;
+    }
+
+    float n = (float)num_chirps;
+    float m_re = sum_re / n;
+    float m_im = sum_im / n;
+    float m_pow = m_re * m_re + m_im * m_im;
+    float r0 = energy - n * m_pow;
+
+    /* conj(m) * (S - x[0]) and m * conj(S - x[N-1]) */
+    float a_re = sum_re - first_re, a_im = sum_im - first_im;
+    float l_re = sum_re - prev_re, l_im = sum_im - prev_im;
+    float r1_re = lag_re - (m_re * a_re + m_im * a_im) - (m_re * l_re + m_im * l_im) +
+                  (n - 1.0f) * m_pow;
+    float r1_im = lag_im - (m_re * a_im - m_im * a_re) - (m_im * l_re - m_re * l_im);
+
+    if (r0 <= 0.0f) {
+        return 0.0f;
+    }
+    return atan2f(r1_im, r1_re) * occ->velocity_scale;
+}
+
+/* Collect detections from the configured bins */
+static void extract_points(occupancy_t *occ, const presence_ctx_t *presence,
+                           const radar_frame_t *frame)
+{
+    bool chirps = frame && frame->valid && frame->samples;
+
+    occ->num_points = 0;
+    for (int b = 0; b < presence->num_bins && occ->num_points < OCC_MAX_POINTS; b++) {
+        int i = presence->bins[b];
+        float diff = presence->fast_avg[i] - presence->slow_avg[i];
+        if (diff <= presence->bin_threshold[i]) {
+            continue;
+        }
+
+        occ_point_t *p = &occ->points[occ->num_points++];
+        p->range_m = (float)i * OCC_RANGE_BIN_M;
+        p->angle_deg = 0.0f;
+        p->velocity_mps = chirps ? bin_velocity(occ, presence, frame, b) : 0.0f;
+        p->strength = diff;
+    }
+}
+
+/* Grid clustering; returns the number of accepted clusters */
+static uint8_t cluster_points(occupancy_t *occ, float threshold)
+{
+    uint8_t num_cells = 0;
+
+    memset(slots, OCC_SLOT_EMPTY, sizeof(slots));
+
+    /* Bin points into cells */
+    for (int p = 0; p < occ->num_points; p++) {
+        const occ_point_t *pt = &occ->points[p];
+        int8_t r = quantize(pt->range_m, OCC_EPS_RANGE_M);
+        int8_t a = quantize(pt->angle_deg, OCC_EPS_ANGLE_DEG);
+        int8_t v = quantize(pt->velocity_mps, OCC_EPS_VELOCITY_MPS);
+        uint8_t c = cell_insert(cell_key(r, a, v), &num_cells);
+
+        cell_coord[c][0] = r;
+        cell_coord[c][1] = a;
+        cell_coord[c][2] = v;
+        cells[c].num_points++;
+        cells[c].strength += pt->strength;
+        cells[c].range_sum += pt->strength * pt->range_m;
+        cells[c].velocity_sum += pt->strength * pt->velocity_mps;
+    }
+
+    /* Join touching cells: each pair is visited from both sides, so a
+     * lookup per neighbour is all that is needed (26 per cell) */
+    for (int c = 0; c < num_cells; c++) {
+        for (int dr = -1; dr <= 1; dr++) {
+            for (int da = -1; da <= 1; da++) {
+                for (int dv = -1; dv <= 1; dv++) {
+                    if (dr == 0 && da == 0 && dv == 0) {
+                        continue;
+                    }
+                    uint8_t n = cell_find(cell_key(cell_coord[c][0] + dr,
+                                                   cell_coord[c][1] + da,
+                                                   cell_coord[c][2] + dv));
+                    if (n != OCC_SLOT_EMPTY) {
+                        cell_union((uint8_t)c, n);
+                    }
+                }
+            }
+        }
+    }
+
+    /* Fold cells into their roots */
+    for (int c = 0; c < num_cells; c++) {
+        uint8_t root = cell_root((uint8_t)c);
+        if (root != c) {
+            cells[root].num_points += cells[c].num_points;
+            cells[root].strength += cells[c].strength;
+            cells[root].range_sum += cells[c].range_sum;
+            cells[root].velocity_sum += cells[c].velocity_sum;
+            cells[c].num_points = 0;
+        }
+    }
+
+    /* Accept clusters with enough points or one strong point */
+    occ->num_clusters = 0;
+    uint8_t accepted = 0;
+    for (int c = 0; c < num_cells; c++) {
+        const occ_cell_t *cell = &cells[c];
+        if (cell->parent != c || cell->num_points == 0) {
+            continue;
+        }
+        if (cell->num_points < OCC_MIN_POINTS &&
+            cell->strength < OCC_STRONG_FACTOR * threshold) {
+            continue;
+        }
+
+        accepted++;
+        if (occ->num_clusters < OCC_MAX_CLUSTERS) {
+            occ_cluster_t *out = &occ->clusters[occ->num_clusters++];
+            out->range_m = cell->range_sum / cell->strength;
+            out->velocity_mps = cell->velocity_sum / cell->strength;
+            out->strength = cell->strength;
+            out->num_points = cell->num_points;
+        }
+    }
+
+    return accepted > OCC_MAX_CLUSTERS ? OCC_MAX_CLUSTERS : accepted;
+}
+
+/* Mode of the history; ties keep the current count */
+static uint8_t smoothed_count(const occupancy_t *occ)
+{
+    uint8_t hist[OCC_MAX_CLUSTERS + 1] = {0};
+    for (uint32_t k = 0; k < occ->count; k++) {
+        hist[occ->history[k]]++;
+    }
+
+    uint8_t best = occ->occupancy;
+    for (int n = 0; n <= OCC_MAX_CLUSTERS; n++) {
+        if (hist[n] > hist[best]) {
+            best = (uint8_t)n;
+        }
+    }
+    return best;
+}
+
+void occupancy_init(occupancy_t *occ, uint32_t chirp_period_us)
+{
+    memset(occ, 0, sizeof(occupancy_t));
+    occ->velocity_scale = OCC_WAVELENGTH_M /
+                          (4.0f * OCC_PI * ((float)chirp_period_us * 1e-6f));
+}
+
+uint8_t occupancy_update(occupancy_t *occ, const presence_ctx_t *presence,
+                         const radar_frame_t *frame)
+{
+    if (presence->full_evaluated) {
+        extract_points(occ, presence, frame);
+        occ->raw_count = cluster_points(occ, presence->threshold);
+    } else {
+        if (!presence->presence_detected) {
+            occ->raw_count = 0;
+            occ->num_points = 0;
+            occ->num_clusters = 0;
+        }
+    }
+
+    occ->history[occ->head] = occ->raw_count;
+    occ->head = (occ->head + 1) % OCC_HISTORY;
+    if (occ->count < OCC_HISTORY) {
+        occ->count++;
+    }
+
+    occ->occupancy = smoothed_count(occ);
+    return occ->occupancy;
+}
@@ -0,0 +1,97 @@
+/*
+ * Occupancy Counting
+ *
+ * Turns the per-bin detections of presence_detect() into points
+ * (range, angle, radial velocity), clusters them on a coarse grid and
+ * reports the number of clusters as the number of people.
+ *
+ * Clustering is a grid approximation of DBSCAN over range, angle and
+ * radial velocity: points are hashed into cells of one eps per
+ * dimension and occupied cells that touch (26-neighbourhood) are
+ * joined with union-find, so two people at the same range moving in
+ * opposite directions stay apart. Velocity is the pulse-pair Doppler
+ * over the chirps of the frame, unambiguous within +-lambda / (4 Tc)
+ * (~2.1 m/s at 591 us chirps). Every step is linear in the number of
+ * points, and all storage is static (OCC_MAX_POINTS points,
+ * OCC_GRID_SLOTS hash slots).
+ *
+ * The raw count is smoothed with the mode over the last OCC_HISTORY
+ * evaluated frames so a person briefly splitting into two clusters
+ * (or fading for one frame) does not change the reported count.
+ */
+
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "presence_detection.h"
+
+#define OCC_MAX_POINTS          PRESENCE_MAX_SPARSE_BINS    /* One per range bin */
+#define OCC_GRID_SLOTS          64      /* Hash slots, power of 2, >= 2 * points */
+#define OCC_MAX_CLUSTERS        8
+#define OCC_HISTORY             8       /* Frames in the smoothing window */
+
+/* Geometry: lambda at 60 GHz; the range bin comes from the exported
+ * ramp (occupancy.c) */
+#define OCC_WAVELENGTH_M        0.005f
+
+/* Cell size per dimension (DBSCAN eps) */
+#define OCC_EPS_RANGE_M         0.15f
+#define OCC_EPS_ANGLE_DEG       15.0f
+#define OCC_EPS_VELOCITY_MPS    0.02f   /* Breathing (~1 cm/s peak) stays in touching cells */
+
+/* Cluster acceptance; points are bins whose fast - slow difference
+ * exceeds their presence threshold (ctx->bin_threshold) */
+#define OCC_MIN_POINTS          2       /* DBSCAN min_pts */
+#define OCC_STRONG_FACTOR       4.0f    /* x threshold: accept single-point cluster */
+
+typedef struct {
+    float range_m;
+    float angle_deg;
+    float velocity_mps;
+    float strength;             /* fast_avg - slow_avg */
+} occ_point_t;
+
+typedef struct {
+    float range_m;              /* Strength-weighted centroid */
+    float velocity_mps;
+    float strength;             /* Sum over points */
+    uint8_t num_points;
+} occ_cluster_t;
+
+typedef struct {
+    /* Detections of the last evaluated frame */
+    occ_point_t points[OCC_MAX_POINTS];
+    uint8_t num_points;
+
+    /* Clusters of the last evaluated frame */
+    occ_cluster_t clusters[OCC_MAX_CLUSTERS];
+    uint8_t num_clusters;
+
+    float velocity_scale;       /* lambda / (4 pi Tc) */
+
+    /* Smoothing */
+    uint8_t history[OCC_HISTORY];
+    uint32_t head;
+    uint32_t count;             /* Valid history entries (saturates) */
+    uint8_t raw_count;          /* Clusters in the last evaluated frame */
+    uint8_t occupancy;          /* Reported (smoothed) count */
+} occupancy_t;
+
+/*
+ * Initialize for the given chirp repetition time (velocity scale)
+ */
+void occupancy_init(occupancy_t *occ, uint32_t chirp_period_us);
+
+/*
+ * Update with one frame; call after presence_update() on every frame
+ * with the frame it evaluated (chirps for the velocity estimate).
+ * Frames that skipped the FFT pipeline count as empty when presence is
+ * not detected and repeat the last raw count otherwise.
+ * Returns the smoothed occupancy.
+ */
+uint8_t occupancy_update(occupancy_t *occ, const presence_ctx_t *presence,
+                         const radar_frame_t *frame);
+
+#endif /* OCCUPANCY_H */
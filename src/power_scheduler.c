@@ -0,0 +1,162 @@
+/*
+ * Frame Scheduler with Power Profiles
+ *
+ * LOW_POWER sequence per frame:
+ *   1. Sleep until next_start (RTT alarm)
+ *   2. radar_trigger_frame(): one SPI write, sensor wakes and records
+ *   3. Sleep for the acquisition time
+ *   4. Poll FIFO until complete and read it
+ *   5. Sensor returns to deep sleep on its own (CCR1 PD_MODE)
+ */
+
+#include "power_scheduler.h"
+#include "rtt.h"
+#include "cycles.h"
+#include <string.h>
+
+static power_profile_t current_profile = POWER_PROFILE_PERFORMANCE;
+static power_profile_t requested_profile = POWER_PROFILE_PERFORMANCE;
+static uint32_t period_ticks;
+static uint32_t acquisition_ticks;
+static uint32_t next_start;
+static uint32_t last_start;
+static uint32_t last_cycles;
+static bool have_last_start = false;
+static power_stats_t stats;
+
+void power_scheduler_init(uint32_t frame_period_ms, uint32_t acquisition_ms)
+{
+    rtt_init();
+    cycles_init();
+
+    period_ticks = RTT_MS_TO_TICKS(frame_period_ms);
+    acquisition_ticks = RTT_MS_TO_TICKS(acquisition_ms);
+    next_start = rtt_now();
+    last_cycles = cycles_now();
+    power_scheduler_reset_stats();
+}
+
+void power_scheduler_set_profile(power_profile_t profile)
+{
+    requested_profile = profile;
+}
+
+power_profile_t power_scheduler_get_profile(void)
+{
+    return requested_profile;
+}
+
+void power_scheduler_set_period(uint32_t frame_period_ms, uint32_t acquisition_ms)
+{
+    period_ticks = RTT_MS_TO_TICKS(frame_period_ms);
+    acquisition_ticks = RTT_MS_TO_TICKS(acquisition_ms);
+}
+
+const power_stats_t* power_scheduler_stats(void)
+{
+    return &stats;
+}
+
+void power_scheduler_reset_stats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+    stats.period_min_ticks = UINT32_MAX;
+    have_last_start = false;
+}
+
+/* Reconfigure the sensor when the profile changed */
+static void apply_profile(void)
+{
+    if (requested_profile == current_profile) {
+        return;
+    }
+
+    current_profile = requested_profile;
+    radar_set_frame_power(current_profile == POWER_PROFILE_LOW_POWER ?
+                          RADAR_FRAME_POWER_DEEP_SLEEP : RADAR_FRAME_POWER_ACTIVE);
+    radar_reset_fifo();
+    next_start = rtt_now();
+    have_last_start = false;
+
+    /* Sensor-timed frames: no re-arm, cadence independent of processing */
+    if (current_profile == POWER_PROFILE_PERFORMANCE) {
+        radar_start();
+    }
+}
+
+/* Record start-to-start interval of a new frame */
+static void record_frame_start(uint32_t start)
+{
+    if (have_last_start) {
+        uint32_t period = start - last_start;
+        if (period < stats.period_min_ticks) stats.period_min_ticks = period;
+        if (period > stats.period_max_ticks) stats.period_max_ticks = period;
+        stats.period_sum_ticks += period;
+        stats.periods++;
+    }
+    last_start = start;
+    have_last_start = true;
+}
+
+/* Record CPU cycles spent awake since the previous frame was delivered */
+static void record_active_cycles(void)
+{
+    /* CYCCNT halts while the core sleeps on WFI */
+    uint32_t now = cycles_now();
+    stats.active_cycles_last = now - last_cycles;
+    if (stats.active_cycles_last > stats.active_cycles_max) {
+        stats.active_cycles_max = stats.active_cycles_last;
+    }
+    last_cycles = now;
+}
+
+static const radar_frame_t* next_frame_low_power(void)
+{
+    /* Skip missed slots instead of bursting to catch up */
+    uint32_t now = rtt_now();
+    while ((int32_t)(now - next_start) > (int32_t)period_ticks) {
+        next_start += period_ticks;
+    }
+
+    rtt_sleep_until(next_start);
+
+    uint32_t start = rtt_now();
+    radar_trigger_frame();
+    record_frame_start(start);
+    next_start += period_ticks;
+
+    rtt_sleep_until(start + acquisition_ticks);
+
+    while (!radar_frame_ready()) {
+        /* Remaining fraction of a tick; FIFO polls are short */
+    }
+
+    return radar_get_frame();
+}
+
+static const radar_frame_t* next_frame_performance(void)
+{
+    /* No-op while the continuous sequence runs */
+    radar_start_frame();
+
+    while (!radar_frame_ready()) {
+    }
+
+    record_frame_start(rtt_now());
+    return radar_get_frame();
+}
+
+const radar_frame_t* power_scheduler_next_frame(void)
+{
+    apply_profile();
+
+    const radar_frame_t *frame = (current_profile == POWER_PROFILE_LOW_POWER) ?
+                                 next_frame_low_power() : next_frame_performance();
+
+    if (frame) {
+        stats.frames++;
+    }
+    record_active_cycles();
+
+    return frame;
+}
@@ -0,0 +1,66 @@
+/*
+ * Frame Scheduler with Power Profiles
+ *
+ * PERFORMANCE: sensor free-running in continuous mode (radar_start), MCU
+ *              polls the FIFO and drains one frame at a time
+ * LOW_POWER:   sensor deep-sleeps after every frame, MCU sleeps on WFI
+ *              and the RTT alarm wakes it to trigger the next frame
+ *
+ * Frame timing and active CPU time are measured in both profiles.
+ */
+
+#ifndef POWER_SCHEDULER_H
+#define POWER_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "avian_radar.h"
+
+typedef enum {
+    POWER_PROFILE_PERFORMANCE = 0,
+    POWER_PROFILE_LOW_POWER
+} power_profile_t;
+
+/* Achieved timing (RTT ticks are 1/1024 s, cycles are 300 MHz CPU clocks) */
+typedef struct {
+    uint32_t frames;                /* Frames delivered since reset of stats */
+    uint32_t periods;               /* Intervals measured */
+    uint32_t period_min_ticks;      /* Trigger-to-trigger interval (LOW_POWER), */
+    uint32_t period_max_ticks;      /* ready-to-ready interval (PERFORMANCE) */
+    uint32_t period_sum_ticks;      /* period_sum / periods = average */
+    uint32_t active_cycles_last;    /* CPU cycles awake during last frame period */
+    uint32_t active_cycles_max;
+} power_stats_t;
+
+/*
+ * Initialize scheduler (starts RTT and cycle counter)
+ * frame_period_ms: target start-to-start interval
+ * acquisition_ms:  time the sensor needs to record one frame
+ */
+void power_scheduler_init(uint32_t frame_period_ms, uint32_t acquisition_ms);
+
+/*
+ * Select profile at runtime (takes effect on the next frame)
+ */
+void power_scheduler_set_profile(power_profile_t profile);
+power_profile_t power_scheduler_get_profile(void);
+
+/*
+ * Change target frame period and acquisition time (e.g. from a rate
+ * controller switching chirp profiles)
+ */
+void power_scheduler_set_period(uint32_t frame_period_ms, uint32_t acquisition_ms);
+
+/*
+ * Wait (sleeping where the profile allows) for the next frame
+ * Returns the frame, or NULL if the read failed
+ */
+const radar_frame_t* power_scheduler_next_frame(void);
+
+/*
+ * Timing statistics
+ */
+const power_stats_t* power_scheduler_stats(void);
+void power_scheduler_reset_stats(void);
+
+#endif /* POWER_SCHEDULER_H */
@@ -4,6 +4,7 @@
  */
 
 #include "presence_detection.h"
+#include "avian_registers.h"
 #include "arm_math.h"
 #include <string.h>
 #include <math.h>
@@ -32,6 +33,9 @@ static const float blackman_harris_64[64] = {
 static arm_rfft_fast_instance_f32 fft_instance;
 static bool fft_initialized = false;
 
+/* Window with 1/32768 normalization folded in */
+static float window_scaled[RADAR_NUM_SAMPLES];
+
 void presence_init(presence_ctx_t *ctx)
 {
     memset(ctx, 0, sizeof(presence_ctx_t));
@@ -41,8 +45,382 @@ void presence_init(presence_ctx_t *ctx)
     /* Initialize FFT for 64 samples */
     if (!fft_initialized) {
         arm_rfft_fast_init_f32(&fft_instance, RADAR_NUM_SAMPLES);
+
+        for (int i = 0; i < RADAR_NUM_SAMPLES; i++) {
+            window_scaled[i] = blackman_harris_64[i] / 32768.0f;
+        }
         fft_initialized = true;
     }
+
+    /* Default bin set is the detection range; AUTO picks the full FFT */
+    uint8_t bins[DETECT_END_SAMPLE - DETECT_START_SAMPLE];
+    for (int i = 0; i < DETECT_END_SAMPLE - DETECT_START_SAMPLE; i++) {
+        bins[i] = (uint8_t)(DETECT_START_SAMPLE + i);
+    }
+    presence_set_bins(ctx, bins, DETECT_END_SAMPLE - DETECT_START_SAMPLE);
+    presence_set_spectrum_mode(ctx, PRESENCE_SPECTRUM_AUTO);
+
+    ctx->mode = PRESENCE_MODE_FULL;
+    ctx->gate_awake = true;
+    presence_set_domain(ctx, PRESENCE_DOMAIN_LINEAR);
+
+    presence_set_frame_period(ctx, ALPHA_REF_FRAME_MS);
+}
+
+void presence_set_domain(presence_ctx_t *ctx, presence_domain_t domain)
+{
+    ctx->domain = domain;
+    ctx->cal_mode = PRESENCE_CAL_OFF;
+
+    switch (domain) {
+    case PRESENCE_DOMAIN_POWER:
+        ctx->threshold = THRESHOLD_PRESENCE_POWER;
+        break;
+    case PRESENCE_DOMAIN_LOG2:
+        ctx->threshold = THRESHOLD_PRESENCE_LOG2;
+        break;
+    case PRESENCE_DOMAIN_LINEAR:
+    default:
+        ctx->threshold = THRESHOLD_PRESENCE;
+        break;
+    }
+
+    presence_set_threshold(ctx, ctx->threshold);
+
+    /* Averages hold values of the old domain; gain_scale is per domain */
+    ctx->first_run = true;
+    ctx->gain_hpf_ref_khz = UINT8_MAX;
+}
+
+/*
+ * Upper-tail standard normal quantile: P(X > k) = p, 0 < p < 0.5
+ * (Abramowitz & Stegun 26.2.23, |error| < 4.5e-4)
+ */
+static float normal_quantile(float p)
+{
+    float t = sqrtf(-2.0f * logf(p));
+    return t - (2.515517f + 0.802853f * t + 0.010328f * t * t) /
+               (1.0f + 1.432788f * t + 0.189269f * t * t + 0.001308f * t * t * t);
+}
+
+/* k for a per-frame false-alarm rate spread over the configured bins */
+static float cal_k_for_pfa(const presence_ctx_t *ctx, float pfa)
+{
+    float p = pfa / (float)(ctx->num_bins ? ctx->num_bins : 1);
+    if (p > 0.4f) p = 0.4f;
+    if (p < 1e-12f) p = 1e-12f;
+    return normal_quantile(p);
+}
+
+/* Threshold from mean/variance, floored at CAL_MIN_FRACTION of the default */
+static void cal_set_threshold(presence_ctx_t *ctx, int i, float mean, float var)
+{
+    float th = mean + ctx->cal_k * sqrtf(var > 0.0f ? var : 0.0f);
+    float floor = CAL_MIN_FRACTION * ctx->threshold;
+    ctx->bin_threshold[i] = th > floor ? th : floor;
+}
+
+void presence_calibrate(presence_ctx_t *ctx, uint32_t frames, float pfa, bool online)
+{
+    ctx->cal_k = cal_k_for_pfa(ctx, pfa);
+    ctx->cal_frames = frames ? frames : CAL_DEFAULT_FRAMES;
+    ctx->cal_count = 0;
+    ctx->cal_online = online;
+    memset(ctx->cal_mean, 0, sizeof(ctx->cal_mean));
+    memset(ctx->cal_m2, 0, sizeof(ctx->cal_m2));
+    ctx->cal_mode = PRESENCE_CAL_BATCH;
+}
+
+void presence_set_online_calibration(presence_ctx_t *ctx, bool enable, float pfa)
+{
+    if (!enable) {
+        ctx->cal_mode = PRESENCE_CAL_OFF;
+        return;
+    }
+
+    /* Seed so that the current thresholds are reproduced: mean 0,
+     * sigma = threshold / k */
+    ctx->cal_k = cal_k_for_pfa(ctx, pfa);
+    for (int b = 0; b < ctx->num_bins; b++) {
+        int i = ctx->bins[b];
+        float sigma = ctx->bin_threshold[i] / ctx->cal_k;
+        ctx->cal_mean[i] = 0.0f;
+        ctx->cal_m2[i] = sigma * sigma;
+    }
+    ctx->cal_update_pos = 0;
+    ctx->cal_mode = PRESENCE_CAL_ONLINE;
+}
+
+/* End of a batch window: thresholds from the collected statistics */
+static void cal_finish_batch(presence_ctx_t *ctx)
+{
+    float inv_n1 = 1.0f / (float)(ctx->cal_count > 1 ? ctx->cal_count - 1 : 1);
+
+    for (int b = 0; b < ctx->num_bins; b++) {
+        int i = ctx->bins[b];
+        ctx->cal_m2[i] *= inv_n1;    /* Now the variance (online representation) */
+        cal_set_threshold(ctx, i, ctx->cal_mean[i], ctx->cal_m2[i]);
+    }
+
+    ctx->cal_update_pos = 0;
+    ctx->cal_mode = ctx->cal_online ? PRESENCE_CAL_ONLINE : PRESENCE_CAL_OFF;
+}
+
+void presence_set_threshold(presence_ctx_t *ctx, float threshold)
+{
+    ctx->threshold = threshold;
+    for (int i = 0; i < RADAR_NUM_SAMPLES / 2; i++) {
+        ctx->bin_threshold[i] = threshold;
+    }
+}
+
+float presence_bin_magnitude(const presence_ctx_t *ctx, int bin)
+{
+    float v = ctx->range_profile[bin];
+    return (ctx->domain == PRESENCE_DOMAIN_LINEAR) ? v : sqrtf(v);
+}
+
+const float *presence_window(void)
+{
+    return window_scaled;
+}
+
+/*
+ * Fast log2 for positive floats: exponent from the float bits plus a
+ * quadratic fit of log2 over the mantissa [1, 2) (max error ~0.005)
+ */
+static inline float fast_log2(float x)
+{
+    union {
+        float f;
+        uint32_t u;
+    } v = { x };
+
+    float e = (float)((int32_t)(v.u >> 23) - 128);  /* Fit below includes the +1 */
+    v.u = (v.u & 0x007FFFFF) | 0x3F800000;   /* Mantissa as float in [1, 2) */
+    float m = v.f;
+
+    return e + (-0.34484843f * m + 2.02466578f) * m - 0.67487759f;
+}
+
+/* Alpha giving the same time constant at a different update interval */
+static float rescale_alpha(float alpha, float ratio)
+{
+    return 1.0f - powf(1.0f - alpha, ratio);
+}
+
+/* Frame count giving the same wall time at a different frame period */
+static uint32_t frames_for_period(uint32_t frames, float ratio)
+{
+    uint32_t n = (uint32_t)((float)frames / ratio + 0.5f);
+    return n ? n : 1;
+}
+
+void presence_set_frame_period(presence_ctx_t *ctx, uint32_t frame_period_ms)
+{
+    float ratio = (float)frame_period_ms / (float)ALPHA_REF_FRAME_MS;
+
+    ctx->alpha_slow = rescale_alpha(ALPHA_SLOW, ratio);
+    ctx->alpha_med = rescale_alpha(ALPHA_MED, ratio);
+    ctx->alpha_fast = rescale_alpha(ALPHA_FAST, ratio);
+    ctx->gate_alpha = rescale_alpha(GATE_ALPHA, ratio);
+    ctx->gate_hold_frames = frames_for_period(GATE_HOLD_FRAMES, ratio);
+    ctx->gate_force_period = frames_for_period(GATE_FORCE_PERIOD, ratio);
+}
+
+void presence_set_mode(presence_ctx_t *ctx, presence_mode_t mode)
+{
+    ctx->mode = mode;
+    ctx->gate_awake = true;       /* Start awake to seed the gate background */
+    ctx->gate_background = 0.0f;
+    ctx->gate_quiet_frames = 0;
+    ctx->frames_since_full = 0;
+}
+
+bool presence_set_bins(presence_ctx_t *ctx, const uint8_t *bins, uint8_t num_bins)
+{
+    if (num_bins == 0 || num_bins > PRESENCE_MAX_SPARSE_BINS) {
+        return false;
+    }
+
+    for (int i = 0; i < num_bins; i++) {
+        if (bins[i] >= RADAR_NUM_SAMPLES / 2) {
+            return false;
+        }
+    }
+
+    for (int i = 0; i < num_bins; i++) {
+        ctx->bins[i] = bins[i];
+        float w = 2.0f * PI * (float)bins[i] / (float)RADAR_NUM_SAMPLES;
+        ctx->goertzel_coeff[i] = 2.0f * cosf(w);
+        ctx->goertzel_sin[i] = sinf(w);
+    }
+    ctx->num_bins = num_bins;
+    ctx->cal_update_pos = 0;
+
+    /* Averages for newly selected bins restart from the next frame */
+    ctx->first_run = true;
+
+    /* Re-resolve AUTO for the new bin count */
+    presence_set_spectrum_mode(ctx, ctx->spectrum_mode);
+    return true;
+}
+
+bool presence_restrict_bins(presence_ctx_t *ctx, const uint8_t *bins, uint8_t num_bins)
+{
+    bool first_run = ctx->first_run;
+
+    if (!presence_set_bins(ctx, bins, num_bins)) {
+        return false;
+    }
+    ctx->first_run = first_run;
+    return true;
+}
+
+void presence_set_spectrum_mode(presence_ctx_t *ctx, presence_spectrum_mode_t mode)
+{
+    ctx->spectrum_mode = mode;
+
+    switch (mode) {
+    case PRESENCE_SPECTRUM_SPARSE:
+        ctx->use_sparse = true;
+        break;
+    case PRESENCE_SPECTRUM_AUTO:
+        ctx->use_sparse = (ctx->num_bins <= PRESENCE_SPARSE_AUTO_MAX_BINS);
+        break;
+    case PRESENCE_SPECTRUM_FULL:
+    default:
+        ctx->use_sparse = false;
+        break;
+    }
+}
+
+/*
+ * Goertzel evaluation of one DFT bin
+ * Returns the same complex value as arm_rfft_fast_f32 for that bin
+ * (unnormalized forward DFT): X = s1 * e^jw - s2
+ */
+static void goertzel_bin(const float *x, float coeff, float sin_w, float *out)
+{
+    float s1 = 0.0f;
+    float s2 = 0.0f;
+
+    for (int n = 0; n < RADAR_NUM_SAMPLES; n++) {
+        float s0 = x[n] + coeff * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+
+    out[0] = s1 * 0.5f * coeff - s2;
+    out[1] = s1 * sin_w;
+}
+
+/*
+ * Amplitude factors taking a frame's range profile back to the exported
+ * IF gain: the VGA step, and per bin the ratio of the two first-order
+ * high-pass responses |H(f)| = f / sqrt(f^2 + fc^2) at the bin's beat
+ * frequency. Recomputed only when the setting changes (rare).
+ */
+static void gain_update(presence_ctx_t *ctx, const radar_frame_t *frame)
+{
+    if (frame->gain_db == ctx->gain_db && frame->hpf_khz == ctx->gain_hpf_khz &&
+        frame->hpf_ref_khz == ctx->gain_hpf_ref_khz) {
+        return;
+    }
+    ctx->gain_db = frame->gain_db;
+    ctx->gain_hpf_khz = frame->hpf_khz;
+    ctx->gain_hpf_ref_khz = frame->hpf_ref_khz;
+
+    float a = powf(10.0f, -(float)frame->gain_db / 20.0f);
+    bool hpf = frame->hpf_khz && frame->hpf_ref_khz && frame->hpf_khz != frame->hpf_ref_khz;
+    float fc2 = (float)frame->hpf_khz * (float)frame->hpf_khz;
+    float fc2_ref = (float)frame->hpf_ref_khz * (float)frame->hpf_ref_khz;
+    float bin_khz = (float)AVIAN_BIN_HZ / 1000.0f;
+
+    for (int i = 0; i < RADAR_NUM_SAMPLES / 2; i++) {
+        float f2 = (float)(i * i) * bin_khz * bin_khz;
+        float ratio = (hpf && i > 0) ? sqrtf((f2 + fc2) / (f2 + fc2_ref)) : 1.0f;
+        float s = a * ratio;
+        /* Power and log2 (taken afterwards) scale the power */
+        ctx->gain_scale[i] = (ctx->domain == PRESENCE_DOMAIN_LINEAR) ? s : s * s;
+    }
+    ctx->gain_motion_scale = a * a;
+}
+
+/* Whether the last frame needs gain normalization */
+static inline bool gain_active(const presence_ctx_t *ctx)
+{
+    return ctx->gain_db != 0 ||
+           (ctx->gain_hpf_khz && ctx->gain_hpf_ref_khz && ctx->gain_hpf_khz != ctx->gain_hpf_ref_khz);
+}
+
+/*
+ * Cheap tier: decide whether this frame needs the FFT pipeline
+ * Hysteresis: wake above GATE_WAKE_RATIO, sleep after gate_hold_frames
+ * (GATE_HOLD_FRAMES at the reference period) frames below GATE_SLEEP_RATIO
+ */
+static bool presence_gate(presence_ctx_t *ctx, const radar_frame_t *frame)
+{
+    float motion = (float)frame->motion_energy;
+    if (gain_active(ctx)) {
+        motion *= ctx->gain_motion_scale;
+    }
+
+    if (ctx->gate_background <= 0.0f) {
+        ctx->gate_background = motion;
+        return true;
+    }
+
+    float ratio = motion / ctx->gate_background;
+
+    if (ratio > GATE_WAKE_RATIO) {
+        ctx->gate_awake = true;
+        ctx->gate_quiet_frames = 0;
+    } else if (ratio < GATE_SLEEP_RATIO) {
+        if (ctx->gate_quiet_frames < ctx->gate_hold_frames) {
+            ctx->gate_quiet_frames++;
+        }
+    } else {
+        ctx->gate_quiet_frames = 0;
+    }
+
+    if (ctx->gate_awake && ctx->gate_quiet_frames >= ctx->gate_hold_frames &&
+        !ctx->presence_detected) {
+        ctx->gate_awake = false;
+    }
+
+    /* Background follows the idle level only */
+    if (!ctx->gate_awake) {
+        ctx->gate_background += ctx->gate_alpha * (motion - ctx->gate_background);
+    }
+
+    return ctx->gate_awake;
+}
+
+bool presence_update(presence_ctx_t *ctx, const radar_frame_t *frame)
+{
+    ctx->full_evaluated = false;
+
+    if (!frame || !frame->valid) {
+        return false;
+    }
+    ctx->frame_gap = frame->gap;
+    gain_update(ctx, frame);
+
+    if (ctx->mode == PRESENCE_MODE_TWO_TIER) {
+        bool awake = presence_gate(ctx, frame);
+        bool forced = (++ctx->frames_since_full >= ctx->gate_force_period);
+
+        /* A calibration window needs every frame, not one per force period */
+        if (!awake && !forced && !ctx->first_run && ctx->cal_mode != PRESENCE_CAL_BATCH) {
+            ctx->frames_skipped += (uint32_t)frame->gap + 1;
+            return ctx->presence_detected;
+        }
+    }
+
+    ctx->frames_since_full = 0;
+    ctx->full_evaluated = true;
+    return presence_detect(ctx, frame);
 }
 
 /*
@@ -55,85 +433,170 @@ bool presence_detect(presence_ctx_t *ctx, const radar_frame_t *frame)
         return false;
     }
 
+    gain_update(ctx, frame);
+
     /* Temporary buffers for processing */
-    float range_samples[RADAR_NUM_SAMPLES];
     float windowed[RADAR_NUM_SAMPLES];
-    float fft_output[RADAR_NUM_SAMPLES * 2];  /* Complex output (I,Q pairs) */
-    float fft_magnitude[RADAR_NUM_SAMPLES];
+    float *fft_output = ctx->spectrum;          /* Complex output (I,Q pairs) */
+    float *fft_magnitude = ctx->range_profile;  /* Kept for downstream feature stages */
+
+    /* Step 1+2: Average samples across all chirps for each range bin,
+     * with normalization and Blackman-Harris window folded into one scale
+     */
+    int num_chirps = frame->num_chirps ? frame->num_chirps : RADAR_NUM_CHIRPS;
+    float inv_chirps = 1.0f / (float)num_chirps;
 
-    /* Step 1: Average samples across all chirps for each range bin */
     for (int s = 0; s < RADAR_NUM_SAMPLES; s++) {
-        float sum = 0.0f;
+        int32_t sum = 0;
 
-        for (int c = 0; c < RADAR_NUM_CHIRPS; c++) {
+        for (int c = 0; c < num_chirps; c++) {
             /* Get sample from frame (assuming I/Q interleaved, using I channel) */
-            int idx = c * RADAR_NUM_SAMPLES + s;
-            int16_t sample = frame->samples[idx];
-
-            /* Convert to float and normalize */
-            sum += (float)sample / 32768.0f;
+            sum += frame->samples[c * RADAR_NUM_SAMPLES + s];
         }
 
-        range_samples[s] = sum / (float)RADAR_NUM_CHIRPS;
+        windowed[s] = (float)sum * inv_chirps * window_scaled[s];
     }
 
-    /* Step 2: Apply Blackman-Harris window */
-    for (int i = 0; i < RADAR_NUM_SAMPLES; i++) {
-        windowed[i] = range_samples[i] * blackman_harris_64[i];
-    }
+    if (ctx->use_sparse) {
+        /* Step 3+4 (sparse): Goertzel for configured bins only */
+        for (int b = 0; b < ctx->num_bins; b++) {
+            int i = ctx->bins[b];
+            float *bin = &fft_output[2 * i];
+
+            goertzel_bin(windowed, ctx->goertzel_coeff[b], ctx->goertzel_sin[b], bin);
+            float power = bin[0] * bin[0] + bin[1] * bin[1];
+            fft_magnitude[i] = (ctx->domain == PRESENCE_DOMAIN_LINEAR) ? sqrtf(power) : power;
+            if (gain_active(ctx)) {
+                fft_magnitude[i] *= ctx->gain_scale[i];
+            }
+        }
+    } else {
+        /* Step 3: Compute FFT */
+        arm_rfft_fast_f32(&fft_instance, windowed, fft_output, 0);
 
-    /* Step 3: Compute FFT */
-    arm_rfft_fast_f32(&fft_instance, windowed, fft_output, 0);
+        /* Step 4: Calculate magnitude (or power) of complex FFT output */
+        /* FFT output is [real0, imag0, real1, imag1, ...] */
+        if (ctx->domain == PRESENCE_DOMAIN_LINEAR) {
+            arm_cmplx_mag_f32(fft_output, fft_magnitude, RADAR_NUM_SAMPLES / 2);
+        } else {
+            arm_cmplx_mag_squared_f32(fft_output, fft_magnitude, RADAR_NUM_SAMPLES / 2);
+        }
+        if (gain_active(ctx)) {
+            for (int i = 0; i < RADAR_NUM_SAMPLES / 2; i++) {
+                fft_magnitude[i] *= ctx->gain_scale[i];
+            }
+        }
+    }
 
-    /* Step 4: Calculate magnitude of complex FFT output */
-    /* FFT output is [real0, imag0, real1, imag1, ...] */
-    arm_cmplx_mag_f32(fft_output, fft_magnitude, RADAR_NUM_SAMPLES / 2);
+    bool log_domain = (ctx->domain == PRESENCE_DOMAIN_LOG2);
 
     /* Step 5: Initialize averages on first run */
     if (ctx->first_run) {
-        for (int i = 0; i < RADAR_NUM_SAMPLES / 2; i++) {
-            ctx->slow_avg[i] = fft_magnitude[i];
-            ctx->fast_avg[i] = fft_magnitude[i];
+        for (int b = 0; b < ctx->num_bins; b++) {
+            int i = ctx->bins[b];
+            float x = log_domain ? fast_log2(fft_magnitude[i]) : fft_magnitude[i];
+            ctx->slow_avg[i] = x;
+            ctx->fast_avg[i] = x;
         }
         ctx->first_run = false;
+        ctx->frames_skipped = 0;
         return false;  /* No detection on first frame */
     }
 
-    /* Step 6: Update exponential moving averages (IIR filters) */
-    float alpha_slow_used = ctx->presence_detected ? ALPHA_SLOW : ALPHA_MED;
-
-    for (int i = 0; i < RADAR_NUM_SAMPLES / 2; i++) {
-        /* Slow average (background tracking) */
-        ctx->slow_avg[i] = ctx->slow_avg[i] * (1.0f - alpha_slow_used) +
-                          fft_magnitude[i] * alpha_slow_used;
+    /* Step 6+7: Update exponential moving averages (IIR filters) and
+     * find maximum difference over the configured bins
+     */
+    float alpha_slow_used = ctx->presence_detected ? ctx->alpha_slow : ctx->alpha_med;
+    float alpha_fast = ctx->alpha_fast;
 
-        /* Fast average (target tracking) */
-        ctx->fast_avg[i] = ctx->fast_avg[i] * (1.0f - ALPHA_FAST) +
-                          fft_magnitude[i] * ALPHA_FAST;
+    /* Frames lost to a FIFO overflow: decay over the whole interval, as
+     * if the input had held this frame's value through the gap */
+    if (frame->gap > 0) {
+        alpha_slow_used = rescale_alpha(alpha_slow_used, (float)(frame->gap + 1));
+        alpha_fast = rescale_alpha(alpha_fast, (float)(frame->gap + 1));
+    }
+    /* Frames skipped by the gate (no motion): advance the averages over
+     * them as if the input had held the last fast average, so the time
+     * constants stay in wall time and the slow background is current
+     * on wake-up without absorbing this frame */
+    if (ctx->frames_skipped > 0) {
+        float a = rescale_alpha(alpha_slow_used, (float)ctx->frames_skipped);
+        for (int b = 0; b < ctx->num_bins; b++) {
+            int i = ctx->bins[b];
+            ctx->slow_avg[i] += a * (ctx->fast_avg[i] - ctx->slow_avg[i]);
+        }
+        ctx->frames_skipped = 0;
     }
 
-    /* Step 7: Find maximum difference in detection range */
     float max_diff = 0.0f;
+    float max_excess = -1e30f;
     int max_idx = 0;
 
-    for (int i = DETECT_START_SAMPLE; i < DETECT_END_SAMPLE && i < RADAR_NUM_SAMPLES / 2; i++) {
+    /* Calibration statistics ride along in the same loop */
+    bool cal_batch = (ctx->cal_mode == PRESENCE_CAL_BATCH);
+    bool cal_online = (ctx->cal_mode == PRESENCE_CAL_ONLINE) && !ctx->presence_detected;
+    float cal_inv_n = cal_batch ? 1.0f / (float)(++ctx->cal_count) : 0.0f;
+
+    for (int b = 0; b < ctx->num_bins; b++) {
+        int i = ctx->bins[b];
+        float x = log_domain ? fast_log2(fft_magnitude[i]) : fft_magnitude[i];
+
+        /* Slow average (background tracking) */
+        ctx->slow_avg[i] = ctx->slow_avg[i] * (1.0f - alpha_slow_used) +
+                          x * alpha_slow_used;
+
+        /* Fast average (target tracking) */
+        ctx->fast_avg[i] = ctx->fast_avg[i] * (1.0f - alpha_fast) +
+                          x * alpha_fast;
+
         float diff = ctx->fast_avg[i] - ctx->slow_avg[i];
         if (diff > max_diff) {
             max_diff = diff;
             max_idx = i;
         }
+
+        /* Per-bin threshold */
+        float excess = diff - ctx->bin_threshold[i];
+        if (excess > max_excess) {
+            max_excess = excess;
+        }
+
+        if (cal_batch) {
+            /* Welford: mean += d / n, M2 += d * (x - mean) */
+            float delta = diff - ctx->cal_mean[i];
+            ctx->cal_mean[i] += delta * cal_inv_n;
+            ctx->cal_m2[i] += delta * (diff - ctx->cal_mean[i]);
+        } else if (cal_online) {
+            /* Exponentially weighted mean and variance */
+            float delta = diff - ctx->cal_mean[i];
+            ctx->cal_mean[i] += CAL_ONLINE_ALPHA * delta;
+            ctx->cal_m2[i] = (1.0f - CAL_ONLINE_ALPHA) *
+                             (ctx->cal_m2[i] + CAL_ONLINE_ALPHA * delta * delta);
+        }
     }
 
-    /* Step 8: Threshold comparison */
-    ctx->presence_detected = (max_diff > THRESHOLD_PRESENCE);
+    /* Step 8: Threshold comparison (any bin above its threshold) */
+    ctx->presence_detected = (max_excess > 0.0f);
+    ctx->max_diff = max_diff;
+    ctx->max_excess = max_excess;
+    ctx->max_idx = (uint8_t)max_idx;
+
+    if (cal_batch && ctx->cal_count >= ctx->cal_frames) {
+        cal_finish_batch(ctx);
+    } else if (cal_online) {
+        /* Refresh one bin threshold per frame (one sqrt) */
+        int i = ctx->bins[ctx->cal_update_pos];
+        cal_set_threshold(ctx, i, ctx->cal_mean[i], ctx->cal_m2[i]);
+        ctx->cal_update_pos = (uint8_t)((ctx->cal_update_pos + 1) % ctx->num_bins);
+    }
 
     /* Optional: Calculate approximate distance */
     if (ctx->presence_detected) {
-        /* Distance = (range_bin * c) / (2 * bandwidth * samples)
-         * c = 3e8 m/s, bandwidth = 3.232 GHz, samples = 64
-         * distance ≈ range_bin * 0.7 meters
+        /* Distance = range_bin * c / (2 * bandwidth)
+         * c = 3e8 m/s, bandwidth = AVIAN_BANDWIDTH_HZ (5.5 GHz)
+         * distance ≈ range_bin * 0.027 meters
          */
-        (void)max_idx;  /* Can be used for distance calculation */
+        /* ctx->max_idx is used for distance and vital-sign tracking */
     }
 
     return ctx->presence_detected;
@@ -18,11 +18,121 @@
 #define ALPHA_SLOW              0.001f
 #define ALPHA_MED               0.05f
 #define ALPHA_FAST              0.6f
+#define ALPHA_REF_FRAME_MS      77      /* Frame period the alphas are tuned for */
+
+/* Power / log2 domain thresholds, converted from THRESHOLD_PRESENCE so
+ * that a target raising a bin from the reference background magnitude
+ * B to B + THRESHOLD_PRESENCE trips all domains alike:
+ *   power: (B + T)^2 - B^2        log2: log2((B + T)^2 / B^2)
+ * Log2 thresholds are relative to the background, so B is the level
+ * where the decisions match: fitted with build/host/test_presence_domain
+ * (synthetic room agrees >= 99.8% for B = 1e-4..4e-4; re-fit on
+ * recordings). The alphas set time constants and apply unchanged in
+ * every domain.
+ */
+#define PRESENCE_REF_MAGNITUDE  0.0004f
+#define THRESHOLD_PRESENCE_POWER \
+    ((PRESENCE_REF_MAGNITUDE + THRESHOLD_PRESENCE) * (PRESENCE_REF_MAGNITUDE + THRESHOLD_PRESENCE) - \
+     PRESENCE_REF_MAGNITUDE * PRESENCE_REF_MAGNITUDE)
+#define THRESHOLD_PRESENCE_LOG2 \
+    (2.0f * log2f(1.0f + THRESHOLD_PRESENCE / PRESENCE_REF_MAGNITUDE))
+
+/* Threshold calibration from empty-room statistics of fast - slow */
+#define CAL_DEFAULT_FRAMES      300     /* Batch window (~23 s at 13 Hz) */
+#define CAL_DEFAULT_PFA         1e-5f   /* Target false alarms per frame */
+#define CAL_ONLINE_ALPHA        0.001f  /* Online mean/variance adaptation */
+#define CAL_MIN_FRACTION        0.1f    /* Floor: fraction of the domain threshold */
+
+/* Sparse spectrum (Goertzel) configuration */
+#define PRESENCE_MAX_SPARSE_BINS        (RADAR_NUM_SAMPLES / 2)
+/* Goertzel vs FFT crossover: an estimate from operation counts (one
+ * Goertzel bin ~64 multiply-adds; 64-point real FFT plus 32 magnitudes
+ * ~6 bins' worth), not yet measured on target. A BENCHMARK build sweeps
+ * 1..BENCHMARK_SPARSE_BINS bins and leaves the measured value in
+ * benchmark_results.sparse_crossover_bins (cycles per bin count in
+ * presence_sparse_cycles); replace the estimate with it. */
+#define PRESENCE_SPARSE_AUTO_MAX_BINS   6
+
+/* Two-tier gate: motion_energy relative to its idle background */
+#define GATE_WAKE_RATIO         2.0f    /* Wake full pipeline above this */
+#define GATE_SLEEP_RATIO        1.3f    /* Allow sleep again below this */
+#define GATE_HOLD_FRAMES        13      /* Quiet frames before sleeping (~1 s) */
+#define GATE_FORCE_PERIOD       65      /* Forced full evaluation period (~5 s) */
+#define GATE_ALPHA              0.02f   /* Idle background adaptation */
+/* (frame counts and alpha at ALPHA_REF_FRAME_MS; rescaled to the frame period) */
+
+/* Detection pipeline mode */
+typedef enum {
+    PRESENCE_MODE_FULL = 0,         /* FFT pipeline on every frame */
+    PRESENCE_MODE_TWO_TIER          /* Motion gate wakes the FFT pipeline */
+} presence_mode_t;
+
+/* Domain of the range profile and the IIR averages */
+typedef enum {
+    PRESENCE_DOMAIN_LINEAR = 0,     /* Magnitude |X| (sqrt per bin) */
+    PRESENCE_DOMAIN_POWER,          /* Power |X|^2, no sqrt */
+    PRESENCE_DOMAIN_LOG2            /* log2 |X|^2 (fast approximation), no sqrt */
+} presence_domain_t;
+
+/* Per-bin threshold calibration */
+typedef enum {
+    PRESENCE_CAL_OFF = 0,           /* Thresholds fixed */
+    PRESENCE_CAL_BATCH,             /* Collecting a calibration window */
+    PRESENCE_CAL_ONLINE             /* Adapting slowly on frames without presence */
+} presence_cal_mode_t;
+
+/* How the range spectrum is computed */
+typedef enum {
+    PRESENCE_SPECTRUM_FULL = 0,     /* 64-point real FFT + magnitude of all bins */
+    PRESENCE_SPECTRUM_SPARSE,       /* Goertzel on configured bins only */
+    PRESENCE_SPECTRUM_AUTO          /* Sparse when bin count <= crossover */
+} presence_spectrum_mode_t;
 
 /* Presence detection state */
 typedef struct {
     float slow_avg[RADAR_NUM_SAMPLES];
     float fast_avg[RADAR_NUM_SAMPLES];
+    float range_profile[RADAR_NUM_SAMPLES / 2];  /* Last |X| (LINEAR) or |X|^2 per range bin */
+    float spectrum[RADAR_NUM_SAMPLES];           /* Last complex spectrum (re,im per bin) */
+    uint8_t bins[PRESENCE_MAX_SPARSE_BINS];      /* Range bins evaluated for detection */
+    float goertzel_coeff[PRESENCE_MAX_SPARSE_BINS];
+    float goertzel_sin[PRESENCE_MAX_SPARSE_BINS];
+    uint8_t num_bins;
+    presence_spectrum_mode_t spectrum_mode;
+    bool use_sparse;                             /* Resolved from spectrum_mode */
+    presence_mode_t mode;
+    presence_domain_t domain;
+    float threshold;                             /* THRESHOLD_PRESENCE* of the domain */
+    float bin_threshold[RADAR_NUM_SAMPLES / 2];  /* Per-bin threshold used for detection */
+    presence_cal_mode_t cal_mode;
+    bool cal_online;                             /* Continue online after the batch */
+    float cal_k;                                 /* Threshold = mean + k * sigma */
+    uint32_t cal_count;                          /* Batch frames collected */
+    uint32_t cal_frames;                         /* Batch window */
+    uint8_t cal_update_pos;                      /* Online: next bin to refresh */
+    float cal_mean[RADAR_NUM_SAMPLES / 2];       /* Welford mean of fast - slow */
+    float cal_m2[RADAR_NUM_SAMPLES / 2];         /* Batch: sum of squares; online: variance */
+    float alpha_slow;                            /* ALPHA_* rescaled to frame period */
+    float alpha_med;
+    float alpha_fast;
+    float gate_background;                       /* Idle motion_energy level */
+    float gate_alpha;                            /* GATE_* rescaled to frame period */
+    uint32_t gate_hold_frames;
+    uint32_t gate_force_period;
+    uint32_t gate_quiet_frames;                  /* Consecutive frames below sleep level */
+    uint32_t frames_since_full;
+    uint32_t frames_skipped;                     /* Gate-skipped frames (with gaps) since the last full evaluation */
+    bool gate_awake;
+    bool full_evaluated;                         /* Last update ran the FFT pipeline */
+    uint16_t frame_gap;                          /* Frames lost right before the last update */
+    float gain_scale[RADAR_NUM_SAMPLES / 2];     /* Range profile back to the exported IF gain */
+    float gain_motion_scale;                     /* Same for motion_energy */
+    int8_t gain_db;                              /* Setting gain_scale was computed for */
+    uint8_t gain_hpf_khz;
+    uint8_t gain_hpf_ref_khz;
+    float max_diff;                              /* Largest fast-slow difference */
+    float max_excess;                            /* Largest difference above its bin threshold */
+    uint8_t max_idx;                             /* Range bin of max_diff */
     bool first_run;
     bool presence_detected;
 } presence_ctx_t;
@@ -32,9 +142,108 @@ typedef struct {
  */
 void presence_init(presence_ctx_t *ctx);
 
+/*
+ * Select the range bins evaluated for detection (default:
+ * DETECT_START_SAMPLE..DETECT_END_SAMPLE). Restarts the averages.
+ * Returns false if num_bins is 0, too large, or a bin is out of range.
+ */
+bool presence_set_bins(presence_ctx_t *ctx, const uint8_t *bins, uint8_t num_bins);
+
+/*
+ * Like presence_set_bins(), but keeps the averages and thresholds: for
+ * moving between subsets of bins that have been evaluated before
+ * (supervisor SPARSE level). Bins left out meanwhile resume from their
+ * last averages.
+ */
+bool presence_restrict_bins(presence_ctx_t *ctx, const uint8_t *bins, uint8_t num_bins);
+
+/*
+ * Select full FFT, sparse Goertzel or automatic spectrum computation
+ */
+void presence_set_spectrum_mode(presence_ctx_t *ctx, presence_spectrum_mode_t mode);
+
+/*
+ * Select the detection domain (default PRESENCE_DOMAIN_LINEAR)
+ * Sets ctx->threshold (and every bin threshold) to the converted
+ * threshold, stops calibration and restarts the averages.
+ */
+void presence_set_domain(presence_ctx_t *ctx, presence_domain_t domain);
+
+/*
+ * Set the domain threshold and every bin threshold to `threshold`
+ */
+void presence_set_threshold(presence_ctx_t *ctx, float threshold);
+
+/*
+ * Start a batch calibration: collect fast - slow statistics per bin
+ * (Welford) over `frames` frames of an empty room, then set
+ * ctx->bin_threshold to mean + k * sigma, with k chosen for `pfa`
+ * false alarms per frame over all configured bins (Gaussian model).
+ * Detection keeps running on the old thresholds meanwhile.
+ * online: afterwards keep adapting (see presence_set_online_calibration)
+ */
+void presence_calibrate(presence_ctx_t *ctx, uint32_t frames, float pfa, bool online);
+
+/*
+ * Online variant: exponentially weighted mean/variance (CAL_ONLINE_ALPHA)
+ * updated on frames without presence; one bin threshold is refreshed
+ * per frame. Starts from the current thresholds.
+ */
+void presence_set_online_calibration(presence_ctx_t *ctx, bool enable, float pfa);
+
+/*
+ * Linear magnitude |X| of a range bin from ctx->range_profile, in any
+ * domain (sqrt of the power outside PRESENCE_DOMAIN_LINEAR)
+ */
+float presence_bin_magnitude(const presence_ctx_t *ctx, int bin);
+
+/*
+ * Range window applied before the spectrum (Blackman-Harris with the
+ * 1/32768 normalization folded in, RADAR_NUM_SAMPLES values); valid
+ * after presence_init()
+ */
+const float *presence_window(void);
+
+/*
+ * Rescale IIR alphas for a new frame period so the filters keep the
+ * same time constants: alpha' = 1 - (1 - alpha)^(T' / ALPHA_REF_FRAME_MS);
+ * the gate's hold and forced-evaluation frame counts keep their wall
+ * time as well
+ */
+void presence_set_frame_period(presence_ctx_t *ctx, uint32_t frame_period_ms);
+
+/*
+ * Select full or two-tier detection for presence_update()
+ */
+void presence_set_mode(presence_ctx_t *ctx, presence_mode_t mode);
+
+/*
+ * Per-frame entry point
+ * PRESENCE_MODE_FULL: same as presence_detect()
+ * PRESENCE_MODE_TWO_TIER: runs presence_detect() only while the motion
+ * gate is awake, while presence is detected, or every GATE_FORCE_PERIOD
+ * frames to keep the backgrounds fresh, and on every frame of a batch
+ * calibration (presence_calibrate); the next full evaluation
+ * advances the averages over the skipped frames (slow toward fast)
+ * ctx->full_evaluated tells whether the FFT pipeline ran (run
+ * downstream classifiers only then); ctx->frame_gap passes on
+ * frame->gap (frames lost to a FIFO overflow)
+ * Frames acquired at another IF gain or high-pass than the exported one
+ * (frame->gain_db, hpf_khz) are scaled back to it: range profile and
+ * motion energy, hence the averages, thresholds and gate background,
+ * stay in the same units across a gain step
+ * Returns true if presence detected
+ */
+bool presence_update(presence_ctx_t *ctx, const radar_frame_t *frame);
+
 /*
  * Run presence detection on radar frame
  * Returns true if presence detected
+ * ctx->range_profile / ctx->spectrum hold the frame's range FFT
+ * magnitude / complex value afterwards (in sparse mode only the
+ * configured bins are updated; the magnitude is normalized to the
+ * exported IF gain, the complex value is not); ctx->max_idx is the
+ * strongest bin
  */
 bool presence_detect(presence_ctx_t *ctx, const radar_frame_t *frame);
 
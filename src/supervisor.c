@@ -0,0 +1,182 @@
+/*
+ * Frame-Deadline Supervisor Implementation
+ *
+ * Stage budgets are shares of the frame budget; a stage over its share
+ * is only counted (telemetry shows where the time went). Degradation
+ * is driven by the whole frame, which is what decides whether the next
+ * frame waits.
+ */
+
+#include "supervisor.h"
+#include "watchdog.h"
+#include "cycles.h"
+#include "clock.h"
+#include "trace.h"
+#include <string.h>
+
+/* Time source: host tests substitute a simulated clock */
+#ifdef SUPERVISOR_CLOCK_FN
+uint32_t SUPERVISOR_CLOCK_FN(void);
+#define SUPERVISOR_CLOCK()  SUPERVISOR_CLOCK_FN()
+#else
+#define SUPERVISOR_CLOCK()  cycles_now()
+#endif
+
+static const struct {
+    trace_id_t trace;
+    uint8_t budget_pct;             /* Share of the frame budget */
+} stages[SUPERVISOR_NUM_STAGES] = {
+    [SUPERVISOR_STAGE_PRESENCE] = { TRACE_PRESENCE,   40 },
+    [SUPERVISOR_STAGE_TRACKING] = { TRACE_TRACKING,   10 },
+    [SUPERVISOR_STAGE_GESTURE]  = { TRACE_GESTURE,    15 },
+    [SUPERVISOR_STAGE_FEATURES] = { TRACE_FEATURES,   15 },
+    [SUPERVISOR_STAGE_VITALS]   = { TRACE_VITALS,     10 },
+    [SUPERVISOR_STAGE_OUTPUT]   = { TRACE_OUTPUT,     10 },
+};
+
+void supervisor_init(supervisor_t *sup, presence_ctx_t *presence, uint32_t frame_period_ms)
+{
+    memset(sup, 0, sizeof(*sup));
+    sup->presence = presence;
+    sup->level = SUPERVISOR_FULL;
+    sup->recover_frames = SUPERVISOR_RECOVER_FRAMES;
+    supervisor_set_frame_period(sup, frame_period_ms);
+
+    /* WDT_MR is write-once: until here the reset default (~16 s) runs */
+    watchdog_init(SUPERVISOR_WDT_TIMEOUT_MS);
+    watchdog_reset();
+}
+
+void supervisor_set_frame_period(supervisor_t *sup, uint32_t frame_period_ms)
+{
+    uint32_t period_cycles = frame_period_ms * (CPU_FREQ / 1000UL);
+
+    sup->budget_cycles = period_cycles / 100 * SUPERVISOR_FRAME_BUDGET_PCT;
+    sup->hang_cycles = period_cycles * SUPERVISOR_HANG_PERIODS;
+}
+
+void supervisor_frame_begin(supervisor_t *sup)
+{
+    sup->frame_start = SUPERVISOR_CLOCK();
+}
+
+void supervisor_stage_begin(supervisor_t *sup, supervisor_stage_t stage, uint16_t arg)
+{
+    trace_begin(stages[stage].trace, arg);
+    sup->stage_start = SUPERVISOR_CLOCK();
+}
+
+void supervisor_stage_end(supervisor_t *sup, supervisor_stage_t stage, uint16_t arg)
+{
+    uint32_t cycles = SUPERVISOR_CLOCK() - sup->stage_start;
+    trace_end(stages[stage].trace, arg);
+
+    if (cycles > sup->stage_max_cycles[stage]) {
+        sup->stage_max_cycles[stage] = cycles;
+    }
+    if (cycles > sup->budget_cycles / 100 * stages[stage].budget_pct) {
+        sup->stage_overruns[stage]++;
+    }
+}
+
+bool supervisor_run_classifiers(const supervisor_t *sup)
+{
+    return sup->level == SUPERVISOR_FULL;
+}
+
+/* Evaluate at most PRESENCE_SPARSE_AUTO_MAX_BINS consecutive configured
+ * bins, centred on the strongest one; sparse above the crossover would
+ * cost more than the FFT it replaces */
+static void narrow_bins(supervisor_t *sup)
+{
+    presence_ctx_t *p = sup->presence;
+    int n = p->num_bins;
+    int k = PRESENCE_SPARSE_AUTO_MAX_BINS;
+
+    sup->saved_num_bins = p->num_bins;
+    memcpy(sup->saved_bins, p->bins, p->num_bins);
+    if (n <= k) {
+        return;
+    }
+
+    int centre = 0;
+    for (int b = 0; b < n; b++) {
+        if (p->bins[b] <= p->max_idx) {
+            centre = b;
+        }
+    }
+    int first = centre - k / 2;
+    if (first > n - k) first = n - k;
+    if (first < 0) first = 0;
+    presence_restrict_bins(p, &sup->saved_bins[first], (uint8_t)k);
+}
+
+static void set_level(supervisor_t *sup, supervisor_level_t level)
+{
+    if (level == SUPERVISOR_SPARSE) {
+        sup->saved_spectrum = sup->presence->spectrum_mode;
+        narrow_bins(sup);
+        presence_set_spectrum_mode(sup->presence, PRESENCE_SPECTRUM_SPARSE);
+    } else if (sup->level == SUPERVISOR_SPARSE) {
+        presence_restrict_bins(sup->presence, sup->saved_bins, sup->saved_num_bins);
+        presence_set_spectrum_mode(sup->presence, sup->saved_spectrum);
+    }
+
+    sup->level = level;
+    sup->healthy_run = 0;
+    sup->report_due = true;
+}
+
+bool supervisor_frame_end(supervisor_t *sup, uint32_t late_frames)
+{
+    uint32_t cycles = SUPERVISOR_CLOCK() - sup->frame_start;
+    bool queued = (late_frames != sup->last_late);
+    bool overrun = queued || (cycles > sup->budget_cycles);
+
+    sup->last_late = late_frames;
+    sup->frames++;
+    sup->since_step_up++;
+    if (cycles > sup->frame_max_cycles) {
+        sup->frame_max_cycles = cycles;
+    }
+
+    if (overrun) {
+        sup->overruns++;
+        sup->late += queued;
+        sup->overrun_run++;
+        if (sup->level + 1 < SUPERVISOR_NUM_LEVELS) {
+            /* Stepped up too early: wait longer next time */
+            if (sup->step_ups > 0 && sup->since_step_up <= sup->recover_frames &&
+                sup->recover_frames < SUPERVISOR_RECOVER_MAX_FRAMES) {
+                sup->recover_frames *= 2;
+            }
+            set_level(sup, (supervisor_level_t)(sup->level + 1));
+            sup->step_downs++;
+        }
+        sup->healthy_run = 0;
+    } else {
+        sup->overrun_run = 0;
+        if (sup->level == SUPERVISOR_FULL && sup->since_step_up > SUPERVISOR_RECOVER_MAX_FRAMES) {
+            sup->recover_frames = SUPERVISOR_RECOVER_FRAMES;    /* Load has gone */
+        }
+        if (sup->level > SUPERVISOR_FULL && ++sup->healthy_run >= sup->recover_frames) {
+            set_level(sup, (supervisor_level_t)(sup->level - 1));
+            sup->step_ups++;
+            sup->since_step_up = 0;
+        }
+    }
+
+    bool stuck = (sup->level == SUPERVISOR_SPARSE) && (sup->overrun_run >= SUPERVISOR_STUCK_FRAMES);
+    if (cycles <= sup->hang_cycles && !stuck) {
+        watchdog_reset();
+    } else {
+        sup->unhealthy++;
+    }
+
+    if (sup->frames % SUPERVISOR_REPORT_FRAMES == 0) {
+        sup->report_due = true;
+    }
+    bool report = sup->report_due;
+    sup->report_due = false;
+    return report;
+}
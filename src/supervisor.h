@@ -0,0 +1,125 @@
+/*
+ * Frame-Deadline Supervisor
+ *
+ * Times every processing stage of a frame (CYCCNT) against the active
+ * profile's frame period. A frame overruns when processing takes more
+ * than SUPERVISOR_FRAME_BUDGET_PCT of the period, or when the sensor
+ * had already queued the next frame (continuous mode backlog). Each
+ * overrun steps the pipeline down one level:
+ *   FULL           everything runs
+ *   NO_CLASSIFIER  wave and gesture classifiers are skipped
+ *   SPARSE         presence also switches to sparse Goertzel bins,
+ *                  at most PRESENCE_SPARSE_AUTO_MAX_BINS of them around
+ *                  the target (more would cost more than the FFT); zones
+ *                  outside them are not evaluated at this level
+ * After SUPERVISOR_RECOVER_FRAMES frames without overrun it steps back
+ * up; the wait doubles (up to SUPERVISOR_RECOVER_MAX_FRAMES) when a
+ * step up overruns again soon, so a load just above budget does not
+ * make it oscillate.
+ *
+ * The hardware watchdog is armed by supervisor_init() and only kicked
+ * at the end of a healthy frame: processed within
+ * SUPERVISOR_HANG_PERIODS frame periods, and not overrunning for
+ * SUPERVISOR_STUCK_FRAMES frames in a row at the lowest level. No
+ * frames (sensor or bus stuck) also means no kick.
+ */
+
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "presence_detection.h"
+
+#define SUPERVISOR_WDT_TIMEOUT_MS       2000
+#define SUPERVISOR_FRAME_BUDGET_PCT     80      /* Rest of the period: readout, telemetry */
+#define SUPERVISOR_RECOVER_FRAMES       64
+#define SUPERVISOR_RECOVER_MAX_FRAMES   1024
+#define SUPERVISOR_HANG_PERIODS         4
+#define SUPERVISOR_STUCK_FRAMES         32
+#define SUPERVISOR_REPORT_FRAMES        64      /* Telemetry interval (and on level changes) */
+
+typedef enum {
+    SUPERVISOR_FULL = 0,
+    SUPERVISOR_NO_CLASSIFIER,
+    SUPERVISOR_SPARSE,
+    SUPERVISOR_NUM_LEVELS
+} supervisor_level_t;
+
+/* Timed stages (each also traced as a begin/end pair) */
+typedef enum {
+    SUPERVISOR_STAGE_PRESENCE = 0,
+    SUPERVISOR_STAGE_TRACKING,
+    SUPERVISOR_STAGE_GESTURE,
+    SUPERVISOR_STAGE_FEATURES,
+    SUPERVISOR_STAGE_VITALS,
+    SUPERVISOR_STAGE_OUTPUT,
+    SUPERVISOR_NUM_STAGES
+} supervisor_stage_t;
+
+typedef struct {
+    presence_ctx_t *presence;
+    supervisor_level_t level;
+    presence_spectrum_mode_t saved_spectrum;    /* Restored when leaving SPARSE */
+    uint8_t saved_bins[PRESENCE_MAX_SPARSE_BINS];
+    uint8_t saved_num_bins;
+
+    uint32_t budget_cycles;                     /* Frame processing budget */
+    uint32_t hang_cycles;
+    uint32_t frame_start;
+    uint32_t stage_start;
+
+    uint32_t recover_frames;                    /* Current wait before stepping up */
+    uint32_t healthy_run;                       /* Frames without overrun */
+    uint32_t since_step_up;
+    uint32_t overrun_run;                       /* Consecutive overruns */
+    uint32_t last_late;
+    bool report_due;
+
+    /* Statistics (telemetry) */
+    uint32_t frames;
+    uint32_t overruns;
+    uint32_t late;                              /* Overruns seen as a queued frame */
+    uint32_t unhealthy;                         /* Frames without a watchdog kick */
+    uint16_t step_downs;
+    uint16_t step_ups;
+    uint32_t frame_max_cycles;
+    uint32_t stage_max_cycles[SUPERVISOR_NUM_STAGES];
+    uint16_t stage_overruns[SUPERVISOR_NUM_STAGES];
+} supervisor_t;
+
+/*
+ * Initialize at FULL and arm the watchdog (SUPERVISOR_WDT_TIMEOUT_MS)
+ */
+void supervisor_init(supervisor_t *sup, presence_ctx_t *presence, uint32_t frame_period_ms);
+
+/*
+ * New frame period (frame rate profile change)
+ */
+void supervisor_set_frame_period(supervisor_t *sup, uint32_t frame_period_ms);
+
+/*
+ * Mark the start of a frame's processing (after the readout)
+ */
+void supervisor_frame_begin(supervisor_t *sup);
+
+/*
+ * Time a stage; `arg` goes into the trace record
+ */
+void supervisor_stage_begin(supervisor_t *sup, supervisor_stage_t stage, uint16_t arg);
+void supervisor_stage_end(supervisor_t *sup, supervisor_stage_t stage, uint16_t arg);
+
+/*
+ * Whether the classifiers run at the current level
+ */
+bool supervisor_run_classifiers(const supervisor_t *sup);
+
+/*
+ * End of the frame: account the overrun, change level, kick the
+ * watchdog if healthy. late_frames: running count of frames the sensor
+ * had queued at readout (dev->stream.late). Returns true when a
+ * telemetry report is due.
+ */
+bool supervisor_frame_end(supervisor_t *sup, uint32_t late_frames);
+
+#endif /* SUPERVISOR_H */
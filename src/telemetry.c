@@ -0,0 +1,136 @@
+/*
+ * Telemetry Implementation
+ */
+
+#include "telemetry.h"
+#include "uart.h"
+#include "clock.h"
+
+/* CPU cycles to microseconds, saturated to 16 bits */
+static uint16_t cycles_to_us16(uint32_t cycles)
+{
+    uint32_t us = cycles / (CPU_FREQ / 1000000UL);
+    return us > 0xFFFF ? 0xFFFF : (uint16_t)us;
+}
+
+void telemetry_init(void)
+{
+    uart_init();
+}
+
+uint8_t *telemetry_put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+uint8_t *telemetry_put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+bool telemetry_send(uint8_t type, const uint8_t *payload, uint8_t len)
+{
+    static uint8_t packet[TELEMETRY_MAX_PAYLOAD + 5];
+    uint8_t check = type ^ len;
+
+    packet[0] = TELEMETRY_SYNC0;
+    packet[1] = TELEMETRY_SYNC1;
+    packet[2] = type;
+    packet[3] = len;
+    for (int i = 0; i < len; i++) {
+        packet[4 + i] = payload[i];
+        check ^= payload[i];
+    }
+    packet[4 + len] = check;
+
+    return uart_write(packet, (uint32_t)len + 5);
+}
+
+bool telemetry_send_status(const telemetry_status_t *status)
+{
+    uint8_t payload[16];
+    uint8_t *p = telemetry_put_u32(payload, status->frame);
+
+    *p++ = (uint8_t)((status->presence ? 0x01 : 0) | (status->waving ? 0x02 : 0));
+    *p++ = status->max_idx;
+    *p++ = status->occupancy;
+    *p++ = status->wave_class;
+    *p++ = status->gesture;
+    *p++ = status->gesture_seq;
+    *p++ = status->breathing_bpm;
+    *p++ = status->heart_bpm;
+    *p++ = status->zones;
+
+    return telemetry_send(TELEMETRY_TYPE_STATUS, payload, (uint8_t)(p - payload));
+}
+
+bool telemetry_send_link(const radar_link_t *link)
+{
+    uint8_t payload[24];
+    uint8_t *p = telemetry_put_u32(payload, link->clock_hz);
+
+    *p++ = link->scbr;
+    *p++ = (uint8_t)((link->hs_read ? 0x01 : 0) | (link->wide ? 0x02 : 0));
+    p = telemetry_put_u16(p, link->steps_tested);
+    p = telemetry_put_u32(p, link->readback_errors);
+    p = telemetry_put_u32(p, link->pattern_errors);
+    p = telemetry_put_u32(p, link->check_failures);
+
+    return telemetry_send(TELEMETRY_TYPE_LINK, payload, (uint8_t)(p - payload));
+}
+
+bool telemetry_send_supervisor(const supervisor_t *sup)
+{
+    uint8_t payload[64];
+    uint8_t *p = payload;
+
+    *p++ = (uint8_t)sup->level;
+    p = telemetry_put_u32(p, sup->frames);
+    p = telemetry_put_u32(p, sup->overruns);
+    p = telemetry_put_u32(p, sup->late);
+    p = telemetry_put_u32(p, sup->unhealthy);
+    p = telemetry_put_u16(p, sup->step_downs);
+    p = telemetry_put_u16(p, sup->step_ups);
+    p = telemetry_put_u32(p, sup->frame_max_cycles / (CPU_FREQ / 1000000UL));
+    for (int s = 0; s < SUPERVISOR_NUM_STAGES; s++) {
+        p = telemetry_put_u16(p, sup->stage_overruns[s]);
+        p = telemetry_put_u16(p, cycles_to_us16(sup->stage_max_cycles[s]));
+    }
+
+    return telemetry_send(TELEMETRY_TYPE_SUPERVISOR, payload, (uint8_t)(p - payload));
+}
+
+bool telemetry_send_trace(uint32_t *cursor)
+{
+    trace_record_t rec[TELEMETRY_TRACE_RECORDS];
+    uint8_t payload[4 + sizeof(rec)];
+
+    for (int n = 0; n < TELEMETRY_TRACE_PACKETS; n++) {
+        uint32_t next = *cursor;
+        uint32_t count = trace_read(&next, rec, TELEMETRY_TRACE_RECORDS);
+        if (count == 0) {
+            break;
+        }
+
+        uint8_t *p = telemetry_put_u32(payload, next - count);
+        for (uint32_t i = 0; i < count; i++) {
+            p = telemetry_put_u32(p, rec[i].cycles);
+            p = telemetry_put_u16(p, rec[i].id);
+            p = telemetry_put_u16(p, rec[i].arg);
+        }
+
+        /* Overwritten records stay skipped; the rest is resent */
+        *cursor = next - count;
+        if (!telemetry_send(TELEMETRY_TYPE_TRACE, payload, (uint8_t)(p - payload))) {
+            return false;
+        }
+        *cursor = next;
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+/*
+ * Telemetry over UART0
+ *
+ * Framed binary packets, little-endian payloads:
+ *
+ *   0xA5 0x5A | type | len | payload[len] | xor of type, len, payload
+ *
+ * Packets are queued in the UART transmit buffer and dropped whole if
+ * it is full, so telemetry never stalls the frame loop. Decode with
+ * tools/telemetry_decode.py.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "avian_radar.h"
+#include "trace.h"
+#include "supervisor.h"
+
+#define TELEMETRY_SYNC0         0xA5
+#define TELEMETRY_SYNC1         0x5A
+#define TELEMETRY_MAX_PAYLOAD   255
+
+/* Packet types */
+#define TELEMETRY_TYPE_STATUS   0x01
+#define TELEMETRY_TYPE_LINK     0x02    /* SPI link training result (radar_link_t) */
+#define TELEMETRY_TYPE_TRACE    0x03    /* Sequence number + trace records (trace.h) */
+#define TELEMETRY_TYPE_SUPERVISOR 0x04  /* Degradation level and overrun counters (supervisor_t) */
+
+#define TELEMETRY_TRACE_RECORDS     31  /* Records per trace packet */
+#define TELEMETRY_TRACE_PACKETS     2   /* Trace packets per call, leaves room for status */
+
+/* Per-frame status (TELEMETRY_TYPE_STATUS) */
+typedef struct {
+    uint32_t frame;             /* Frame counter */
+    bool presence;
+    bool waving;
+    uint8_t max_idx;            /* Strongest range bin */
+    uint8_t occupancy;          /* Smoothed people count */
+    uint8_t wave_class;
+    uint8_t gesture;            /* Last classified gesture_class_t */
+    uint8_t gesture_seq;        /* Changes when a new gesture was classified */
+    uint8_t breathing_bpm;      /* 0 when vital signs are not valid */
+    uint8_t heart_bpm;
+    uint8_t zones;              /* Occupied zone mask (zones.h) */
+} telemetry_status_t;
+
+/*
+ * Initialize UART link
+ */
+void telemetry_init(void);
+
+/*
+ * Send one packet; returns false if it was dropped
+ */
+bool telemetry_send(uint8_t type, const uint8_t *payload, uint8_t len);
+
+/*
+ * Send a status packet
+ */
+bool telemetry_send_status(const telemetry_status_t *status);
+
+/*
+ * Send the SPI link setting and error counters
+ */
+bool telemetry_send_link(const radar_link_t *link);
+
+/*
+ * Send the supervisor level, overrun counters and worst-case times (us)
+ */
+bool telemetry_send_supervisor(const supervisor_t *sup);
+
+/*
+ * Send trace records from sequence number *cursor on, advancing it past
+ * the records sent. Returns false if a packet was dropped (resent on
+ * the next call).
+ */
+bool telemetry_send_trace(uint32_t *cursor);
+
+/*
+ * Little-endian serialization helpers; return the advanced pointer
+ */
+uint8_t *telemetry_put_u16(uint8_t *p, uint16_t v);
+uint8_t *telemetry_put_u32(uint8_t *p, uint32_t v);
+
+#endif /* TELEMETRY_H */
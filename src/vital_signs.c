@@ -0,0 +1,240 @@
+/*
+ * Vital Sign Extraction Implementation
+ *
+ * Per frame (cheap): phase of target bin, unwrap, two biquad cascades,
+ * VS_BINS_PER_FRAME Goertzel evaluations of VS_HISTORY samples each.
+ * A full sweep of all candidates takes VS_NUM_CANDIDATES /
+ * VS_BINS_PER_FRAME frames (~1.2 s at 13 Hz); each candidate sees the
+ * ring as it was when evaluated.
+ */
+
+#include "vital_signs.h"
+#include <string.h>
+#include <math.h>
+
+/* CMSIS DF1 coefficients {b0, b1, b2, -a1, -a2} normalized by a0 (RBJ cookbook) */
+static void design_biquad(float *coeffs, float f0, float fs, bool highpass)
+{
+    const float q = 0.7071f;  /* Butterworth */
+    float w0 = 2.0f * PI * f0 / fs;
+    float cos_w = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+    float a0 = 1.0f + alpha;
+    float b1 = highpass ? -(1.0f + cos_w) : (1.0f - cos_w);
+    float b0 = (highpass ? -b1 : b1) * 0.5f;
+
+    coeffs[0] = b0 / a0;
+    coeffs[1] = b1 / a0;
+    coeffs[2] = b0 / a0;
+    coeffs[3] = 2.0f * cos_w / a0;
+    coeffs[4] = -(1.0f - alpha) / a0;
+}
+
+/* Band-pass as high-pass stage followed by low-pass stage */
+static void design_band(float *coeffs, float f_low, float f_high, float fs)
+{
+    float f_max = 0.45f * fs;  /* Keep the low-pass below Nyquist */
+
+    design_biquad(&coeffs[0], f_low, fs, true);
+    design_biquad(&coeffs[5], f_high < f_max ? f_high : f_max, fs, false);
+}
+
+/* Clear tracking history (filters, rings, sweep) */
+static void vital_signs_reset(vital_signs_t *vs)
+{
+    vs->locked = false;
+    vs->candidate_frames = 0;
+    vs->unwrapped_phase = 0.0f;
+    vs->head = 0;
+    vs->count = 0;
+    vs->sweep_pos = 0;
+    vs->valid = false;
+    memset(vs->breath_state, 0, sizeof(vs->breath_state));
+    memset(vs->heart_state, 0, sizeof(vs->heart_state));
+}
+
+void vital_signs_init(vital_signs_t *vs, uint32_t frame_period_ms)
+{
+    memset(vs, 0, sizeof(vital_signs_t));
+    vs->frame_rate_hz = 1000.0f / (float)frame_period_ms;
+
+    design_band(vs->breath_coeffs, VS_BREATH_MIN_HZ, VS_BREATH_MAX_HZ, vs->frame_rate_hz);
+    design_band(vs->heart_coeffs, VS_HEART_MIN_HZ, VS_HEART_MAX_HZ, vs->frame_rate_hz);
+
+    arm_biquad_cascade_df1_init_f32(&vs->breath_filter, VS_BIQUAD_STAGES,
+                                    vs->breath_coeffs, vs->breath_state);
+    arm_biquad_cascade_df1_init_f32(&vs->heart_filter, VS_BIQUAD_STAGES,
+                                    vs->heart_coeffs, vs->heart_state);
+
+    for (int k = 0; k < VS_NUM_CANDIDATES; k++) {
+        float f = (k < VS_BREATH_BINS) ?
+                  VS_BREATH_MIN_HZ + VS_BREATH_STEP_HZ * (float)k :
+                  VS_HEART_MIN_HZ + VS_HEART_STEP_HZ * (float)(k - VS_BREATH_BINS);
+        vs->candidate_coeff[k] = 2.0f * cosf(2.0f * PI * f / vs->frame_rate_hz);
+    }
+
+    vital_signs_reset(vs);
+}
+
+/*
+ * Keep the unwrapped phase small enough for float precision.
+ * Subtracting a constant from the phase ring and the first-stage input
+ * history leaves the high-pass output (and everything after it) unchanged.
+ */
+static void rebase_phase(vital_signs_t *vs)
+{
+    float offset = vs->unwrapped_phase;
+
+    vs->unwrapped_phase = 0.0f;
+    for (int i = 0; i < VS_HISTORY; i++) {
+        vs->phase[i] -= offset;
+    }
+
+    /* DF1 state per stage: x[n-1], x[n-2], y[n-1], y[n-2] */
+    vs->breath_state[0] -= offset;
+    vs->breath_state[1] -= offset;
+    vs->heart_state[0] -= offset;
+    vs->heart_state[1] -= offset;
+}
+
+/* Goertzel power of the ring at one candidate frequency */
+static float ring_power(const float *ring, uint32_t head, float coeff)
+{
+    float s1 = 0.0f;
+    float s2 = 0.0f;
+
+    for (int n = 0; n < VS_HISTORY; n++) {
+        float s0 = ring[(head + n) & (VS_HISTORY - 1)] + coeff * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+
+    return s1 * s1 + s2 * s2 - coeff * s1 * s2;
+}
+
+/* Peak candidate in [first, first + n): returns frequency, writes SNR */
+static float find_peak(const float *power, int first, int n,
+                       float f_min, float f_step, float *snr)
+{
+    int best = 0;
+    float sum = 0.0f;
+
+    for (int k = 0; k < n; k++) {
+        sum += power[first + k];
+        if (power[first + k] > power[first + best]) {
+            best = k;
+        }
+    }
+
+    float mean = sum / (float)n;
+    *snr = (mean > 0.0f) ? power[first + best] / mean : 0.0f;
+
+    /* Parabolic interpolation between neighbouring candidates */
+    float offset = 0.0f;
+    if (best > 0 && best < n - 1) {
+        float a = power[first + best - 1];
+        float b = power[first + best];
+        float c = power[first + best + 1];
+        float denom = a - 2.0f * b + c;
+        if (denom < 0.0f) {
+            offset = 0.5f * (a - c) / denom;
+        }
+    }
+
+    return f_min + f_step * ((float)best + offset);
+}
+
+/* Evaluate the next few candidates; publish rates when a sweep completes */
+static void spectral_step(vital_signs_t *vs)
+{
+    for (int n = 0; n < VS_BINS_PER_FRAME; n++) {
+        uint32_t k = vs->sweep_pos;
+        const float *ring = (k < VS_BREATH_BINS) ? vs->breath : vs->heart;
+
+        vs->candidate_power[k] = ring_power(ring, vs->head, vs->candidate_coeff[k]);
+
+        if (++vs->sweep_pos >= VS_NUM_CANDIDATES) {
+            vs->sweep_pos = 0;
+
+            vs->breathing_bpm = 60.0f * find_peak(vs->candidate_power, 0, VS_BREATH_BINS,
+                                                  VS_BREATH_MIN_HZ, VS_BREATH_STEP_HZ,
+                                                  &vs->breathing_snr);
+            vs->heart_bpm = 60.0f * find_peak(vs->candidate_power, VS_BREATH_BINS, VS_HEART_BINS,
+                                              VS_HEART_MIN_HZ, VS_HEART_STEP_HZ,
+                                              &vs->heart_snr);
+            vs->valid = true;
+            break;
+        }
+    }
+}
+
+void vital_signs_update(vital_signs_t *vs, const presence_ctx_t *presence)
+{
+    if (!presence->presence_detected) {
+        if (vs->locked) {
+            vital_signs_reset(vs);
+        }
+        return;
+    }
+
+    /* Lost frames: the phase step can't be unwrapped and the filters and
+     * rings would run on a shortened time axis; relock on this frame */
+    if (presence->frame_gap > 0 && vs->locked) {
+        vital_signs_reset(vs);
+    }
+
+    uint8_t bin = presence->max_idx;
+
+    /* Relock only if the target stays on another bin (not +-1 jitter) */
+    if (vs->locked && (bin > vs->target_bin + 1 || bin + 1 < vs->target_bin)) {
+        if (bin == vs->candidate_bin) {
+            vs->candidate_frames++;
+        } else {
+            vs->candidate_bin = bin;
+            vs->candidate_frames = 1;
+        }
+        if (vs->candidate_frames >= VS_RELOCK_FRAMES) {
+            vital_signs_reset(vs);
+        }
+    } else {
+        vs->candidate_frames = 0;
+    }
+
+    const float *x = &presence->spectrum[2 * (vs->locked ? vs->target_bin : bin)];
+    float phase = atan2f(x[1], x[0]);
+
+    if (!vs->locked) {
+        vs->target_bin = bin;
+        vs->last_phase = phase;
+        vs->locked = true;
+        return;
+    }
+
+    /* Unwrap: fold the frame-to-frame step into [-pi, pi] */
+    float d = phase - vs->last_phase;
+    if (d > PI) {
+        d -= 2.0f * PI;
+    } else if (d < -PI) {
+        d += 2.0f * PI;
+    }
+    vs->last_phase = phase;
+    vs->unwrapped_phase += d;
+
+    if (fabsf(vs->unwrapped_phase) > VS_PHASE_REBASE) {
+        rebase_phase(vs);
+    }
+
+    /* Append to rings (head = oldest, overwritten first) */
+    uint32_t idx = vs->head;
+    vs->phase[idx] = vs->unwrapped_phase;
+    arm_biquad_cascade_df1_f32(&vs->breath_filter, &vs->phase[idx], &vs->breath[idx], 1);
+    arm_biquad_cascade_df1_f32(&vs->heart_filter, &vs->phase[idx], &vs->heart[idx], 1);
+    vs->head = (idx + 1) & (VS_HISTORY - 1);
+
+    if (vs->count < VS_HISTORY) {
+        vs->count++;
+        return;
+    }
+
+    spectral_step(vs);
+}
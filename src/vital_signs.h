@@ -0,0 +1,89 @@
+/*
+ * Vital Sign Extraction (breathing / heart rate)
+ *
+ * Locks onto the presence target range bin, tracks the bin's phase
+ * across frames, unwraps it and band-pass filters it into breathing
+ * and heart bands (CMSIS-DSP biquad cascades). Rates come from a
+ * Goertzel power sweep over candidate frequencies, spread over frames
+ * (VS_BINS_PER_FRAME per frame) instead of one large spectral step.
+ *
+ * Memory: 3 rings of VS_HISTORY floats (3 KB) plus a few hundred bytes.
+ */
+
+#ifndef VITAL_SIGNS_H
+#define VITAL_SIGNS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "presence_detection.h"
+#include "arm_math.h"
+
+#define VS_HISTORY              256     /* Frames kept (~20 s at 13 Hz), power of 2 */
+#define VS_RELOCK_FRAMES        8       /* Frames on another bin before relocking */
+#define VS_BINS_PER_FRAME       4       /* Spectral candidates evaluated per frame */
+
+/* Search bands (Hz) and candidate spacing */
+#define VS_BREATH_MIN_HZ        0.1f
+#define VS_BREATH_MAX_HZ        0.6f
+#define VS_BREATH_STEP_HZ       0.02f
+#define VS_BREATH_BINS          26
+#define VS_HEART_MIN_HZ         0.8f
+#define VS_HEART_MAX_HZ         2.5f
+#define VS_HEART_STEP_HZ        0.05f
+#define VS_HEART_BINS           35
+#define VS_NUM_CANDIDATES       (VS_BREATH_BINS + VS_HEART_BINS)
+
+#define VS_BIQUAD_STAGES        2       /* High-pass (stage 0) + low-pass per band */
+#define VS_PHASE_REBASE         4096.0f /* Rebase unwrapped phase beyond this (rad) */
+
+typedef struct {
+    /* Target tracking */
+    uint8_t target_bin;
+    bool locked;
+    uint8_t candidate_bin;
+    uint8_t candidate_frames;
+    float last_phase;                   /* Wrapped phase of previous frame */
+    float unwrapped_phase;
+
+    /* History rings (oldest at head once full) */
+    float phase[VS_HISTORY];            /* Unwrapped phase (rad) */
+    float breath[VS_HISTORY];           /* Breathing band output */
+    float heart[VS_HISTORY];            /* Heart band output */
+    uint32_t head;
+    uint32_t count;
+
+    /* Band-pass filters */
+    arm_biquad_casd_df1_inst_f32 breath_filter;
+    arm_biquad_casd_df1_inst_f32 heart_filter;
+    float breath_coeffs[5 * VS_BIQUAD_STAGES];
+    float heart_coeffs[5 * VS_BIQUAD_STAGES];
+    float breath_state[4 * VS_BIQUAD_STAGES];
+    float heart_state[4 * VS_BIQUAD_STAGES];
+
+    /* Incremental spectral sweep */
+    float frame_rate_hz;
+    float candidate_coeff[VS_NUM_CANDIDATES];   /* Goertzel 2cos(w) */
+    float candidate_power[VS_NUM_CANDIDATES];
+    uint32_t sweep_pos;
+
+    /* Results */
+    float breathing_bpm;
+    float heart_bpm;
+    float breathing_snr;                /* Peak / mean candidate power */
+    float heart_snr;
+    bool valid;                         /* At least one full sweep on a full ring */
+} vital_signs_t;
+
+/*
+ * Initialize for the given frame period (designs the filters)
+ */
+void vital_signs_init(vital_signs_t *vs, uint32_t frame_period_ms);
+
+/*
+ * Update with one frame; call after presence_update() when
+ * presence->full_evaluated. Resets when presence is lost or frames
+ * were lost before this one (presence->frame_gap).
+ */
+void vital_signs_update(vital_signs_t *vs, const presence_ctx_t *presence);
+
+#endif /* VITAL_SIGNS_H */
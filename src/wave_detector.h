@@ -13,7 +13,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-#define WAVE_WINDOW_SIZE 16
+#define WAVE_WINDOW_SIZE 16     /* Must be a power of 2 (ring indexing) */
 #define WAVE_NUM_CLASSES 2
 
 /* Normalization constants (from training data) */
@@ -44,6 +44,23 @@ typedef struct {
  */
 bool wave_detect(const float* energy_window, wave_result_t* result);
 
+/*
+ * Run wave detection with the int8 quantized model
+ * Same input/output contract as wave_detect(). Uses SMLAD dot products
+ * on Cortex-M7 and a lookup-table softmax (no expf).
+ * Scores are accurate to ~1e-3; argmax matches the float model except
+ * on near-ties.
+ */
+bool wave_detect_q8(const float* energy_window, wave_result_t* result);
+
+/*
+ * Int8 inference on a circular window
+ * ring: WAVE_WINDOW_SIZE values, oldest at index head (wraps around)
+ * Equivalent to wave_detect_q8() on the unrolled window, without
+ * shifting or copying the ring.
+ */
+bool wave_detect_q8_ring(const float* ring, uint32_t head, wave_result_t* result);
+
 /*
  * Get class name
  */
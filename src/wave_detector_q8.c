@@ -0,0 +1,179 @@
+/*
+ * Wave Detection - Int8 Quantized Implementation
+ *
+ * Same network as wave_detector.c with int8 weights and activations.
+ * Dot products use the Cortex-M7 SMLAD dual 16-bit MAC (4 int8 MACs
+ * per 2 instructions after SXTB16 sign extension). A portable C loop
+ * is used on targets without the DSP extension (host builds).
+ *
+ * Tables generated by tools/quantize_wave_model.py
+ */
+
+#include "wave_detector.h"
+#include <string.h>
+
+#if defined(__ARM_FEATURE_DSP)
+#include <arm_acle.h>
+#endif
+
+/* Layer 1: scale_w=0.00438023 scale_out=0.01689411 */
+static const int8_t q_w1[8][16] = {
+    {75, -92, 43, 60, 49, -71, -107, -87, 61, -32, 12, -31, -40, 75, -34, -118},
+    {-6, -10, -51, 97, 105, 111, 86, -16, -85, 73, -20, -52, 48, -8, 14, -29},
+    {69, -51, -84, 51, -93, 3, 50, 13, 54, 16, 59, 40, -23, 103, 45, 113},
+    {-27, 25, -110, 98, 9, 82, -57, -87, 57, 16, 10, -93, 84, 45, -22, 52},
+    {10, -94, 77, 99, 110, 30, 44, -101, -13, 66, 127, 103, 112, -51, 3, -42},
+    {-30, -36, 10, -19, 95, -58, -5, 82, -90, 65, 52, -44, 73, 117, -19, 69},
+    {-73, 47, -78, 34, 110, -92, -10, -44, -26, 1, 99, 99, -41, 112, 81, -49},
+    {-83, -48, 115, -42, -55, -118, -1, -16, -119, -84, -14, 105, 67, -42, 76, 67},
+};
+static const int32_t q_b1[8] = {2995, -1715, -1202, 2960, -1451, -878, -310, 36};
+#define Q_L1_MULT  1122348452L
+#define Q_L1_SHIFT 8
+
+/* Layer 2: scale_w=0.00577499 scale_out=0.00580454 */
+static const int8_t q_w2[4][8] = {
+    {102, 24, 9, -24, -127, 57, -110, 24},
+    {122, -23, -60, 109, -79, -70, -38, -7},
+    {95, -109, -19, -103, -4, 67, -18, 25},
+    {3, -73, 53, -107, -62, 41, 86, -18},
+};
+static const int32_t q_b2[4] = {-742, 1050, -169, 571};
+#define Q_L2_MULT  1155044020L
+#define Q_L2_SHIFT 5
+
+/* Layer 3: scale_w=0.00706804 (logits stay in the int32 accumulator) */
+static const int8_t q_w3[2][4] = {
+    {121, 127, 41, -117},
+    {-13, -121, 74, -17},
+};
+static const int32_t q_b3[2] = {-14, 14};
+#define Q_LOGIT_SCALE 4.1026738794e-05f
+
+/* exp(-x) for x = 0, 0.25, ... 8.0 (linear interpolation between entries) */
+#define EXP_LUT_STEP_INV    4.0f
+#define EXP_LUT_SIZE        33
+static const float exp_neg_lut[EXP_LUT_SIZE] = {
+    1.00000000f, 0.77880078f, 0.60653066f, 0.47236655f, 0.36787944f,
+    0.28650480f, 0.22313016f, 0.17377394f, 0.13533528f, 0.10539922f,
+    0.08208500f, 0.06392786f, 0.04978707f, 0.03877421f, 0.03019738f,
+    0.02351775f, 0.01831564f, 0.01426423f, 0.01110900f, 0.00865170f,
+    0.00673795f, 0.00524752f, 0.00408677f, 0.00318278f, 0.00247875f,
+    0.00193045f, 0.00150344f, 0.00117088f, 0.00091188f, 0.00071017f,
+    0.00055308f, 0.00043074f, 0.00033546f
+};
+
+/* Approximate exp(-x) for x >= 0 without calling expf */
+static inline float exp_neg_approx(float x)
+{
+    float pos = x * EXP_LUT_STEP_INV;
+    if (pos >= (float)(EXP_LUT_SIZE - 1)) {
+        return 0.0f;
+    }
+    int idx = (int)pos;
+    float frac = pos - (float)idx;
+    return exp_neg_lut[idx] + (exp_neg_lut[idx + 1] - exp_neg_lut[idx]) * frac;
+}
+
+/* int8 dot product accumulated into acc, n must be a multiple of 4 */
+static inline int32_t dot_q7(const int8_t *a, const int8_t *b, int n, int32_t acc)
+{
+#if defined(__ARM_FEATURE_DSP)
+    for (int i = 0; i < n; i += 4) {
+        int32_t va, vb;
+        memcpy(&va, &a[i], 4);
+        memcpy(&vb, &b[i], 4);
+
+        /* Sign-extend bytes 0,2 and 1,3 into 16-bit lanes, then dual MAC */
+        acc = __smlad(__sxtb16(va), __sxtb16(vb), acc);
+        acc = __smlad(__sxtb16(__ror(va, 8)), __sxtb16(__ror(vb, 8)), acc);
+    }
+#else
+    for (int i = 0; i < n; i++) {
+        acc += (int32_t)a[i] * (int32_t)b[i];
+    }
+#endif
+    return acc;
+}
+
+/* Requantize accumulator to int8 with ReLU: (acc * mult) >> (31 + shift) */
+static inline int8_t requant_relu(int32_t acc, int32_t mult, int shift)
+{
+    if (acc <= 0) {
+        return 0;
+    }
+    int64_t prod = (int64_t)acc * mult;
+    int total_shift = 31 + shift;
+    int32_t out = (int32_t)((prod + ((int64_t)1 << (total_shift - 1))) >> total_shift);
+    return (int8_t)(out > 127 ? 127 : out);
+}
+
+/* Quantize a normalized 0-1 input to int8 (scale 1/127) */
+static inline int8_t quant_input(float x)
+{
+    float q = x * 127.0f;
+    if (q >= 127.0f) return 127;
+    if (q <= -128.0f) return -128;
+    return (int8_t)(q >= 0.0f ? q + 0.5f : q - 0.5f);
+}
+
+
+bool wave_detect_q8(const float* input, wave_result_t* result)
+{
+    return wave_detect_q8_ring(input, 0, result);
+}
+
+
+bool wave_detect_q8_ring(const float* input, uint32_t head, wave_result_t* result)
+{
+    if (!input || !result) {
+        return false;
+    }
+
+    int8_t in_q[WAVE_WINDOW_SIZE];
+    int8_t layer1[8];
+    int8_t layer2[4];
+    int32_t logits[WAVE_NUM_CLASSES];
+
+    /* Quantization also unrolls the ring into time order */
+    for (int i = 0; i < WAVE_WINDOW_SIZE; i++) {
+        in_q[i] = quant_input(input[(head + i) & (WAVE_WINDOW_SIZE - 1)]);
+    }
+
+    /* Layer 1: Dense(16->8) + ReLU */
+    for (int j = 0; j < 8; j++) {
+        layer1[j] = requant_relu(dot_q7(in_q, q_w1[j], 16, q_b1[j]), Q_L1_MULT, Q_L1_SHIFT);
+    }
+
+    /* Layer 2: Dense(8->4) + ReLU */
+    for (int j = 0; j < 4; j++) {
+        layer2[j] = requant_relu(dot_q7(layer1, q_w2[j], 8, q_b2[j]), Q_L2_MULT, Q_L2_SHIFT);
+    }
+
+    /* Layer 3: Dense(4->2), logits stay int32 */
+    int best = 0;
+    for (int j = 0; j < WAVE_NUM_CLASSES; j++) {
+        logits[j] = dot_q7(layer2, q_w3[j], 4, q_b3[j]);
+        if (logits[j] > logits[best]) {
+            best = j;
+        }
+    }
+
+    /* Softmax relative to the winning logit: exp(l_best - l_best) = 1 */
+    float sum_exp = 0.0f;
+    for (int j = 0; j < WAVE_NUM_CLASSES; j++) {
+        float d = (float)(logits[best] - logits[j]) * Q_LOGIT_SCALE;
+        result->scores[j] = exp_neg_approx(d);
+        sum_exp += result->scores[j];
+    }
+
+    float inv_sum = 1.0f / sum_exp;
+    for (int j = 0; j < WAVE_NUM_CLASSES; j++) {
+        result->scores[j] *= inv_sum;
+    }
+
+    result->predicted_class = (wave_class_t)best;
+    result->confidence = result->scores[best];
+    result->valid = true;
+    return true;
+}
@@ -0,0 +1,71 @@
+/*
+ * Streaming Feature Extraction for Wave Detection
+ *
+ * Energy per frame is the sum of the range FFT magnitude over the
+ * configured detection bins (ctx->bins), reusing presence_detect()'s spectrum instead of
+ * reading the raw frame again.
+ */
+
+#include "wave_features.h"
+#include "trace.h"
+#include <string.h>
+#include <math.h>
+
+void wave_features_init(wave_features_t *wf, uint32_t stride)
+{
+    memset(wf, 0, sizeof(wave_features_t));
+    wf->stride = stride ? stride : 1;
+}
+
+/*
+ * Per-frame energy from the range profile, normalized to 0-1
+ * Power / log2 domains keep |X|^2: the magnitude sum is taken as
+ * sqrt(n * sum |X|^2) (n x RMS magnitude, equal for a flat profile),
+ * one sqrt per frame instead of one per bin
+ */
+static float frame_energy(const presence_ctx_t *presence)
+{
+    float sum = 0.0f;
+    int n = presence->num_bins;
+
+    /* Configured bins only: sparse mode leaves the others stale */
+    for (int b = 0; b < n; b++) {
+        sum += presence->range_profile[presence->bins[b]];
+    }
+    if (presence->domain != PRESENCE_DOMAIN_LINEAR) {
+        sum = sqrtf((float)n * sum);
+    }
+
+    float norm = WAVE_NORMALIZE(sum * WAVE_ENERGY_SCALE);
+    if (norm < 0.0f) norm = 0.0f;
+    if (norm > 1.0f) norm = 1.0f;
+    return norm;
+}
+
+bool wave_features_update(wave_features_t *wf, const presence_ctx_t *presence)
+{
+    /* No range profile until presence_detect() has processed a frame */
+    if (presence->first_run) {
+        return false;
+    }
+
+    /* Overwrite oldest value; head then points at the new oldest */
+    wf->window[wf->head] = frame_energy(presence);
+    wf->head = (wf->head + 1) & (WAVE_WINDOW_SIZE - 1);
+
+    if (wf->count < WAVE_WINDOW_SIZE) {
+        wf->count++;
+    }
+    wf->pending++;
+
+    /* Run only on a full window with `stride` new frames */
+    if (wf->count < WAVE_WINDOW_SIZE || wf->pending < wf->stride) {
+        return false;
+    }
+
+    wf->pending = 0;
+    trace_begin(TRACE_CLASSIFIER, 0);
+    bool waving = wave_detect_q8_ring(wf->window, wf->head, &wf->result);
+    trace_end(TRACE_CLASSIFIER, (uint16_t)wf->result.predicted_class);
+    return waving;
+}
@@ -0,0 +1,44 @@
+/*
+ * Streaming Feature Extraction for Wave Detection
+ *
+ * Derives one energy value per frame from the range profile computed
+ * by presence_detect() and keeps the last WAVE_WINDOW_SIZE values in a
+ * circular window. Inference runs every `stride` new frames once the
+ * window is full.
+ */
+
+#ifndef WAVE_FEATURES_H
+#define WAVE_FEATURES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "presence_detection.h"
+#include "wave_detector.h"
+#include "wave_model.h"         /* WAVE_ENERGY_SCALE (tools/quantize_wave_model.py) */
+
+/* Default frames between inferences (1 = every frame) */
+#define WAVE_FEATURE_STRIDE     4
+
+typedef struct {
+    float window[WAVE_WINDOW_SIZE];  /* Normalized energies (ring) */
+    uint32_t head;                   /* Index of oldest value */
+    uint32_t count;                  /* Values in window (saturates) */
+    uint32_t stride;                 /* Frames between inferences */
+    uint32_t pending;                /* New frames since last inference */
+    wave_result_t result;            /* Last inference result */
+} wave_features_t;
+
+/*
+ * Initialize feature window
+ * stride: frames between inferences (0 is treated as 1)
+ */
+void wave_features_init(wave_features_t *wf, uint32_t stride);
+
+/*
+ * Push one frame's energy from the presence range profile
+ * Call after presence_detect() on the same frame
+ * Returns true if inference ran (wf->result updated)
+ */
+bool wave_features_update(wave_features_t *wf, const presence_ctx_t *presence);
+
+#endif /* WAVE_FEATURES_H */
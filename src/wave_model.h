@@ -0,0 +1,18 @@
+/*
+ * Wave Detection - Feature Scale
+ *
+ * Generated by tools/quantize_wave_model.py from the training feature
+ * normalisation; do not edit, re-run the script after retraining.
+ */
+
+#ifndef WAVE_MODEL_H
+#define WAVE_MODEL_H
+
+/*
+ * Summed range-bin magnitude of presence_detect()'s profile to the raw
+ * energy units of training (WAVE_NORM_MIN..WAVE_NORM_MAX): training
+ * sample scale 1 / firmware window sample scale 3.051757812e-05
+ */
+#define WAVE_ENERGY_SCALE       32768.0f
+
+#endif /* WAVE_MODEL_H */
@@ -0,0 +1,138 @@
+/*
+ * Multi-Zone Presence Implementation
+ *
+ * Per frame: one pass over the configured presence bins. Each bin's
+ * fast - slow difference is compared with the threshold of every zone
+ * in its mask (zone threshold, or the calibrated bin threshold), and
+ * the largest excess per zone is kept. Hold times then stretch the
+ * detections into the occupied flags.
+ */
+
+#include "zones.h"
+#include "avian_registers.h"
+#include <string.h>
+#include <math.h>
+
+float zones_bin_spacing_m(const zones_profile_t *profile)
+{
+    float bandwidth = (float)profile->bandwidth_hz;
+
+    /* Bandwidth swept while the samples are taken */
+    if (profile->ramp_time_ns > 0 && profile->sample_rate_hz > 0) {
+        float sampling_ns = (float)RADAR_NUM_SAMPLES * 1e9f / (float)profile->sample_rate_hz;
+        bandwidth *= sampling_ns / (float)profile->ramp_time_ns;
+    }
+
+    return ZONES_SPEED_OF_LIGHT / (2.0f * bandwidth);
+}
+
+void zones_init(zones_t *zones, const zones_profile_t *profile, uint32_t frame_period_ms)
+{
+    static const zones_profile_t default_profile = {
+        .bandwidth_hz = AVIAN_BANDWIDTH_HZ,
+        .sample_rate_hz = AVIAN_SAMPLE_RATE_HZ,
+        .ramp_time_ns = 0,
+    };
+
+    memset(zones, 0, sizeof(*zones));
+    zones->bin_spacing_m = zones_bin_spacing_m(profile ? profile : &default_profile);
+    zones->frame_period_ms = frame_period_ms;
+}
+
+/* First bin whose centre range is >= range_m */
+static int range_to_bin(const zones_t *zones, float range_m)
+{
+    int bin = (int)ceilf(range_m / zones->bin_spacing_m);
+    if (bin < 1) bin = 1;                                   /* Bin 0 is DC */
+    if (bin > RADAR_NUM_SAMPLES / 2) bin = RADAR_NUM_SAMPLES / 2;
+    return bin;
+}
+
+bool zones_add(zones_t *zones, const zone_config_t *cfg)
+{
+    if (zones->num_zones >= ZONES_MAX || cfg->end_m <= cfg->start_m ||
+        cfg->start_m >= zones->bin_spacing_m * (float)(RADAR_NUM_SAMPLES / 2)) {
+        return false;
+    }
+
+    /* Bins with centres in [start, end): adjacent zones share no bin */
+    int first = range_to_bin(zones, cfg->start_m);
+    int last = range_to_bin(zones, cfg->end_m) - 1;
+    if (last < first) {
+        return false;
+    }
+
+    uint8_t z = zones->num_zones++;
+    zone_t *zone = &zones->zone[z];
+    memset(zone, 0, sizeof(*zone));
+    zone->cfg = *cfg;
+    zone->first_bin = (uint8_t)first;
+    zone->last_bin = (uint8_t)last;
+
+    for (int i = first; i <= last; i++) {
+        zones->bin_mask[i] |= (uint8_t)(1u << z);
+    }
+    return true;
+}
+
+void zones_set_frame_period(zones_t *zones, uint32_t frame_period_ms)
+{
+    zones->frame_period_ms = frame_period_ms;
+}
+
+uint8_t zones_update(zones_t *zones, const presence_ctx_t *presence)
+{
+    if (presence->full_evaluated) {
+        for (int z = 0; z < zones->num_zones; z++) {
+            zones->zone[z].max_excess = -1e30f;
+        }
+
+        /* Single sweep over the difference array */
+        for (int b = 0; b < presence->num_bins; b++) {
+            int i = presence->bins[b];
+            uint32_t mask = zones->bin_mask[i];
+            if (mask == 0) {
+                continue;
+            }
+
+            float diff = presence->fast_avg[i] - presence->slow_avg[i];
+            do {
+                int z = __builtin_ctz(mask);
+                zone_t *zone = &zones->zone[z];
+                float th = zone->cfg.threshold > 0.0f ? zone->cfg.threshold : presence->bin_threshold[i];
+                float excess = diff - th;
+                if (excess > zone->max_excess) {
+                    zone->max_excess = excess;
+                    zone->max_idx = (uint8_t)i;
+                }
+                mask &= mask - 1;
+            } while (mask);
+        }
+
+        for (int z = 0; z < zones->num_zones; z++) {
+            zones->zone[z].detected = (zones->zone[z].max_excess > 0.0f);
+        }
+    }
+
+    /* Hold times */
+    uint8_t occupied_mask = 0;
+    for (int z = 0; z < zones->num_zones; z++) {
+        zone_t *zone = &zones->zone[z];
+        if (zone->detected) {
+            zone->hold_left_ms = zone->cfg.hold_ms;
+            zone->occupied = true;
+        } else if (zone->hold_left_ms > zones->frame_period_ms) {
+            zone->hold_left_ms -= zones->frame_period_ms;
+        } else {
+            zone->hold_left_ms = 0;
+            zone->occupied = false;
+        }
+
+        if (zone->occupied) {
+            occupied_mask |= (uint8_t)(1u << z);
+        }
+    }
+
+    zones->occupied_mask = occupied_mask;
+    return occupied_mask;
+}
@@ -0,0 +1,91 @@
+/*
+ * Multi-Zone Presence
+ *
+ * Range zones (e.g. desk, doorway, bed) defined in metres, each with
+ * its own threshold and hold time, on top of the presence pipeline.
+ * Zone limits are converted to range bins once from the chirp profile;
+ * every frame all zones are evaluated in a single sweep over the
+ * fast - slow difference of the configured presence bins (a per-bin
+ * zone mask, so zones may overlap).
+ *
+ * Only bins configured in presence_set_bins() carry averages; zone
+ * bins outside that set are never detected.
+ */
+
+#ifndef ZONES_H
+#define ZONES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "presence_detection.h"
+
+#define ZONES_MAX               8       /* Bits of the occupied mask */
+#define ZONES_SPEED_OF_LIGHT    299792458.0f
+
+/* Chirp profile the zone limits are converted with */
+typedef struct {
+    uint64_t bandwidth_hz;      /* Swept bandwidth of the ramp */
+    uint32_t sample_rate_hz;    /* ADC sample rate */
+    uint32_t ramp_time_ns;      /* Ramp duration; 0: the samples span the ramp */
+} zones_profile_t;
+
+/* Zone definition */
+typedef struct {
+    const char *name;
+    float start_m;
+    float end_m;
+    float threshold;            /* Domain units; 0: calibrated bin thresholds */
+    uint16_t hold_ms;           /* Stay occupied this long after the last detection */
+} zone_config_t;
+
+typedef struct {
+    zone_config_t cfg;
+    uint8_t first_bin;          /* Inclusive bin range of the zone */
+    uint8_t last_bin;
+    bool detected;              /* Above threshold in the last evaluated frame */
+    bool occupied;              /* detected, stretched by hold_ms */
+    uint32_t hold_left_ms;
+    float max_excess;           /* Largest difference above threshold */
+    uint8_t max_idx;            /* Range bin of max_excess */
+} zone_t;
+
+typedef struct {
+    zone_t zone[ZONES_MAX];
+    uint8_t num_zones;
+    uint8_t bin_mask[RADAR_NUM_SAMPLES / 2];    /* Zones covering each bin */
+    float bin_spacing_m;
+    uint32_t frame_period_ms;
+    uint8_t occupied_mask;      /* Bit z: zone z occupied */
+} zones_t;
+
+/*
+ * Range covered by one FFT bin: c / (2 * B_s), where B_s is the part
+ * of the swept bandwidth covered by the RADAR_NUM_SAMPLES samples.
+ */
+float zones_bin_spacing_m(const zones_profile_t *profile);
+
+/*
+ * Initialize without zones; profile NULL uses the exported register
+ * configuration (AVIAN_BANDWIDTH_HZ, AVIAN_SAMPLE_RATE_HZ)
+ */
+void zones_init(zones_t *zones, const zones_profile_t *profile, uint32_t frame_period_ms);
+
+/*
+ * Add a zone; name must stay valid. Returns false if all ZONES_MAX
+ * zones are used or the range maps to no bin.
+ */
+bool zones_add(zones_t *zones, const zone_config_t *cfg);
+
+/*
+ * Frame period for the hold times (keeps zones and their state)
+ */
+void zones_set_frame_period(zones_t *zones, uint32_t frame_period_ms);
+
+/*
+ * Update with one frame; call after presence_update() on every frame.
+ * Frames that skipped the FFT pipeline keep the last detections.
+ * Returns the occupied mask.
+ */
+uint8_t zones_update(zones_t *zones, const presence_ctx_t *presence);
+
+#endif /* ZONES_H */
@@ -0,0 +1,287 @@
+/*
+ * Equivalence study: linear vs power vs log2 presence pipelines
+ *
+ * Runs the firmware presence_detect() (src/presence_detection.c, host
+ * CMSIS stand-in from tools/host) in all three detection domains on
+ * the same frames and compares the decisions.
+ *
+ * Without arguments a synthetic room is used: residual static clutter,
+ * ADC noise and a person entering/leaving at random ranges and
+ * strengths. A recording is raw little-endian int16 frames of
+ * 64 chirps x 64 samples (as delivered by radar_get_frame()).
+ *
+ * The power/log2 thresholds are converted from THRESHOLD_PRESENCE at
+ * a reference background magnitude B (PRESENCE_REF_MAGNITUDE). The
+ * study sweeps B and reports the agreement with the linear decisions,
+ * so the constant can be re-fitted on recordings.
+ *
+ * Finally the linear pipeline is re-run with per-bin thresholds from
+ * presence_calibrate() over the first CAL_DEFAULT_FRAMES frames (the
+ * synthetic room is empty there) and the false alarms are counted.
+ *
+ * Gain step (synthetic room): halfway through the empty frames the IF
+ * gain goes up 10 dB (samples scaled). Frames tagged with the step
+ * (frame.gain_db) must not detect more than without the step in any
+ * domain; untagged they trigger.
+ *
+ * Usage: build/host/test_presence_domain [recording.bin]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "presence_detection.h"
+
+#define STUDY_CHIRPS        64
+#define STUDY_MAX_FRAMES    4000
+#define SYNTH_FRAMES        2000
+#define MIN_AGREEMENT       0.97f
+#define GAIN_STEP_FRAME     150         /* Within the empty frames */
+#define GAIN_STEP_DB        10
+
+#define FRAME_SAMPLES       (STUDY_CHIRPS * RADAR_NUM_SAMPLES)
+
+static int16_t *recording;
+static int num_frames;
+static bool truth[STUDY_MAX_FRAMES];
+static bool decisions[3][STUDY_MAX_FRAMES];
+static int16_t frame_samples[FRAME_SAMPLES];
+static radar_frame_t frame = { .samples = frame_samples };
+static presence_ctx_t ctx;
+
+static uint32_t seed = 1;
+
+static float rand01(void)
+{
+    seed = seed * 1664525UL + 1013904223UL;
+    return (float)(seed >> 8) / 16777216.0f;
+}
+
+static float randn(void)
+{
+    float u1 = rand01() + 1e-7f;
+    float u2 = rand01();
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+/* Synthetic room; the first 300 frames are empty */
+static void synth_room(void)
+{
+    float target_bin = 0.0f;
+    float target_amp = 0.0f;
+    int segment_left = 300;
+    bool present = false;
+
+    num_frames = SYNTH_FRAMES;
+    recording = malloc(sizeof(int16_t) * FRAME_SAMPLES * SYNTH_FRAMES);
+
+    for (int f = 0; f < num_frames; f++) {
+        if (--segment_left <= 0) {
+            present = !present;
+            segment_left = 150 + (int)(rand01() * 250.0f);
+            target_bin = 9.0f + rand01() * 20.0f;
+            target_amp = 4.0f + rand01() * 40.0f;
+        }
+        truth[f] = present;
+
+        float body_phase = 0.6f * sinf(6.2831853f * 0.25f * (float)f * 0.077f);  /* Breathing */
+        int16_t *out = &recording[(size_t)f * FRAME_SAMPLES];
+
+        for (int c = 0; c < STUDY_CHIRPS; c++) {
+            for (int n = 0; n < RADAR_NUM_SAMPLES; n++) {
+                float x = 6.0f * cosf(6.2831853f * 3.0f * n / 64.0f + 0.4f) +   /* Residual clutter */
+                          3.0f * cosf(6.2831853f * 11.0f * n / 64.0f + 1.1f) +
+                          4.0f * randn();
+                if (present) {
+                    x += target_amp * cosf(6.2831853f * target_bin * n / 64.0f + body_phase);
+                }
+                out[c * RADAR_NUM_SAMPLES + n] = (int16_t)lrintf(x);
+            }
+        }
+    }
+}
+
+static bool load_recording(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        return false;
+    }
+    recording = malloc(sizeof(int16_t) * FRAME_SAMPLES * STUDY_MAX_FRAMES);
+    num_frames = (int)fread(recording, sizeof(int16_t) * FRAME_SAMPLES, STUDY_MAX_FRAMES, fp);
+    fclose(fp);
+    return num_frames > 0;
+}
+
+/* Run one domain over all frames with the given threshold */
+static void run_domain(presence_domain_t domain, float threshold, bool *out)
+{
+    presence_init(&ctx);
+    presence_set_spectrum_mode(&ctx, PRESENCE_SPECTRUM_FULL);
+    presence_set_domain(&ctx, domain);
+    presence_set_threshold(&ctx, threshold);
+    if (threshold <= 0.0f) {
+        presence_calibrate(&ctx, CAL_DEFAULT_FRAMES, CAL_DEFAULT_PFA, false);
+    }
+
+    frame.num_chirps = STUDY_CHIRPS;
+    frame.valid = true;
+
+    for (int f = 0; f < num_frames; f++) {
+        memcpy(frame.samples, &recording[(size_t)f * FRAME_SAMPLES], sizeof(int16_t) * FRAME_SAMPLES);
+        out[f] = presence_detect(&ctx, &frame);
+    }
+}
+
+/* Empty frames with a gain step at GAIN_STEP_FRAME; detections after it */
+static int run_gain_step(presence_domain_t domain, float threshold, bool tagged)
+{
+    float scale = powf(10.0f, GAIN_STEP_DB / 20.0f);
+    int detected = 0;
+
+    presence_init(&ctx);
+    presence_set_spectrum_mode(&ctx, PRESENCE_SPECTRUM_FULL);
+    presence_set_domain(&ctx, domain);
+    presence_set_threshold(&ctx, threshold);
+
+    frame.num_chirps = STUDY_CHIRPS;
+    frame.valid = true;
+
+    for (int f = 0; f < CAL_DEFAULT_FRAMES; f++) {
+        const int16_t *in = &recording[(size_t)f * FRAME_SAMPLES];
+        bool stepped = (f >= GAIN_STEP_FRAME);
+        for (int i = 0; i < FRAME_SAMPLES; i++) {
+            frame.samples[i] = stepped ? (int16_t)lrintf(in[i] * scale) : in[i];
+        }
+        frame.gain_db = (stepped && tagged) ? GAIN_STEP_DB : 0;
+        detected += presence_detect(&ctx, &frame) && stepped;
+    }
+    frame.gain_db = 0;
+    return detected;
+}
+
+static float agreement(const bool *a, const bool *b)
+{
+    int same = 0;
+    for (int f = 0; f < num_frames; f++) {
+        same += (a[f] == b[f]);
+    }
+    return (float)same / (float)num_frames;
+}
+
+static float power_threshold(float b)
+{
+    return (b + THRESHOLD_PRESENCE) * (b + THRESHOLD_PRESENCE) - b * b;
+}
+
+static float log2_threshold(float b)
+{
+    return 2.0f * log2f(1.0f + THRESHOLD_PRESENCE / b);
+}
+
+int main(int argc, char **argv)
+{
+    static bool sweep[STUDY_MAX_FRAMES];
+    static const float refs[] = {0.0001f, 0.0002f, 0.0004f, 0.0008f, 0.0016f};
+    static const char *names[] = {"linear", "power", "log2"};
+    const float thresholds[] = {
+        THRESHOLD_PRESENCE, THRESHOLD_PRESENCE_POWER, THRESHOLD_PRESENCE_LOG2
+    };
+
+    printf("Presence domain equivalence study\n");
+    printf("=================================\n");
+
+    if (argc > 1) {
+        if (!load_recording(argv[1])) {
+            printf("Cannot read %s\n", argv[1]);
+            return 1;
+        }
+        printf("Recording: %s, %d frames\n\n", argv[1], num_frames);
+    } else {
+        synth_room();
+        printf("Synthetic room: %d frames\n\n", num_frames);
+    }
+
+    for (int d = 0; d < 3; d++) {
+        run_domain((presence_domain_t)d, thresholds[d], decisions[d]);
+    }
+
+    printf("Domain   threshold    detections  agree(linear)%s\n", argc > 1 ? "" : "  accuracy");
+    for (int d = 0; d < 3; d++) {
+        int detected = 0;
+        int correct = 0;
+        for (int f = 0; f < num_frames; f++) {
+            detected += decisions[d][f];
+            correct += (decisions[d][f] == truth[f]);
+        }
+        printf("%-8s %-12.4g %-11d %-14.3f", names[d], thresholds[d], detected,
+               agreement(decisions[d], decisions[0]));
+        if (argc <= 1) {
+            printf(" %.3f", (float)correct / (float)num_frames);
+        }
+        printf("\n");
+    }
+
+    printf("\nReference magnitude sweep (PRESENCE_REF_MAGNITUDE = %.4g):\n", PRESENCE_REF_MAGNITUDE);
+    printf("B         power   log2\n");
+    for (unsigned k = 0; k < sizeof(refs) / sizeof(refs[0]); k++) {
+        run_domain(PRESENCE_DOMAIN_POWER, power_threshold(refs[k]), sweep);
+        float a_pow = agreement(sweep, decisions[0]);
+        run_domain(PRESENCE_DOMAIN_LOG2, log2_threshold(refs[k]), sweep);
+        float a_log = agreement(sweep, decisions[0]);
+        printf("%-9.4g %-7.3f %.3f\n", refs[k], a_pow, a_log);
+    }
+
+    /* Calibrated per-bin thresholds (threshold 0: calibrate) */
+    run_domain(PRESENCE_DOMAIN_LINEAR, 0.0f, sweep);
+    int false_alarms[2] = {0, 0};
+    int empty = 0;
+    int correct = 0;
+    for (int f = CAL_DEFAULT_FRAMES; f < num_frames; f++) {
+        if (argc <= 1 && !truth[f]) {
+            empty++;
+            false_alarms[0] += decisions[0][f];
+            false_alarms[1] += sweep[f];
+        }
+        correct += (sweep[f] == truth[f]);
+    }
+    printf("\nCalibrated (%d frames, pfa %.0e): bin thresholds", CAL_DEFAULT_FRAMES, CAL_DEFAULT_PFA);
+    for (int i = 8; i < RADAR_NUM_SAMPLES / 2; i += 8) {
+        printf(" [%d] %.3g", i, ctx.bin_threshold[i]);
+    }
+    printf("\n");
+
+    if (argc > 1) {
+        return 0;
+    }
+
+    float cal_accuracy = (float)correct / (float)(num_frames - CAL_DEFAULT_FRAMES);
+    printf("False alarms on %d empty frames: fixed %d, calibrated %d; accuracy %.3f\n",
+           empty, false_alarms[0], false_alarms[1], cal_accuracy);
+
+    bool ok = agreement(decisions[1], decisions[0]) >= MIN_AGREEMENT &&
+              agreement(decisions[2], decisions[0]) >= MIN_AGREEMENT;
+    bool cal_ok = (false_alarms[1] <= false_alarms[0]) && (cal_accuracy >= MIN_AGREEMENT);
+
+    printf("\nGain step +%d dB on empty frames, detections tagged / untagged:\n ", GAIN_STEP_DB);
+    bool gain_ok = true;
+    for (int d = 0; d < 3; d++) {
+        int tagged = run_gain_step((presence_domain_t)d, thresholds[d], true);
+        int untagged = run_gain_step((presence_domain_t)d, thresholds[d], false);
+        int base = 0;
+        for (int f = GAIN_STEP_FRAME; f < CAL_DEFAULT_FRAMES; f++) {
+            base += decisions[d][f];
+        }
+        printf(" %s %d / %d (%d without step)", names[d], tagged, untagged, base);
+        gain_ok &= (tagged <= base) && (untagged > base);
+    }
+    printf("\n");
+
+    printf("\n%s Power and log2 pipelines agree with linear (>= %.0f%%)\n",
+           ok ? "✓" : "✗", MIN_AGREEMENT * 100.0f);
+    printf("%s Calibrated thresholds: no more false alarms than fixed, accuracy >= %.0f%%\n",
+           cal_ok ? "✓" : "✗", MIN_AGREEMENT * 100.0f);
+    printf("%s A tagged gain step does not trigger\n", gain_ok ? "✓" : "✗");
+    return (ok && cal_ok && gain_ok) ? 0 : 1;
+}
@@ -0,0 +1,666 @@
+/*
+ * Multi-sensor bus scheduling test
+ *
+ * Runs the instance-based Avian driver (drivers/avian_radar.c) and
+ * the bus scheduler (drivers/radar_bus.c) against several simulated
+ * sensors sharing one SPI bus (tools/host/fake_avian.c) on a simulated
+ * clock. Every frame carries its sensor's id in the samples, so frames
+ * landing in the wrong device buffer are detected.
+ *
+ * Scenarios:
+ *   nominal:    3 sensors, 15 ms processing per frame; no FIFO errors,
+ *               all sensors served equally
+ *   overloaded: 4 sensors, 120 ms processing per frame; FIFO overflows
+ *               are counted and recovered, no sensor starves
+ *   trained:    nominal after SPI link training, sensors with different
+ *               link limits; each settles on the fastest clock step
+ *               within its limit, readout gets shorter
+ *   link check: a sensor forced above its limit is caught by
+ *               radar_dev_link_check() and stepped down, without a
+ *               register write; the check is refused while acquiring
+ *   cadence:    one sensor, processing time jittering 10..60 ms; with
+ *               per-frame re-arm the sensor's frame interval follows
+ *               the jitter, in continuous mode it stays at the frame
+ *               period and frame indices match the sensor's frames.
+ *               Stalls then produce late frames (drained from the
+ *               queue) and an overflow: the queued frames are still
+ *               drained, the FIFO is reset between frames without
+ *               restarting the sequence, and the lost frames are
+ *               counted, reported as the next frame's gap and skipped
+ *               in the index
+ *   gain reference: the VGA gain / high-pass reference is decoded from
+ *               the exported CSU1_2 (avian_register_config); fields out
+ *               of range or differing between RX channels leave the
+ *               gain fixed (radar_dev_set_if_gain refuses)
+ *   gain:       with a valid reference (VGA 3, 80 kHz on all channels),
+ *               continuous mode with the AGC on frames far below full
+ *               scale: the IF gain steps up to the maximum, never
+ *               faster than the AGC allows; only CSU1_2 is written,
+ *               never while a frame is acquired, and frames switch
+ *               their gain tag exactly at the first frame acquired
+ *               with the new setting
+ *   gain down:  one frame above 7/8 of full scale takes a step off at
+ *               once; the next frame, within the AGC interval, does not
+ *   config hash: the snapshot hash ignores the AGC's gain step but
+ *               changes with the frame timing (CCR1/CCR2)
+ *   unpack:     a frame of the FIFO test pattern (distinct values)
+ *               unpacks in place to exactly the pattern
+ *   interference: a clipped full-scale burst in one chirp is flagged
+ *               by the unpack statistics and replaced by its
+ *               neighbours; the frame reads as clean data
+ *   shadow:     the sensor holds the exported configuration after
+ *               init; reprogramming it, or repeating a frame timing,
+ *               writes nothing; a changed register is written alone;
+ *               a frame readout costs one FSTAT read
+ *   trace:      a readout records frame ready, burst and unpack in
+ *               order; the burst's time stamps span the bus time
+ *
+ * Usage: build/host/test_radar_bus
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "radar_bus.h"
+#include "avian_registers.h"
+#include "agc.h"
+#include "fake_avian.h"
+#include "trace.h"
+#include "rtt.h"
+
+#define FRAME_SAMPLES       (RADAR_NUM_SAMPLES * RADAR_NUM_CHIRPS)
+#define ACQUISITION_US      (RADAR_NUM_CHIRPS * AVIAN_CHIRP_TIME_US)
+#define FRAME_PERIOD_US     (AVIAN_FRAME_TIME_MS * 1000UL)
+#define IDLE_POLL_US        200         /* Wait between polls without a frame */
+#define RUN_US              20000000ULL /* 20 s simulated */
+
+static radar_dev_t devs[RADAR_BUS_MAX_DEVICES];
+static int16_t frame_buf[RADAR_BUS_MAX_DEVICES][RADAR_NUM_SAMPLES * RADAR_NUM_CHIRPS];
+static radar_bus_t bus;
+
+typedef struct {
+    uint32_t frames[RADAR_BUS_MAX_DEVICES];
+    uint32_t errors[RADAR_BUS_MAX_DEVICES];
+    uint32_t mixed;             /* Frames with another sensor's samples */
+    float bus_load;
+} scenario_result_t;
+
+/* All samples must belong to sensor `id` (id * 256 + frame % 200) */
+static bool frame_belongs_to(const radar_frame_t *frame, int id)
+{
+    int n = frame->num_chirps * RADAR_NUM_SAMPLES;
+    for (int i = 0; i < n; i++) {
+        if (frame->samples[i] / 256 != id || frame->samples[i] != frame->samples[0]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Link limits (without / with MISO high-speed read) of the trained scenario */
+static const uint32_t link_limit[3][2] = {
+    { 20000000UL, 40000000UL },
+    { 0, 0 },                       /* No limit: 50 MHz */
+    { 12000000UL, 12000000UL },
+};
+
+/* SPI clock divider the training should settle on for a limit */
+static uint8_t expected_scbr(const uint32_t *limit)
+{
+    static const uint8_t steps[] = { 3, 4, 5, 6, 8, 10, 15 };
+    uint32_t max_hz = limit[0] > limit[1] ? limit[0] : limit[1];
+    for (unsigned k = 0; k < sizeof(steps); k++) {
+        if (max_hz == 0 || SPI_CLOCK_HZ(steps[k]) <= max_hz) {
+            return steps[k];
+        }
+    }
+    return SPI_SCBR_DEFAULT;
+}
+
+static bool setup_sensors(const char *name, int num_sensors, bool train)
+{
+    fake_avian_reset();
+    radar_bus_init(&bus);
+    radar_hardware_reset();
+
+    for (int i = 0; i < num_sensors; i++) {
+        spi_cs_t cs = { PIOA, 1u << (11 + i), SPI_SCBR_DEFAULT, false };
+        fake_avian_add(cs.pin, FRAME_SAMPLES, ACQUISITION_US, FRAME_PERIOD_US);
+        if (train) {
+            fake_avian_set_link_limit(i, link_limit[i][0], link_limit[i][1]);
+        }
+        if (!radar_dev_init(&devs[i], &cs) || !radar_bus_add(&bus, &devs[i])) {
+            printf("%s: sensor %d init failed\n", name, i);
+            return false;
+        }
+        if (train && !radar_dev_link_train(&devs[i])) {
+            printf("%s: sensor %d link training failed\n", name, i);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool run_scenario(const char *name, int num_sensors, uint32_t processing_us,
+                         bool train, scenario_result_t *r)
+{
+    memset(r, 0, sizeof(*r));
+    if (!setup_sensors(name, num_sensors, train)) {
+        return false;
+    }
+
+    uint64_t start_us = fake_avian_now_us();
+    uint64_t busy_start_us = fake_avian_bus_busy_us();
+
+    while (fake_avian_now_us() - start_us < RUN_US) {
+        radar_dev_t *dev = radar_bus_poll(&bus);
+        if (!dev) {
+            fake_avian_advance_us(IDLE_POLL_US);
+            continue;
+        }
+        int id = (int)(dev - devs);
+        if (!frame_belongs_to(&dev->frame, id)) {
+            r->mixed++;
+        }
+        fake_avian_advance_us(processing_us);
+    }
+
+    float elapsed_s = (float)(fake_avian_now_us() - start_us) * 1e-6f;
+    r->bus_load = (float)(fake_avian_bus_busy_us() - busy_start_us) * 1e-6f / elapsed_s;
+
+    printf("%s: %d sensors, %u ms processing per frame\n", name, num_sensors,
+           (unsigned)(processing_us / 1000));
+    printf("  sensor  frames  rate(Hz)  fifo_errors  max_fifo  spi(MHz)  hs  wide\n");
+    for (int i = 0; i < num_sensors; i++) {
+        r->frames[i] = bus.frames[i];
+        r->errors[i] = devs[i].fifo_errors;
+        printf("  %-7d %-7u %-9.2f %-12u %-9u %-9.1f %-3d %d\n", i, (unsigned)r->frames[i],
+               (float)r->frames[i] / elapsed_s, (unsigned)r->errors[i],
+               (unsigned)bus.max_level[i], (float)devs[i].link.clock_hz * 1e-6f,
+               devs[i].link.hs_read, devs[i].link.wide);
+    }
+    printf("  bus load %.1f%%, mixed frames %u\n\n", r->bus_load * 100.0f, (unsigned)r->mixed);
+    return true;
+}
+
+/* 32-chirp frames: the FIFO queues 3 of them */
+#define CADENCE_CHIRPS      32
+#define CADENCE_SAMPLES     (RADAR_NUM_SAMPLES * CADENCE_CHIRPS)
+#define GAIN_REF_VGA        3           /* 15 dB VGA, 80 kHz high-pass */
+#define GAIN_REF_HPF        3
+
+typedef struct {
+    uint32_t frames;
+    uint32_t interval_min_us;   /* Sensor-side frame completion interval */
+    uint32_t interval_max_us;
+    uint32_t index_jumps;       /* Frame index out of step with the sensor's frames */
+    uint32_t index_end;         /* Index after the last frame */
+    uint32_t gaps;              /* Sum of frame.gap */
+} cadence_result_t;
+
+/* Processing time of frame n: 10..60 ms, and with stalls 200 ms at
+ * frame 50 (late, queued frames survive) and 400 ms at frame 150
+ * (FIFO overflow) */
+static uint32_t processing_us(uint32_t n, bool stalls)
+{
+    if (stalls && n == 50) return 200000;
+    if (stalls && n == 150) return 400000;
+    return 10000 + (n * 7u % 11u) * 5000;
+}
+
+static bool run_cadence(const char *name, bool continuous, bool stalls, cadence_result_t *r)
+{
+    memset(r, 0, sizeof(*r));
+    fake_avian_reset();
+    radar_hardware_reset();
+
+    radar_dev_t *dev = &devs[0];
+    spi_cs_t cs = { PIOA, 1u << 11, SPI_SCBR_DEFAULT, false };
+    fake_avian_add(cs.pin, CADENCE_SAMPLES, CADENCE_CHIRPS * AVIAN_CHIRP_TIME_US, FRAME_PERIOD_US);
+    if (!radar_dev_init(dev, &cs) || !radar_dev_set_frame_timing(dev, CADENCE_CHIRPS, FRAME_PERIOD_US)) {
+        printf("%s: init failed\n", name);
+        return false;
+    }
+
+    if (continuous) {
+        radar_dev_start(dev);
+    }
+
+    uint64_t start_us = fake_avian_now_us();
+    int offset = -1;
+
+    while (fake_avian_now_us() - start_us < RUN_US) {
+        if (!continuous) {
+            radar_dev_start_frame(dev);             /* Per-frame re-arm */
+        }
+        while (!radar_dev_frame_ready(dev)) {
+            fake_avian_advance_us(IDLE_POLL_US);
+        }
+        const radar_frame_t *frame = radar_dev_get_frame(dev);
+        if (!frame) {
+            continue;
+        }
+
+        /* Samples carry the sensor's frame number % 200 */
+        int o = ((int)frame->samples[0] - (int)(frame->timestamp % 200) + 200) % 200;
+        if (offset >= 0 && o != offset) {
+            r->index_jumps++;
+        }
+        offset = o;
+        r->gaps += frame->gap;
+        fake_avian_advance_us(processing_us(r->frames++, stalls));
+    }
+
+    r->index_end = dev->frame_counter;
+    fake_avian_frame_interval_us(0, &r->interval_min_us, &r->interval_max_us);
+    printf("%s: %u frames (sensor recorded %u), interval %.1f..%.1f ms\n", name,
+           (unsigned)r->frames, (unsigned)fake_avian_frames_recorded(0),
+           r->interval_min_us * 1e-3f, r->interval_max_us * 1e-3f);
+    if (continuous) {
+        printf("  late %u, missed %u, restarts %u, index jumps %u, next index %u\n",
+               (unsigned)dev->stream.late, (unsigned)dev->stream.missed,
+               (unsigned)dev->stream.restarts, (unsigned)r->index_jumps, (unsigned)r->index_end);
+        printf("  overflows %u, recoveries %u (max %.1f ms to a clean frame), gaps %u\n",
+               (unsigned)dev->fifo_errors, (unsigned)dev->stream.recoveries,
+               dev->stream.recovery_ticks_max * 1000.0f / RTT_TICK_HZ, (unsigned)r->gaps);
+    }
+    return true;
+}
+
+typedef struct {
+    uint32_t frames;
+    uint32_t steps;             /* Gain tag changes seen in the frames */
+    uint32_t tag_errors;        /* Tag changed away from the step's first frame */
+    uint32_t reg_words;         /* Register words written after the start */
+    uint32_t busy_writes;       /* Written while a frame was acquired */
+    uint64_t step_min_us;       /* Shortest time between steps */
+} gain_result_t;
+
+/* CSU1_2 entry of the register export */
+static uint32_t export_csx2(void)
+{
+    for (uint32_t i = 0; i < AVIAN_NUM_REGS; i++) {
+        if ((avian_register_config[i] >> 25) == AVIAN_REG_CSU1_2) {
+            return avian_register_config[i];
+        }
+    }
+    return 0;
+}
+
+/* CSU1_2 entry with every RX channel set to vga / hpf */
+static uint32_t csx2_entry(uint32_t entry, uint8_t vga, uint8_t hpf)
+{
+    for (int n = 0; n < RADAR_NUM_RX_ANTENNAS; n++) {
+        entry &= ~((AVIAN_CSX_2_HPF_SEL_MASK << AVIAN_CSX_2_HPF_SEL_POS(n)) |
+                   (AVIAN_CSX_2_VGA_GAIN_MASK << AVIAN_CSX_2_VGA_GAIN_POS(n)));
+        entry |= ((uint32_t)hpf << AVIAN_CSX_2_HPF_SEL_POS(n)) |
+                 ((uint32_t)vga << AVIAN_CSX_2_VGA_GAIN_POS(n));
+    }
+    return entry;
+}
+
+/* Decode of a CSU1_2 entry as the driver must: in range, channels alike */
+static bool decode_csx2(uint32_t entry, uint8_t *vga, uint8_t *hpf)
+{
+    bool valid = true;
+    *vga = (entry >> AVIAN_CSX_2_VGA_GAIN_POS(0)) & AVIAN_CSX_2_VGA_GAIN_MASK;
+    *hpf = (entry >> AVIAN_CSX_2_HPF_SEL_POS(0)) & AVIAN_CSX_2_HPF_SEL_MASK;
+    for (int n = 0; n < RADAR_NUM_RX_ANTENNAS; n++) {
+        uint8_t v = (entry >> AVIAN_CSX_2_VGA_GAIN_POS(n)) & AVIAN_CSX_2_VGA_GAIN_MASK;
+        uint8_t h = (entry >> AVIAN_CSX_2_HPF_SEL_POS(n)) & AVIAN_CSX_2_HPF_SEL_MASK;
+        valid &= (v == *vga) && (h == *hpf) && (v <= AVIAN_VGA_GAIN_MAX) && (h <= AVIAN_HPF_SEL_MAX);
+    }
+    return valid;
+}
+
+/* Reference decoded from the export, a valid and a mixed-channel CSU1_2 */
+static bool run_gain_reference(const char *name)
+{
+    fake_avian_reset();
+    radar_hardware_reset();
+
+    radar_dev_t *dev = &devs[0];
+    spi_cs_t cs = { PIOA, 1u << 11, SPI_SCBR_DEFAULT, false };
+    fake_avian_add(cs.pin, CADENCE_SAMPLES, CADENCE_CHIRPS * AVIAN_CHIRP_TIME_US, FRAME_PERIOD_US);
+    if (!radar_dev_init(dev, &cs)) {
+        printf("%s: init failed\n", name);
+        return false;
+    }
+
+    uint8_t vga, hpf;
+    uint32_t entry = export_csx2();
+    bool valid = decode_csx2(entry, &vga, &hpf);
+    bool exported = (entry != 0) && (dev->gain.ref_valid == valid) &&
+                    (!valid || (dev->gain.ref_vga == vga && dev->gain.ref_hpf == hpf &&
+                                dev->gain.vga == vga && dev->gain.hpf == hpf)) &&
+                    (radar_dev_set_if_gain(dev, 0, 0) == valid);
+    printf("%s: export CSU1_2 0x%06lx %s", name, (unsigned long)(entry & 0xFFFFFF),
+           valid ? "valid" : "out of range or channels differ");
+    if (valid) {
+        printf(", VGA %u, HPF %u", (unsigned)vga, (unsigned)hpf);
+    }
+    printf(", driver %s\n", exported ? "agrees" : "disagrees");
+
+    uint32_t good = csx2_entry(entry, GAIN_REF_VGA, GAIN_REF_HPF);
+    bool good_ok = radar_dev_write_config(dev, &good, 1) && dev->gain.ref_valid &&
+                   (dev->gain.ref_vga == GAIN_REF_VGA) && (dev->gain.ref_hpf == GAIN_REF_HPF) &&
+                   (dev->gain.vga == GAIN_REF_VGA) && radar_dev_set_if_gain(dev, GAIN_REF_VGA + 1, GAIN_REF_HPF);
+
+    uint32_t mixed = good ^ (1UL << AVIAN_CSX_2_VGA_GAIN_POS(2));
+    bool mixed_ok = radar_dev_write_config(dev, &mixed, 1) && !dev->gain.ref_valid &&
+                    !radar_dev_set_if_gain(dev, GAIN_REF_VGA + 1, GAIN_REF_HPF);
+    printf("  VGA 3 / HPF 3 on all channels %s, one channel at VGA 2 %s\n\n",
+           good_ok ? "accepted" : "rejected", mixed_ok ? "rejected" : "accepted");
+    return exported && good_ok && mixed_ok;
+}
+
+static bool run_gain(const char *name, gain_result_t *r)
+{
+    memset(r, 0, sizeof(*r));
+    fake_avian_reset();
+    radar_hardware_reset();
+
+    radar_dev_t *dev = &devs[0];
+    spi_cs_t cs = { PIOA, 1u << 11, SPI_SCBR_DEFAULT, false };
+    fake_avian_add(cs.pin, CADENCE_SAMPLES, CADENCE_CHIRPS * AVIAN_CHIRP_TIME_US, FRAME_PERIOD_US);
+    uint32_t csx2 = csx2_entry(export_csx2(), GAIN_REF_VGA, GAIN_REF_HPF);
+    if (!radar_dev_init(dev, &cs) || !radar_dev_write_config(dev, &csx2, 1) ||
+        !radar_dev_set_frame_timing(dev, CADENCE_CHIRPS, FRAME_PERIOD_US)) {
+        printf("%s: init failed\n", name);
+        return false;
+    }
+
+    radar_dev_set_clutter_filter(dev, RADAR_CLUTTER_CHIRP_MEAN);
+    agc_t agc;
+    agc_init(&agc, dev, AVIAN_FRAME_TIME_MS);
+    radar_dev_start(dev);
+
+    uint64_t start_us = fake_avian_now_us();
+    uint64_t last_step_us = 0;
+    uint32_t words = fake_avian_reg_words(0);
+    int8_t gain_db = 0;
+
+    while (fake_avian_now_us() - start_us < RUN_US) {
+        while (!radar_dev_frame_ready(dev)) {
+            fake_avian_advance_us(IDLE_POLL_US);
+        }
+        const radar_frame_t *frame = radar_dev_get_frame(dev);
+        if (!frame) {
+            continue;
+        }
+        r->frames++;
+
+        if (frame->gain_db != gain_db) {
+            uint64_t now = fake_avian_now_us();
+            r->tag_errors += (frame->timestamp != dev->gain.from_index);
+            if (r->steps > 0 && (r->step_min_us == 0 || now - last_step_us < r->step_min_us)) {
+                r->step_min_us = now - last_step_us;
+            }
+            last_step_us = now;
+            gain_db = frame->gain_db;
+            r->steps++;
+        }
+        agc_update(&agc, frame);
+        fake_avian_advance_us(15000);
+    }
+
+    r->reg_words = fake_avian_reg_words(0) - words;
+    r->busy_writes = fake_avian_busy_writes(0);
+    printf("%s: %u frames, %u steps up (%u seen in the frames), VGA %u -> %u, %+d dB\n", name,
+           (unsigned)r->frames, (unsigned)agc.steps_up, (unsigned)r->steps,
+           (unsigned)dev->gain.ref_vga, (unsigned)dev->gain.vga, gain_db);
+    printf("  %u register words written (%u during acquisition), %u tag errors, steps %.1f s apart at least\n\n",
+           (unsigned)r->reg_words, (unsigned)r->busy_writes, (unsigned)r->tag_errors,
+           r->step_min_us * 1e-6f);
+    return true;
+}
+
+/* One synthetic frame above AGC_PEAK_HIGH, tagged with the current setting */
+static bool run_gain_down(const char *name, radar_dev_t *dev)
+{
+    agc_t agc;
+    radar_frame_t frame;
+
+    radar_dev_stop(dev);
+    agc_init(&agc, dev, AVIAN_FRAME_TIME_MS);
+    uint8_t vga = dev->gain.vga;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.valid = true;
+    frame.gain_db = (int8_t)(((int)vga - (int)dev->gain.ref_vga) * AVIAN_VGA_STEP_DB);
+    frame.hpf_khz = radar_hpf_khz(dev->gain.hpf);
+    frame.peak = AGC_PEAK_HIGH + 1;
+
+    bool first = agc_update(&agc, &frame);
+    bool second = agc_update(&agc, &frame);     /* Within AGC_INTERVAL_MS */
+    printf("%s: peak %u, VGA %u -> %u after one frame, %u step(s) down in two frames\n\n", name,
+           (unsigned)frame.peak, (unsigned)vga, (unsigned)dev->gain.vga, (unsigned)agc.steps_down);
+    return first && !second && (dev->gain.vga == vga - 1) && (agc.steps_down == 1);
+}
+
+int main(void)
+{
+    scenario_result_t r;
+    bool ok = true;
+
+    printf("Radar bus scheduling test\n");
+    printf("=========================\n\n");
+
+    /* Kept by radar_dev_init() */
+    for (int i = 0; i < RADAR_BUS_MAX_DEVICES; i++) {
+        radar_dev_set_frame_buffer(&devs[i], frame_buf[i], RADAR_NUM_SAMPLES * RADAR_NUM_CHIRPS);
+    }
+
+    /* Nominal: everybody is served every round, nothing overflows */
+    ok &= run_scenario("nominal", 3, 15000, false, &r);
+    float nominal_load = r.bus_load;
+    uint32_t min_frames = r.frames[0], max_frames = r.frames[0];
+    for (int i = 0; i < 3; i++) {
+        ok &= (r.errors[i] == 0);
+        if (r.frames[i] < min_frames) min_frames = r.frames[i];
+        if (r.frames[i] > max_frames) max_frames = r.frames[i];
+    }
+    ok &= (r.mixed == 0) && (max_frames - min_frames <= 1) && (min_frames > 0);
+
+    /* Overloaded: overflows are counted and recovered, no starvation */
+    ok &= run_scenario("overloaded", 4, 120000, false, &r);
+    uint32_t errors = 0;
+    min_frames = r.frames[0];
+    for (int i = 0; i < 4; i++) {
+        errors += r.errors[i];
+        if (r.frames[i] < min_frames) min_frames = r.frames[i];
+    }
+    ok &= (r.mixed == 0) && (errors > 0) && (min_frames > 0);
+
+    /* Trained: fastest reliable step per sensor, shorter readout */
+    ok &= run_scenario("trained", 3, 15000, true, &r);
+    for (int i = 0; i < 3; i++) {
+        bool step_ok = (devs[i].link.scbr == expected_scbr(link_limit[i])) && devs[i].link.wide;
+        printf("  sensor %d: %u settings tried, %u readback / %u pattern errors, clock %s\n", i,
+               (unsigned)devs[i].link.steps_tested, (unsigned)devs[i].link.readback_errors,
+               (unsigned)devs[i].link.pattern_errors, step_ok ? "as expected" : "WRONG");
+        ok &= step_ok && (r.errors[i] == 0);
+    }
+    ok &= (r.mixed == 0) && (r.bus_load < nominal_load);
+
+    /* Link check: sensor 2 forced to 50 MHz is caught and stepped down */
+    ok &= setup_sensors("link check", 3, true);
+    radar_dev_start(&devs[2]);
+    bool refused = !radar_dev_link_check(&devs[2]) && (devs[2].link.checks == 0);
+    radar_dev_stop(&devs[2]);
+    devs[2].cs.scbr = SPI_SCBR_FASTEST;
+    devs[2].link.scbr = SPI_SCBR_FASTEST;
+    uint32_t check_words = fake_avian_reg_words(2);
+    int checks = 0;
+    while (!radar_dev_link_check(&devs[2]) && checks < 10) {
+        checks++;
+    }
+    bool read_only = (fake_avian_reg_words(2) == check_words);
+    printf("\nlink check: %s while acquiring; forced 50 MHz, %d failed checks, now %.1f MHz, "
+           "%u register words written\n\n", refused ? "refused" : "ran", checks,
+           (float)devs[2].link.clock_hz * 1e-6f, (unsigned)(fake_avian_reg_words(2) - check_words));
+    ok &= refused && read_only && (devs[2].link.check_failures > 0) &&
+          (devs[2].link.scbr == expected_scbr(link_limit[2]));
+
+    /* Cadence: per-frame re-arm follows the processing jitter,
+     * continuous mode keeps the sensor's period */
+    cadence_result_t c;
+    ok &= run_cadence("cadence, re-arm", false, false, &c);
+    ok &= (c.interval_max_us - c.interval_min_us > 20000);
+    ok &= run_cadence("cadence, continuous", true, false, &c);
+    ok &= (c.interval_min_us == FRAME_PERIOD_US) && (c.interval_max_us == FRAME_PERIOD_US) &&
+          (c.index_jumps == 0) && (devs[0].stream.late == 0) && (devs[0].stream.missed == 0) &&
+          (c.index_end == fake_avian_frames_recorded(0));
+    ok &= run_cadence("cadence, continuous with stalls", true, true, &c);
+    uint32_t recorded = fake_avian_frames_recorded(0);
+    ok &= (devs[0].stream.late > 0) && (devs[0].stream.restarts == 0) &&
+          (devs[0].stream.recoveries == devs[0].fifo_errors) && (devs[0].fifo_errors > 0) &&
+          (c.index_jumps == 0) && (c.gaps == devs[0].stream.missed) &&
+          (c.frames + devs[0].stream.missed == c.index_end) &&
+          (c.index_end + 1 >= recorded && c.index_end <= recorded + 1);
+    printf("\n");
+
+    /* Gain reference decoded from the exported CSU1_2 */
+    ok &= run_gain_reference("gain reference");
+
+    /* Gain: the AGC steps up on quiet frames, CSU1_2 alone, between frames */
+    gain_result_t g;
+    ok &= run_gain("gain", &g);
+    uint32_t csx2 = fake_avian_reg(0, AVIAN_REG_CSU1_2);
+    bool fields_ok = true;
+    for (int n = 0; n < RADAR_NUM_RX_ANTENNAS; n++) {
+        fields_ok &= (((csx2 >> AVIAN_CSX_2_VGA_GAIN_POS(n)) & AVIAN_CSX_2_VGA_GAIN_MASK) == AVIAN_VGA_GAIN_MAX);
+    }
+    uint32_t expected_steps = AVIAN_VGA_GAIN_MAX - GAIN_REF_VGA;
+    ok &= fields_ok && (devs[0].gain.vga == AVIAN_VGA_GAIN_MAX) && (g.steps == expected_steps) &&
+          (devs[0].gain.steps == expected_steps) && (g.reg_words == expected_steps) &&
+          (g.busy_writes == 0) && (g.tag_errors == 0) && (g.step_min_us >= AGC_INTERVAL_MS * 1000ULL);
+
+    /* A frame above 7/8 of full scale steps down at once */
+    uint32_t hash = radar_dev_config_hash(&devs[0]);
+    ok &= run_gain_down("gain down", &devs[0]);
+
+    /* Config hash: kept over a gain step, changed by the frame timing */
+    bool hash_gain = (radar_dev_config_hash(&devs[0]) == hash);
+    ok &= radar_dev_set_frame_timing(&devs[0], CADENCE_CHIRPS / 2, FRAME_PERIOD_US);
+    bool hash_timing = (radar_dev_config_hash(&devs[0]) != hash);
+    printf("config hash: %s over the gain step, %s by the frame timing\n\n",
+           hash_gain ? "kept" : "changed", hash_timing ? "changed" : "kept");
+    ok &= hash_gain && hash_timing;
+
+    /* Unpack: in-place expansion reproduces every sample */
+    ok &= setup_sensors("unpack", 1, false);
+    radar_dev_write_reg(&devs[0], AVIAN_REG_SFCTL,
+                        radar_dev_read_reg(&devs[0], AVIAN_REG_SFCTL) | AVIAN_SFCTL_LFSR_EN);
+    radar_dev_start_frame(&devs[0]);
+    fake_avian_advance_us(FRAME_PERIOD_US);
+    const radar_frame_t *frame = radar_dev_frame_ready(&devs[0]) ? radar_dev_get_frame(&devs[0]) : NULL;
+    uint32_t unpack_errors = frame ? 0 : FRAME_SAMPLES;
+    uint16_t word = AVIAN_TEST_PATTERN_SEED;
+    for (int i = 0; frame && i < FRAME_SAMPLES; i++) {
+        unpack_errors += (frame->samples[i] != (int16_t)word - 2048);
+        word = radar_test_pattern_next(word);
+    }
+    printf("unpack: %u of %u samples differ from the test pattern\n\n", (unsigned)unpack_errors,
+           (unsigned)FRAME_SAMPLES);
+    ok &= (unpack_errors == 0) && frame && !(frame->flags & RADAR_FRAME_INTERFERENCE);
+
+    /* Interference: one chirp of full-scale square wave is replaced */
+    ok &= setup_sensors("interference", 1, false);
+    radar_dev_set_clutter_filter(&devs[0], RADAR_CLUTTER_CHIRP_MEAN);
+    fake_avian_interfere(0, 10);
+    radar_dev_start_frame(&devs[0]);
+    fake_avian_advance_us(FRAME_PERIOD_US);
+    frame = radar_dev_frame_ready(&devs[0]) ? radar_dev_get_frame(&devs[0]) : NULL;
+    uint32_t differ = frame ? 0 : FRAME_SAMPLES;
+    for (int i = 0; frame && i < FRAME_SAMPLES; i++) {
+        differ += (frame->samples[i] != frame->samples[i % RADAR_NUM_SAMPLES]);
+    }
+    if (frame) {
+        const radar_chirp_stats_t *st = &frame->chirp_stats[10];
+        printf("interference: flags 0x%02x, %u bad chirp(s), %u clipped samples, chirp 10 range %u..%u "
+               "energy %u (median %u)\n  %u samples differ after repair, motion energy %u\n\n",
+               frame->flags, frame->bad_chirps, frame->clips, st->min, st->max, (unsigned)st->energy,
+               (unsigned)frame->chirp_energy, (unsigned)differ, (unsigned)frame->motion_energy);
+        ok &= (frame->flags == (RADAR_FRAME_CLIPPED | RADAR_FRAME_INTERFERENCE)) &&
+              (frame->bad_chirps == 1) && st->bad && (frame->clips == RADAR_NUM_SAMPLES) &&
+              (differ == 0) && (frame->motion_energy == 0);
+    } else {
+        ok = false;
+    }
+
+    /* Shadow: delta-only writes and one status read per frame */
+    ok &= setup_sensors("shadow", 1, false);
+    bool config_ok = true;
+    for (int i = 0; i < AVIAN_NUM_REGS; i++) {
+        uint8_t addr = (uint8_t)(avian_register_config[i] >> 25);
+        config_ok &= (fake_avian_reg(0, addr) == (avian_register_config[i] & 0xFFFFFF));
+    }
+    uint32_t init_words = fake_avian_reg_words(0);
+    uint32_t init_bursts = devs[0].shadow.bursts;
+
+    uint32_t words = fake_avian_reg_words(0);
+    radar_dev_write_config(&devs[0], avian_register_config, AVIAN_NUM_REGS);
+    uint32_t rewrite_words = fake_avian_reg_words(0) - words;
+
+    uint32_t changed[AVIAN_NUM_REGS];
+    memcpy(changed, avian_register_config, sizeof(changed));
+    changed[AVIAN_NUM_REGS / 2] ^= 0x000010;
+    words = fake_avian_reg_words(0);
+    radar_dev_write_config(&devs[0], changed, AVIAN_NUM_REGS);
+    uint32_t delta_words = fake_avian_reg_words(0) - words;
+
+    radar_dev_set_frame_timing(&devs[0], 32, 200000);
+    words = fake_avian_reg_words(0);
+    radar_dev_set_frame_timing(&devs[0], 32, 200000);
+    uint32_t timing_words = fake_avian_reg_words(0) - words;
+    radar_dev_set_frame_timing(&devs[0], RADAR_NUM_CHIRPS, FRAME_PERIOD_US);
+
+    radar_dev_start_frame(&devs[0]);
+    fake_avian_advance_us(FRAME_PERIOD_US);
+    uint32_t reads = fake_avian_status_reads(0);
+    bool got_frame = radar_dev_frame_ready(&devs[0]) && radar_dev_get_frame(&devs[0]);
+    uint32_t frame_reads = fake_avian_status_reads(0) - reads;
+
+    printf("shadow: init %u words in %u bursts, config %s\n", (unsigned)init_words,
+           (unsigned)init_bursts, config_ok ? "matches the export" : "WRONG");
+    printf("  rewrite %u words, one changed register %u words, repeated timing %u words\n",
+           (unsigned)rewrite_words, (unsigned)delta_words, (unsigned)timing_words);
+    printf("  FSTAT reads per frame %u, %u writes skipped, %u reads from the shadow\n\n",
+           (unsigned)frame_reads, (unsigned)devs[0].shadow.words_skipped,
+           (unsigned)devs[0].shadow.reads_saved);
+    ok &= config_ok && (init_bursts > 0) && (rewrite_words == 0) && (delta_words == 1) &&
+          (timing_words == 0) && got_frame && (frame_reads == 1);
+
+    /* Trace: one readout is frame ready, burst, unpack; the burst
+     * lasts as long as the bus was busy */
+    ok &= setup_sensors("trace", 1, false);
+    radar_dev_start_frame(&devs[0]);
+    fake_avian_advance_us(FRAME_PERIOD_US);
+    radar_dev_frame_ready(&devs[0]);
+    trace_init();
+    uint64_t busy = fake_avian_bus_busy_us();
+    bool traced_frame = (radar_dev_get_frame(&devs[0]) != NULL);
+    busy = fake_avian_bus_busy_us() - busy;
+
+    trace_record_t rec[8];
+    uint32_t cursor = 0;
+    uint32_t n = trace_read(&cursor, rec, 8);
+    static const uint16_t expected_ids[] = {
+        TRACE_FRAME_READY, TRACE_SPI_BURST, TRACE_SPI_BURST | TRACE_END,
+        TRACE_UNPACK, TRACE_UNPACK | TRACE_END,
+    };
+    bool order_ok = (n == sizeof(expected_ids) / sizeof(expected_ids[0]));
+    for (uint32_t i = 0; order_ok && i < n; i++) {
+        order_ok &= (rec[i].id == expected_ids[i]);
+    }
+    uint32_t burst_us = order_ok ? (uint32_t)((rec[2].cycles - rec[1].cycles) /
+                                              (FAKE_CPU_HZ / 1000000ULL)) : 0;
+    printf("trace: %u records, order %s, burst %u us of %u us bus time, %u bytes\n\n",
+           (unsigned)n, order_ok ? "as expected" : "WRONG", (unsigned)burst_us, (unsigned)busy,
+           order_ok ? (unsigned)rec[1].arg : 0);
+    ok &= traced_frame && order_ok && (burst_us + 1 >= busy) && (burst_us <= busy + 1) &&
+          (rec[1].arg == FRAME_SAMPLES * 3 / 2);
+
+    printf("%s Bus scheduler serves all sensors without mixing frames\n", ok ? "✓" : "✗");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+/*
+ * Frame-deadline supervisor test
+ *
+ * Runs the supervisor (src/supervisor.c) with the firmware presence
+ * context on a simulated cycle counter; the watchdog is stubbed and
+ * counts its kicks.
+ *
+ * Scenarios:
+ *   healthy:   frames within budget stay at FULL, every frame kicks
+ *   overload:  each overrun steps down one level; at SPARSE presence
+ *              evaluates at most PRESENCE_SPARSE_AUTO_MAX_BINS Goertzel
+ *              bins around the target, averages kept. Overrunning
+ *              SUPERVISOR_STUCK_FRAMES frames in a row there stops the
+ *              kicks; they resume with the first healthy frame
+ *   recovery:  SUPERVISOR_RECOVER_FRAMES healthy frames step back up,
+ *              restoring the bins and spectrum mode
+ *   backoff:   an overrun soon after a step up doubles the wait
+ *   hang:      a frame longer than SUPERVISOR_HANG_PERIODS periods,
+ *              or a frame the sensor had queued, is not healthy
+ *
+ * Usage: build/host/test_supervisor
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "supervisor.h"
+#include "watchdog.h"
+#include "clock.h"
+
+#define FRAME_PERIOD_MS     77
+#define PERIOD_CYCLES       (FRAME_PERIOD_MS * (CPU_FREQ / 1000UL))
+#define LIGHT_CYCLES        (PERIOD_CYCLES / 10)
+#define HEAVY_CYCLES        (PERIOD_CYCLES * 9 / 10)    /* Above the 80 % budget */
+#define TARGET_BIN          20
+
+static uint32_t now_cycles;
+static uint32_t kicks;
+static uint32_t wdt_timeout_ms;
+
+/* Stubs: simulated CYCCNT (trace and supervisor) and watchdog */
+uint32_t test_cycles(void)
+{
+    return now_cycles;
+}
+
+void watchdog_init(uint32_t timeout_ms)
+{
+    wdt_timeout_ms = timeout_ms;
+}
+
+void watchdog_reset(void)
+{
+    kicks++;
+}
+
+static supervisor_t sup;
+static presence_ctx_t presence;
+static uint32_t late;
+
+/* One frame taking `cycles`; returns whether it kicked the watchdog */
+static bool run_frame(uint32_t cycles, bool queued)
+{
+    uint32_t before = kicks;
+
+    late += queued;
+    supervisor_frame_begin(&sup);
+    supervisor_stage_begin(&sup, SUPERVISOR_STAGE_PRESENCE, 0);
+    now_cycles += cycles;
+    supervisor_stage_end(&sup, SUPERVISOR_STAGE_PRESENCE, 0);
+    supervisor_frame_end(&sup, late);
+    now_cycles += PERIOD_CYCLES - cycles % PERIOD_CYCLES;
+    return kicks != before;
+}
+
+/* n frames of `cycles` each; kicked: watchdog kicks among them */
+static void run_frames(uint32_t n, uint32_t cycles, uint32_t *kicked)
+{
+    uint32_t k = 0;
+    for (uint32_t f = 0; f < n; f++) {
+        k += run_frame(cycles, false);
+    }
+    if (kicked) {
+        *kicked = k;
+    }
+}
+
+static bool bins_around_target(void)
+{
+    bool has_target = false;
+    for (int b = 0; b < presence.num_bins; b++) {
+        has_target |= (presence.bins[b] == TARGET_BIN);
+        if (b > 0 && presence.bins[b] != presence.bins[b - 1] + 1) {
+            return false;
+        }
+    }
+    return has_target;
+}
+
+int main(void)
+{
+    bool ok = true;
+    uint32_t kicked;
+
+    printf("Frame-deadline supervisor test\n");
+    printf("==============================\n\n");
+
+    presence_init(&presence);
+    presence.first_run = false;             /* Averages are running */
+    presence.max_idx = TARGET_BIN;
+    uint8_t full_bins = presence.num_bins;
+    presence_spectrum_mode_t full_mode = presence.spectrum_mode;
+
+    supervisor_init(&sup, &presence, FRAME_PERIOD_MS);
+    bool armed = (wdt_timeout_ms == SUPERVISOR_WDT_TIMEOUT_MS) && (kicks == 1);
+
+    /* Healthy */
+    run_frames(100, LIGHT_CYCLES, &kicked);
+    bool healthy = armed && (sup.level == SUPERVISOR_FULL) && (kicked == 100);
+    printf("healthy:  100 frames at 10 %%, level %d, %u kicks\n", (int)sup.level, (unsigned)kicked);
+    ok &= healthy;
+
+    /* Overload: one level per overrun, sparse bins around the target */
+    run_frame(HEAVY_CYCLES, false);
+    bool step1 = (sup.level == SUPERVISOR_NO_CLASSIFIER) && !supervisor_run_classifiers(&sup);
+    run_frame(HEAVY_CYCLES, false);
+    bool step2 = (sup.level == SUPERVISOR_SPARSE) && presence.use_sparse &&
+                 (presence.num_bins <= PRESENCE_SPARSE_AUTO_MAX_BINS) && bins_around_target() &&
+                 !presence.first_run;
+    printf("overload: level %d after two overruns, %u sparse bins %u..%u (target %d)\n",
+           (int)sup.level, (unsigned)presence.num_bins, (unsigned)presence.bins[0],
+           (unsigned)presence.bins[presence.num_bins - 1], TARGET_BIN);
+
+    run_frames(SUPERVISOR_STUCK_FRAMES - 3, HEAVY_CYCLES, &kicked);
+    uint32_t kicked_before_stuck = kicked;
+    run_frames(SUPERVISOR_STUCK_FRAMES, HEAVY_CYCLES, &kicked);
+    bool stuck = (kicked_before_stuck == SUPERVISOR_STUCK_FRAMES - 3) && (kicked == 0);
+    bool resumed = run_frame(LIGHT_CYCLES, false);
+    printf("          %u kicks before stuck, %u while stuck, kick %s on the next healthy frame\n",
+           (unsigned)kicked_before_stuck, (unsigned)kicked, resumed ? "resumed" : "missing");
+    ok &= step1 && step2 && stuck && resumed;
+
+    /* Recovery: back up with the full bin set and spectrum mode */
+    run_frames(SUPERVISOR_RECOVER_FRAMES - 2, LIGHT_CYCLES, NULL);
+    bool waited = (sup.level == SUPERVISOR_SPARSE);
+    run_frame(LIGHT_CYCLES, false);
+    bool restored = waited && (sup.level == SUPERVISOR_NO_CLASSIFIER) &&
+                    (presence.num_bins == full_bins) && (presence.spectrum_mode == full_mode) &&
+                    (presence.bins[0] == DETECT_START_SAMPLE) && !presence.first_run;
+    printf("recovery: level %d after %d healthy frames, %u bins, spectrum mode %d\n",
+           (int)sup.level, SUPERVISOR_RECOVER_FRAMES, (unsigned)presence.num_bins,
+           (int)presence.spectrum_mode);
+    ok &= restored;
+
+    /* Backoff: overrun right after the step up doubles the wait */
+    run_frames(10, LIGHT_CYCLES, NULL);
+    run_frame(HEAVY_CYCLES, false);
+    bool doubled = (sup.level == SUPERVISOR_SPARSE) &&
+                   (sup.recover_frames == 2 * SUPERVISOR_RECOVER_FRAMES);
+    run_frames(SUPERVISOR_RECOVER_FRAMES, LIGHT_CYCLES, NULL);
+    bool held = (sup.level == SUPERVISOR_SPARSE);
+    run_frames(SUPERVISOR_RECOVER_FRAMES, LIGHT_CYCLES, NULL);
+    bool up = (sup.level == SUPERVISOR_NO_CLASSIFIER);
+    printf("backoff:  wait %u frames after an early overrun, %s at %d, up at %d\n",
+           (unsigned)sup.recover_frames, held ? "held" : "left", SUPERVISOR_RECOVER_FRAMES,
+           2 * SUPERVISOR_RECOVER_FRAMES);
+    ok &= doubled && held && up;
+
+    /* Hang and queued frames */
+    bool hang_kick = run_frame(PERIOD_CYCLES * (SUPERVISOR_HANG_PERIODS + 1), false);
+    uint32_t overruns = sup.overruns;
+    run_frame(LIGHT_CYCLES, true);
+    bool queued = (sup.overruns == overruns + 1) && (sup.late > 0);
+    printf("hang:     kick %s after %d periods, queued frame %s\n",
+           hang_kick ? "given" : "withheld", SUPERVISOR_HANG_PERIODS + 1,
+           queued ? "counted as overrun" : "missed");
+    ok &= !hang_kick && queued;
+
+    printf("\n%s Supervisor degrades within the sparse crossover and withholds the watchdog only when stuck\n",
+           ok ? "✓" : "✗");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+/*
+ * Host-side accuracy test of the int8 wave detector
+ * Compares wave_detect_q8() against the float wave_detect()
+ *
+ * Usage: test_wave_quant [windows.txt]
+ *   windows.txt: recorded windows, 16 normalized energies per line
+ *   Without a file, synthetic idle and waving windows are used.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "wave_detector.h"
+
+#define NUM_SYNTHETIC   2000
+
+/* Generate synthetic window: flat noise (idle) or sinusoid (waving) */
+static void generate_window(float *w, bool waving)
+{
+    float base = (float)rand() / RAND_MAX * 0.4f;
+    float amp = 0.1f + (float)rand() / RAND_MAX * 0.4f;
+    float freq = 0.1f + (float)rand() / RAND_MAX * 0.4f;
+    float phase = (float)rand() / RAND_MAX * 6.2832f;
+
+    for (int i = 0; i < WAVE_WINDOW_SIZE; i++) {
+        float noise = ((float)rand() / RAND_MAX - 0.5f) * 0.1f;
+        float v = base + noise;
+        if (waving) {
+            v += amp * sinf(6.2832f * freq * i + phase);
+        }
+        w[i] = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+    }
+}
+
+/* Read next recorded window, returns false at end of file */
+static bool read_window(FILE *f, float *w)
+{
+    for (int i = 0; i < WAVE_WINDOW_SIZE; i++) {
+        if (fscanf(f, "%f", &w[i]) != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    printf("Testing Int8 Wave Detector\n");
+    printf("==========================\n\n");
+
+    FILE *rec = NULL;
+    if (argc > 1) {
+        rec = fopen(argv[1], "r");
+        if (!rec) {
+            printf("Cannot open %s\n", argv[1]);
+            return 1;
+        }
+        printf("Using recorded windows from %s\n\n", argv[1]);
+    }
+
+    float window[WAVE_WINDOW_SIZE];
+    wave_result_t res_f, res_q;
+    int total = 0;
+    int mismatches = 0;
+    float max_conf_err = 0.0f;
+    float sum_conf_err = 0.0f;
+    double time_f = 0.0;
+    double time_q = 0.0;
+
+    srand(42);
+
+    while (rec ? read_window(rec, window) : total < NUM_SYNTHETIC) {
+        if (!rec) {
+            generate_window(window, (total & 1) != 0);
+        }
+
+        clock_t t0 = clock();
+        wave_detect(window, &res_f);
+        clock_t t1 = clock();
+        wave_detect_q8(window, &res_q);
+        clock_t t2 = clock();
+
+        time_f += (double)(t1 - t0);
+        time_q += (double)(t2 - t1);
+
+        if (res_f.predicted_class != res_q.predicted_class) {
+            mismatches++;
+        }
+
+        float err = fabsf(res_f.scores[WAVE_CLASS_WAVING] - res_q.scores[WAVE_CLASS_WAVING]);
+        sum_conf_err += err;
+        if (err > max_conf_err) {
+            max_conf_err = err;
+        }
+        total++;
+    }
+
+    if (rec) {
+        fclose(rec);
+    }
+
+    if (total == 0) {
+        printf("No windows\n");
+        return 1;
+    }
+
+    float agreement = 100.0f * (float)(total - mismatches) / (float)total;
+
+    printf("Results:\n");
+    printf("--------\n");
+    printf("Windows:              %d\n", total);
+    printf("Argmax agreement:     %.2f%% (%d mismatches)\n", agreement, mismatches);
+    printf("Waving score error:   mean %.4f, max %.4f\n", sum_conf_err / total, max_conf_err);
+    printf("Host time ratio q8/f: %.2f\n", time_f > 0.0 ? time_q / time_f : 0.0);
+    printf("(Target cycle counts: make BENCHMARK=1, see benchmark_results)\n");
+    printf("\n");
+
+    if (agreement >= 98.0f && max_conf_err < 0.1f) {
+        printf("✓ Quantized model matches float model\n");
+        return 0;
+    } else {
+        printf("✗ Quantized model diverges from float model\n");
+        return 1;
+    }
+}
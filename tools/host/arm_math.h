@@ -0,0 +1,115 @@
+/*
+ * Host stand-in for the CMSIS-DSP subset used by the firmware
+ *
+ * Reference (naive DFT, direct-form) implementations with the CMSIS
+ * signatures and output layouts, so firmware modules can be compiled
+ * and tested on the PC. Put this directory on the include path of host
+ * test builds only; the firmware links the real CMSIS-DSP.
+ */
+
+#ifndef ARM_MATH_HOST_H
+#define ARM_MATH_HOST_H
+
+#include <stdint.h>
+#include <math.h>
+
+#define PI  3.14159265358979f
+
+typedef float float32_t;
+
+typedef enum {
+    ARM_MATH_SUCCESS = 0,
+    ARM_MATH_ARGUMENT_ERROR = -1
+} arm_status;
+
+typedef struct {
+    uint16_t fftLenRFFT;
+} arm_rfft_fast_instance_f32;
+
+typedef struct {
+    uint32_t numStages;
+    float32_t *pState;
+    const float32_t *pCoeffs;
+} arm_biquad_casd_df1_inst_f32;
+
+static inline arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32 *S, uint16_t fftLen)
+{
+    S->fftLenRFFT = fftLen;
+    return ARM_MATH_SUCCESS;
+}
+
+/* Forward real FFT, CMSIS packing: [X0.re, X(N/2).re, X1.re, X1.im, ...] */
+static inline void arm_rfft_fast_f32(const arm_rfft_fast_instance_f32 *S, float32_t *p,
+                                     float32_t *pOut, uint8_t ifftFlag)
+{
+    uint32_t n_len = S->fftLenRFFT;
+    (void)ifftFlag;
+
+    for (uint32_t k = 0; k < n_len / 2; k++) {
+        double re = 0.0;
+        double im = 0.0;
+        for (uint32_t n = 0; n < n_len; n++) {
+            double w = 2.0 * 3.14159265358979323846 * (double)(k * n % n_len) / (double)n_len;
+            re += p[n] * cos(w);
+            im -= p[n] * sin(w);
+        }
+        pOut[2 * k] = (float32_t)re;
+        pOut[2 * k + 1] = (float32_t)im;
+    }
+
+    double nyq = 0.0;
+    for (uint32_t n = 0; n < n_len; n++) {
+        nyq += (n & 1) ? -p[n] : p[n];
+    }
+    pOut[1] = (float32_t)nyq;
+}
+
+static inline void arm_cmplx_mag_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples)
+{
+    for (uint32_t i = 0; i < numSamples; i++) {
+        pDst[i] = sqrtf(pSrc[2 * i] * pSrc[2 * i] + pSrc[2 * i + 1] * pSrc[2 * i + 1]);
+    }
+}
+
+static inline void arm_cmplx_mag_squared_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples)
+{
+    for (uint32_t i = 0; i < numSamples; i++) {
+        pDst[i] = pSrc[2 * i] * pSrc[2 * i] + pSrc[2 * i + 1] * pSrc[2 * i + 1];
+    }
+}
+
+static inline void arm_biquad_cascade_df1_init_f32(arm_biquad_casd_df1_inst_f32 *S, uint8_t numStages,
+                                                   const float32_t *pCoeffs, float32_t *pState)
+{
+    S->numStages = numStages;
+    S->pCoeffs = pCoeffs;
+    S->pState = pState;
+    for (uint32_t i = 0; i < 4u * numStages; i++) {
+        pState[i] = 0.0f;
+    }
+}
+
+/* Coefficients {b0, b1, b2, a1, a2} per stage (a1/a2 already negated), state {x1, x2, y1, y2} */
+static inline void arm_biquad_cascade_df1_f32(const arm_biquad_casd_df1_inst_f32 *S, const float32_t *pSrc,
+                                              float32_t *pDst, uint32_t blockSize)
+{
+    const float32_t *in = pSrc;
+
+    for (uint32_t st = 0; st < S->numStages; st++) {
+        const float32_t *c = &S->pCoeffs[5 * st];
+        float32_t *z = &S->pState[4 * st];
+
+        for (uint32_t n = 0; n < blockSize; n++) {
+            float32_t x = in[n];
+            float32_t y = c[0] * x + c[1] * z[0] + c[2] * z[1] + c[3] * z[2] + c[4] * z[3];
+            z[1] = z[0];
+            z[0] = x;
+            z[3] = z[2];
+            z[2] = y;
+            pDst[n] = y;
+        }
+        in = pDst;
+    }
+}
+
+#endif /* ARM_MATH_HOST_H */
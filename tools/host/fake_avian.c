@@ -0,0 +1,437 @@
+/*
+ * Host simulation of BGT60 sensors on a shared SPI bus
+ *
+ * Protocol subset used by drivers/avian_radar.c:
+ *   register write  [addr<<1|1][d23..16][d15..8][d7..0]
+ *   register read   [addr<<1|0][0][0][0] -> GSR0, 24-bit value
+ *   register read   returns GSR0 first as well; writes answer it too
+ *   FIFO burst      [0xFF][0x60<<1][0][0] -> GSR0 (bit 3: FIFO error),
+ *                   then 3 bytes per 2 packed 12-bit samples
+ *   burst write     [0xFF][addr<<1|1][0][0], then 3 bytes per register,
+ *                   address incrementing
+ * MAIN: software reset clears all registers, FIFO/FSM reset clears the
+ * FIFO and stops the frame sequence, FRAME_START starts it. FSTAT
+ * reports fill level and error flag. Other registers written while a
+ * frame is being acquired are counted (the chirps would be mixed).
+ * SFCTL LFSR_EN: burst reads return the test pattern (restarted by a
+ * FIFO reset). Above a sensor's link limit (depending on MISO_HS_READ)
+ * every byte read back has its LSB flipped.
+ */
+
+#include "fake_avian.h"
+#include "spi.h"
+#include "avian_radar.h"
+#include "rtt.h"
+#include <string.h>
+
+
+typedef struct {
+    uint32_t cs_pin;
+    uint32_t regs[128];
+    uint32_t frame_samples;
+    uint64_t acquisition_ns;
+    uint64_t period_ns;
+
+    /* Frame sequence */
+    bool running;
+    uint64_t start_ns;
+    uint32_t seq_frames;        /* Frames of the current sequence delivered */
+    uint32_t recorded;          /* All frames delivered */
+    uint32_t overflows;
+    uint64_t last_frame_ns;     /* Completion of the previous frame */
+    uint64_t interval_min_ns;
+    uint64_t interval_max_ns;
+    int interfere_chirp;        /* In the next frame, -1: none */
+
+    /* Link */
+    uint32_t max_hz;            /* Reliable clock limit without / with HS read */
+    uint32_t max_hz_hs;
+    uint16_t lfsr;
+
+    /* Traffic */
+    uint32_t reg_words;         /* Register words written */
+    uint32_t busy_writes;       /* Written during an acquisition (not MAIN) */
+    uint32_t status_reads;      /* FSTAT reads */
+
+    /* FIFO of 12-bit samples */
+    uint16_t fifo[FAKE_FIFO_SAMPLES];
+    uint32_t head;
+    uint32_t level;
+    bool fifo_error;
+} fake_sensor_t;
+
+static fake_sensor_t sensors[FAKE_MAX_SENSORS];
+static int num_sensors;
+static uint64_t now_ns;
+static uint64_t busy_ns;
+static uint32_t clock_hz = FAKE_SPI_HZ;
+
+/* Transaction state */
+static fake_sensor_t *selected;
+static int phase;               /* 0: command expected, 1: burst data */
+static bool burst;
+static bool burst_write;
+static uint8_t burst_addr;
+static uint8_t burst_byte;      /* Byte within the register word being written */
+static uint32_t burst_word;
+
+/* Deliver the frames completed up to now */
+static void sensor_update(fake_sensor_t *s)
+{
+    uint64_t done_ns;
+    while (s->running &&
+           (done_ns = s->start_ns + s->acquisition_ns + (uint64_t)s->seq_frames * s->period_ns) <= now_ns) {
+        int id = (int)(s - sensors);
+        uint16_t value = (uint16_t)(2048 + id * 256 + s->recorded % 200);
+
+        if (s->recorded > 0) {
+            uint64_t interval = done_ns - s->last_frame_ns;
+            if (s->interval_min_ns == 0 || interval < s->interval_min_ns) s->interval_min_ns = interval;
+            if (interval > s->interval_max_ns) s->interval_max_ns = interval;
+        }
+        s->last_frame_ns = done_ns;
+        s->seq_frames++;
+        s->recorded++;
+
+        /* Overflow: the frame is cut off where the FIFO is full */
+        uint32_t n = s->frame_samples;
+        if (s->level + n > FAKE_FIFO_SAMPLES) {
+            n = FAKE_FIFO_SAMPLES - s->level;
+            s->fifo_error = true;
+            s->overflows++;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            bool hit = ((int)(i / RADAR_NUM_SAMPLES) == s->interfere_chirp);
+            s->fifo[(s->head + s->level + i) % FAKE_FIFO_SAMPLES] = hit ? ((i & 1) ? 4095 : 0) : value;
+        }
+        s->level += n;
+        s->interfere_chirp = -1;
+    }
+}
+
+static uint16_t fifo_pop(fake_sensor_t *s)
+{
+    if (s->level == 0) {
+        s->fifo_error = true;   /* Underflow */
+        return 0;
+    }
+    uint16_t v = s->fifo[s->head];
+    s->head = (s->head + 1) % FAKE_FIFO_SAMPLES;
+    s->level--;
+    return v;
+}
+
+static void write_main(fake_sensor_t *s, uint32_t value)
+{
+    if (value & AVIAN_MAIN_SW_RESET) {
+        memset(s->regs, 0, sizeof(s->regs));
+    }
+    if (value & (AVIAN_MAIN_FIFO_RESET | AVIAN_MAIN_FSM_RESET | AVIAN_MAIN_SW_RESET)) {
+        s->level = 0;
+        s->head = 0;
+        s->lfsr = AVIAN_TEST_PATTERN_SEED;
+        s->fifo_error = false;
+    }
+    if (value & (AVIAN_MAIN_FSM_RESET | AVIAN_MAIN_SW_RESET)) {
+        s->running = false;     /* FIFO reset alone keeps the sequence going */
+    }
+    if (value & AVIAN_MAIN_FRAME_START) {
+        s->running = true;
+        s->start_ns = now_ns;
+        s->seq_frames = 0;
+    }
+}
+
+static uint32_t read_reg(fake_sensor_t *s, uint8_t addr)
+{
+    switch (addr) {
+    case AVIAN_REG_ADC0:
+        return AVIAN_ADC0_BGT60TR13C;
+    case AVIAN_REG_FSTAT:
+        s->status_reads++;
+        return s->level | (s->fifo_error ? AVIAN_FSTAT_FOU_ERR : 0) |
+               (s->level == 0 ? AVIAN_FSTAT_EMPTY : 0);
+    default:
+        return s->regs[addr & 0x7F];
+    }
+}
+
+void fake_avian_reset(void)
+{
+    memset(sensors, 0, sizeof(sensors));
+    num_sensors = 0;
+    now_ns = 0;
+    busy_ns = 0;
+    clock_hz = FAKE_SPI_HZ;
+    selected = NULL;
+}
+
+int fake_avian_add(uint32_t cs_pin, uint32_t frame_samples, uint32_t acquisition_us,
+                   uint32_t period_us)
+{
+    if (num_sensors >= FAKE_MAX_SENSORS) {
+        return -1;
+    }
+    fake_sensor_t *s = &sensors[num_sensors];
+    memset(s, 0, sizeof(*s));
+    s->cs_pin = cs_pin;
+    s->frame_samples = frame_samples;
+    s->acquisition_ns = (uint64_t)acquisition_us * 1000ULL;
+    s->period_ns = (uint64_t)period_us * 1000ULL;
+    s->lfsr = AVIAN_TEST_PATTERN_SEED;
+    s->interfere_chirp = -1;
+    return num_sensors++;
+}
+
+void fake_avian_set_link_limit(int sensor, uint32_t max_hz, uint32_t max_hz_hs)
+{
+    sensors[sensor].max_hz = max_hz;
+    sensors[sensor].max_hz_hs = max_hz_hs;
+}
+
+uint32_t fake_avian_clock_hz(void)
+{
+    return clock_hz;
+}
+
+uint64_t fake_avian_now_us(void)
+{
+    return now_ns / 1000ULL;
+}
+
+uint32_t fake_avian_cycles(void)
+{
+    return (uint32_t)(now_ns * (FAKE_CPU_HZ / 1000000ULL) / 1000ULL);
+}
+
+void fake_avian_advance_us(uint64_t us)
+{
+    now_ns += us * 1000ULL;
+}
+
+uint64_t fake_avian_bus_busy_us(void)
+{
+    return busy_ns / 1000ULL;
+}
+
+uint32_t fake_avian_frames_recorded(int sensor)
+{
+    return sensors[sensor].recorded;
+}
+
+void fake_avian_interfere(int sensor, int chirp)
+{
+    sensors[sensor].interfere_chirp = chirp;
+}
+
+uint32_t fake_avian_overflows(int sensor)
+{
+    return sensors[sensor].overflows;
+}
+
+void fake_avian_frame_interval_us(int sensor, uint32_t *min_us, uint32_t *max_us)
+{
+    *min_us = (uint32_t)(sensors[sensor].interval_min_ns / 1000ULL);
+    *max_us = (uint32_t)(sensors[sensor].interval_max_ns / 1000ULL);
+}
+
+uint32_t fake_avian_reg(int sensor, uint8_t addr)
+{
+    return sensors[sensor].regs[addr & 0x7F];
+}
+
+uint32_t fake_avian_reg_words(int sensor)
+{
+    return sensors[sensor].reg_words;
+}
+
+uint32_t fake_avian_busy_writes(int sensor)
+{
+    return sensors[sensor].busy_writes;
+}
+
+uint32_t fake_avian_status_reads(int sensor)
+{
+    return sensors[sensor].status_reads;
+}
+
+/* spi.h */
+
+void spi_init(void)
+{
+}
+
+void spi_cs_init(const spi_cs_t *cs)
+{
+    (void)cs;
+}
+
+void spi_select_cs(const spi_cs_t *cs)
+{
+    clock_hz = SPI_CLOCK_HZ(cs->scbr ? cs->scbr : SPI_SCBR_DEFAULT);
+    selected = NULL;
+    for (int i = 0; i < num_sensors; i++) {
+        if (sensors[i].cs_pin == cs->pin) {
+            selected = &sensors[i];
+        }
+    }
+    phase = 0;
+    burst = false;
+    burst_write = false;
+}
+
+void spi_deselect_cs(const spi_cs_t *cs)
+{
+    (void)cs;
+    selected = NULL;
+}
+
+void spi_select(void)
+{
+    static const spi_cs_t cs = SPI_CS_DEFAULT;
+    spi_select_cs(&cs);
+}
+
+void spi_deselect(void)
+{
+    spi_deselect_cs(NULL);
+}
+
+static void transfer(fake_sensor_t *s, const uint8_t *tx_buf, uint8_t *rx_buf, uint32_t len);
+
+void spi_transfer_buffer(const uint8_t *tx_buf, uint8_t *rx_buf, uint32_t len)
+{
+    uint64_t ns = (uint64_t)len * 8ULL * 1000000000ULL / clock_hz;
+    now_ns += ns;
+    busy_ns += ns;
+
+    fake_sensor_t *s = selected;
+    if (!s) {
+        if (rx_buf) {
+            memset(rx_buf, 0xFF, len);  /* Nobody drives MISO */
+        }
+        return;
+    }
+    sensor_update(s);
+    transfer(s, tx_buf, rx_buf, len);
+
+    /* Sampling too late for this clock: bit errors on MISO */
+    uint32_t limit = (s->regs[AVIAN_REG_SFCTL] & AVIAN_SFCTL_MISO_HS_READ) ? s->max_hz_hs : s->max_hz;
+    if (rx_buf && limit && clock_hz > limit) {
+        for (uint32_t i = 0; i < len; i++) {
+            rx_buf[i] ^= 0x01;
+        }
+    }
+}
+
+static void write_reg(fake_sensor_t *s, uint8_t addr, uint32_t value)
+{
+    s->regs[addr & 0x7F] = value;
+    s->reg_words++;
+    if (addr == AVIAN_REG_MAIN) {
+        write_main(s, value);
+    } else if (s->running && s->period_ns > 0 &&
+               (now_ns - s->start_ns) % s->period_ns < s->acquisition_ns) {
+        s->busy_writes++;
+    }
+}
+
+static void transfer(fake_sensor_t *s, const uint8_t *tx_buf, uint8_t *rx_buf, uint32_t len)
+{
+    if (phase == 0) {
+        uint8_t gsr0 = s->fifo_error ? AVIAN_GSR0_FOU_ERR : 0x00;
+        phase = 1;
+
+        if (tx_buf[0] == 0xFF) {
+            burst = true;
+            burst_write = (tx_buf[1] & 0x01) != 0;
+            burst_addr = tx_buf[1] >> 1;
+            burst_byte = 0;
+            burst_word = 0;
+            if (rx_buf) {
+                memset(rx_buf, 0, len);
+                rx_buf[0] = gsr0;
+            }
+            return;
+        }
+
+        uint8_t addr = tx_buf[0] >> 1;
+        if (rx_buf) {
+            rx_buf[0] = gsr0;
+        }
+        if (tx_buf[0] & 0x01) {
+            write_reg(s, addr, ((uint32_t)tx_buf[1] << 16) | ((uint32_t)tx_buf[2] << 8) | tx_buf[3]);
+        } else if (rx_buf) {
+            uint32_t value = read_reg(s, addr);
+            rx_buf[1] = (uint8_t)(value >> 16);
+            rx_buf[2] = (uint8_t)(value >> 8);
+            rx_buf[3] = (uint8_t)value;
+        }
+        return;
+    }
+
+    if (burst && burst_write) {
+        for (uint32_t i = 0; i < len; i++) {
+            burst_word = (burst_word << 8) | tx_buf[i];
+            if (++burst_byte == 3) {
+                write_reg(s, burst_addr++, burst_word & 0xFFFFFF);
+                burst_byte = 0;
+                burst_word = 0;
+            }
+        }
+        if (rx_buf) {
+            memset(rx_buf, 0, len);
+        }
+        return;
+    }
+
+    if (burst && rx_buf) {
+        bool lfsr = (s->regs[AVIAN_REG_SFCTL] & AVIAN_SFCTL_LFSR_EN) != 0;
+        for (uint32_t i = 0; i + 2 < len; i += 3) {
+            uint16_t s0, s1;
+            if (lfsr) {
+                s0 = s->lfsr;
+                s1 = radar_test_pattern_next(s0);
+                s->lfsr = radar_test_pattern_next(s1);
+            } else {
+                s0 = fifo_pop(s);
+                s1 = fifo_pop(s);
+            }
+            rx_buf[i] = (uint8_t)(s0 >> 4);
+            rx_buf[i + 1] = (uint8_t)(((s0 & 0x0F) << 4) | (s1 >> 8));
+            rx_buf[i + 2] = (uint8_t)s1;
+        }
+    }
+}
+
+uint8_t spi_transfer(uint8_t data)
+{
+    uint8_t rx;
+    spi_transfer_buffer(&data, &rx, 1);
+    return rx;
+}
+
+/* gpio.h / clock.h / rtt.h */
+
+void radar_reset_low(void)
+{
+}
+
+void radar_reset_high(void)
+{
+}
+
+void delay_ms(uint32_t ms)
+{
+    now_ns += (uint64_t)ms * 1000000ULL;
+}
+
+void delay_us(uint32_t us)
+{
+    now_ns += (uint64_t)us * 1000ULL;
+}
+
+uint32_t rtt_now(void)
+{
+    return (uint32_t)(now_ns * RTT_TICK_HZ / 1000000000ULL);
+}
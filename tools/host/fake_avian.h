@@ -0,0 +1,75 @@
+/*
+ * Host simulation of BGT60 sensors on a shared SPI bus
+ *
+ * Replaces spi.c, the radar reset GPIO, the delay functions, the RTT
+ * counter and the cycle counter for host tests that link drivers/avian_radar.c. Each
+ * simulated sensor is selected by its chip select pin, records frames
+ * into its own FIFO on a simulated microsecond clock and answers
+ * register, FSTAT and burst FIFO reads. SPI traffic advances the clock at the SPI bit
+ * rate, delays by their duration.
+ */
+
+#ifndef FAKE_AVIAN_H
+#define FAKE_AVIAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FAKE_MAX_SENSORS        4
+#define FAKE_FIFO_SAMPLES       8190    /* FIFO capacity (12-bit words, fits FSTAT fill) */
+#define FAKE_SPI_HZ             10000000UL      /* Clock before the first select */
+
+/*
+ * Remove all sensors and restart the clock
+ */
+void fake_avian_reset(void);
+
+/*
+ * Add a sensor on chip select pin `cs_pin`. After FRAME_START it
+ * delivers a frame of `frame_samples` samples acquisition_us later,
+ * then one every period_us until the FIFO/FSM is reset.
+ * Samples of sensor n read back as n * 256 + (frame number % 200)
+ * after the 2048 offset is removed. Returns the sensor index.
+ */
+int fake_avian_add(uint32_t cs_pin, uint32_t frame_samples, uint32_t acquisition_us,
+                   uint32_t period_us);
+
+/*
+ * Highest reliable SPI clock of a sensor without / with SFCTL
+ * MISO_HS_READ (0: no limit, the default)
+ */
+void fake_avian_set_link_limit(int sensor, uint32_t max_hz, uint32_t max_hz_hs);
+
+/* SPI clock of the last selected device */
+uint32_t fake_avian_clock_hz(void);
+
+/* Simulated time */
+uint64_t fake_avian_now_us(void);
+void fake_avian_advance_us(uint64_t us);
+
+/* Simulated CYCCNT at FAKE_CPU_HZ (trace time stamps: TRACE_CLOCK_FN) */
+#define FAKE_CPU_HZ             300000000ULL
+uint32_t fake_avian_cycles(void);
+
+/* Microseconds the bus was busy (chip select low) */
+uint64_t fake_avian_bus_busy_us(void);
+
+/* Frames recorded / lost to FIFO overflow by a sensor */
+uint32_t fake_avian_frames_recorded(int sensor);
+uint32_t fake_avian_overflows(int sensor);
+
+/* Overwrite chirp `chirp` of the next frame a sensor records with a
+ * full-scale square wave (another radar sweeping through the IF band) */
+void fake_avian_interfere(int sensor, int chirp);
+
+/* Shortest / longest interval between frames completed by a sensor */
+void fake_avian_frame_interval_us(int sensor, uint32_t *min_us, uint32_t *max_us);
+
+/* Register file of a sensor, register words written to it (single and
+ * burst; while acquiring a frame) and FSTAT reads answered */
+uint32_t fake_avian_reg(int sensor, uint8_t addr);
+uint32_t fake_avian_reg_words(int sensor);
+uint32_t fake_avian_busy_writes(int sensor);
+uint32_t fake_avian_status_reads(int sensor);
+
+#endif /* FAKE_AVIAN_H */
@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""
+Quantize the float wave detector model to int8.
+
+Parses the float weight tables from src/wave_detector.c, calibrates
+per-layer activation scales on synthetic energy windows and prints the
+int8 tables for src/wave_detector_q8.c. Re-run after retraining and
+paste the output over the tables there.
+
+Also writes src/wave_model.h (next to the model source) with the
+feature scale WAVE_ENERGY_SCALE, derived from the training feature
+normalisation below and the window scale of src/presence_detection.c,
+so the firmware energy matches the units WAVE_NORM_MIN/MAX were taken
+in.
+
+Weights are stored transposed ([out][in]) so each output neuron is one
+contiguous int8 row for the SMLAD dot product. Biases are int32 in the
+accumulator scale (s_in * s_w). Hidden layers are requantized with a
+Q31 multiplier and right shift; the output layer keeps int32 logits
+and only exports the float scale needed to report a confidence.
+
+Usage: python3 tools/quantize_wave_model.py [src/wave_detector.c]
+"""
+
+import math
+import os
+import random
+import re
+import sys
+
+# Training features: per frame, the sum over the detection bins of
+# |rFFT(mean chirp x Blackman-Harris)|, on frames in raw ADC counts
+# (sample scale 1). The firmware computes the same sum on
+# presence_detect()'s range profile, whose window has a sample scale
+# folded in; WAVE_ENERGY_SCALE undoes it.
+TRAIN_SAMPLE_SCALE = 1.0
+
+
+def parse_array(src, name):
+    m = re.search(r"static const float %s(\[[^=]*)=\s*\{(.*?)\};" % name, src, re.S)
+    dims = [int(d) for d in re.findall(r"\[(\d+)\]", m.group(1))]
+    vals = [float(v.rstrip("f")) for v in re.findall(r"-?\d+\.\d+f", m.group(2))]
+    if len(dims) == 2:
+        return [vals[i * dims[1]:(i + 1) * dims[1]] for i in range(dims[0])]
+    return vals
+
+
+def forward(x, layers):
+    acts = []
+    for idx, (w, b) in enumerate(layers):
+        out = []
+        for j in range(len(b)):
+            s = b[j] + sum(x[i] * w[i][j] for i in range(len(x)))
+            out.append(max(s, 0.0) if idx < len(layers) - 1 else s)
+        acts.append(out)
+        x = out
+    return acts
+
+
+def calib_windows(n=2000, seed=1):
+    rnd = random.Random(seed)
+    wins = []
+    for k in range(n):
+        if k % 2:
+            f = rnd.uniform(0.1, 0.5)
+            a = rnd.uniform(0.1, 0.5)
+            o = rnd.uniform(0.2, 0.5)
+            p = rnd.uniform(0, 2 * math.pi)
+            w = [o + a * math.sin(2 * math.pi * f * i + p) for i in range(16)]
+        else:
+            base = rnd.uniform(0.0, 0.3)
+            w = [base + rnd.uniform(-0.05, 0.05) for _ in range(16)]
+        wins.append([min(max(v, 0.0), 1.0) for v in w])
+    return wins
+
+
+def quant_multiplier(real):
+    """Return (Q31 multiplier, right shift) with real = mult * 2^-31 * 2^-shift."""
+    shift = 0
+    while real < 0.5:
+        real *= 2.0
+        shift += 1
+    mult = int(round(real * (1 << 31)))
+    if mult == (1 << 31):
+        mult //= 2
+        shift -= 1
+    return mult, shift
+
+
+def firmware_sample_scale(path):
+    """Scale folded into presence_detect()'s window (window_scaled)."""
+    src = open(path).read()
+    m = re.search(r"window_scaled\[i\] = blackman_harris_64\[i\] / ([\d.]+)f;", src)
+    return 1.0 / float(m.group(1))
+
+
+def write_model_header(path, energy_scale):
+    with open(path, "w") as f:
+        f.write("""/*
+ * Wave Detection - Feature Scale
+ *
+ * Generated by tools/quantize_wave_model.py from the training feature
+ * normalisation; do not edit, re-run the script after retraining.
+ */
+
+#ifndef WAVE_MODEL_H
+#define WAVE_MODEL_H
+
+/*
+ * Summed range-bin magnitude of presence_detect()'s profile to the raw
+ * energy units of training (WAVE_NORM_MIN..WAVE_NORM_MAX): training
+ * sample scale %g / firmware window sample scale %.10g
+ */
+#define WAVE_ENERGY_SCALE       %.1ff
+
+#endif /* WAVE_MODEL_H */
+""" % (TRAIN_SAMPLE_SCALE, TRAIN_SAMPLE_SCALE / energy_scale, energy_scale))
+
+
+def main():
+    path = sys.argv[1] if len(sys.argv) > 1 else "src/wave_detector.c"
+    src_dir = os.path.dirname(path)
+    energy_scale = TRAIN_SAMPLE_SCALE / firmware_sample_scale(os.path.join(src_dir, "presence_detection.c"))
+    write_model_header(os.path.join(src_dir, "wave_model.h"), energy_scale)
+    src = open(path).read()
+    layers = [(parse_array(src, "w%d" % i), parse_array(src, "b%d" % i)) for i in (1, 2, 3)]
+
+    s_in = 1.0 / 127.0
+    act_max = [0.0] * len(layers)
+    for x in calib_windows():
+        for i, a in enumerate(forward(x, layers)):
+            act_max[i] = max(act_max[i], max(abs(v) for v in a))
+
+    for li, (w, b) in enumerate(layers):
+        n_in, n_out = len(w), len(b)
+        s_w = max(abs(v) for row in w for v in row) / 127.0
+        s_out = act_max[li] / 127.0
+        wq = [[int(round(w[i][j] / s_w)) for i in range(n_in)] for j in range(n_out)]
+        bq = [int(round(b[j] / (s_in * s_w))) for j in range(n_out)]
+        n = li + 1
+        last = li == len(layers) - 1
+        if last:
+            print("/* Layer %d: scale_w=%.8f (logits stay in the int32 accumulator) */" % (n, s_w))
+        else:
+            print("/* Layer %d: scale_w=%.8f scale_out=%.8f */" % (n, s_w, s_out))
+        print("static const int8_t q_w%d[%d][%d] = {" % (n, n_out, n_in))
+        for row in wq:
+            print("    {%s}," % ", ".join("%d" % v for v in row))
+        print("};")
+        print("static const int32_t q_b%d[%d] = {%s};" % (n, n_out, ", ".join("%d" % v for v in bq)))
+        if last:
+            print("#define Q_LOGIT_SCALE %.10ef" % (s_in * s_w))
+        else:
+            mult, shift = quant_multiplier(s_in * s_w / s_out)
+            print("#define Q_L%d_MULT  %dL" % (n, mult))
+            print("#define Q_L%d_SHIFT %d" % (n, shift))
+        print()
+        s_in = s_out
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""
+Per-module RAM report from the GNU ld map file, checked against budgets.
+
+Every input section placed in a RAM output section (.data, .bss, .dtcm,
+.heap, .stack) is attributed to an owner by its object file; padding
+and the stack/heap reservations are counted separately. Exits with 1
+if an owner or region total is over its budget, which makes the
+firmware link fail (Makefile).
+
+The memory arena (src/mem_arena.c) appears as one owner with both
+pools; its per-module use is only known at run time (mem_arena_stats).
+
+Usage:
+    python3 tools/ram_report.py build/bjt60_presence.map tools/ram_budget.cfg
+    python3 tools/ram_report.py --verbose build/bjt60_presence.map [budget.cfg]
+
+Budget file: one "owner bytes" pair per line (K suffix allowed, #
+comments), owners as below plus "sram" and "dtcm" for region totals.
+Owner budgets apply to SRAM; the DTCM pool is sized by TCM_KB.
+"""
+
+import os
+import re
+import sys
+
+RAM_SECTIONS = {".data": "sram", ".bss": "sram", ".heap": "sram",
+                ".stack": "sram", ".dtcm": "dtcm"}
+
+# Object file (basename without .o) -> owner
+OWNERS = {
+    "radar": ["avian_radar", "radar_bus", "spi"],
+    "presence": ["presence_detection", "zones", "occupancy", "background_store", "frame_rate"],
+    "gesture": ["gesture", "wave_detector", "wave_detector_q8", "wave_features"],
+    "vitals": ["vital_signs"],
+    "telemetry": ["telemetry", "uart"],
+    "trace": ["trace"],
+    "arena": ["mem_arena"],
+    "app": ["main", "power_scheduler"],
+    "benchmark": ["benchmark"],
+}
+OWNER_ORDER = list(OWNERS) + ["dsp", "system", "stack", "heap", "padding"]
+
+OBJ_OWNER = {obj: owner for owner, objs in OWNERS.items() for obj in objs}
+
+HEX = r"0x([0-9a-fA-F]+)"
+OUTPUT_RE = re.compile(r"^(\.\S+)(?:\s+" + HEX + r"\s+" + HEX + r"(?:\s+load address.*)?)?\s*$")
+INPUT_RE = re.compile(r"^ (\S+)(?:\s+" + HEX + r"\s+" + HEX + r"\s+(\S.*))?$")
+CONT_RE = re.compile(r"^\s+" + HEX + r"\s+" + HEX + r"\s+(\S.*)$")
+OUTPUT_CONT_RE = re.compile(r"^\s+" + HEX + r"\s+" + HEX + r"(?:\s+load address.*)?\s*$")
+
+
+def owner_of(obj):
+    name = os.path.basename(obj.strip())
+    if "(" in name:                         # libfoo.a(member.o)
+        return "system"
+    name = re.sub(r"\.o(bj)?$", "", name)
+    if name.startswith("arm_"):
+        return "dsp"
+    return OBJ_OWNER.get(name, "system")
+
+
+def parse_map(path):
+    """Returns {(region, owner): bytes} and {(region, owner, object): bytes}"""
+    with open(path) as f:
+        lines = f.read().splitlines()
+
+    try:
+        start = next(i for i, l in enumerate(lines) if l.startswith("Linker script and memory map"))
+    except StopIteration:
+        raise SystemExit("%s: not a GNU ld map file" % path)
+
+    usage = {}
+    detail = {}
+    section = None          # Current RAM output section
+    out_size = 0
+    in_sum = 0
+    pending = None          # Input or output section name split over two lines
+
+    def add(region, owner, obj, size):
+        usage[(region, owner)] = usage.get((region, owner), 0) + size
+        key = (region, owner, os.path.basename(obj))
+        detail[key] = detail.get(key, 0) + size
+
+    def close():
+        # Reservations without input sections (stack, heap) and padding
+        if section is not None and out_size > in_sum:
+            rest = {".stack": "stack", ".heap": "heap"}.get(section, "padding")
+            add(RAM_SECTIONS[section], rest, section, out_size - in_sum)
+
+    for line in lines[start + 1:]:
+        if pending is not None:
+            kind, name = pending
+            pending = None
+            if kind == "out":
+                m = OUTPUT_CONT_RE.match(line)
+                if m and name in RAM_SECTIONS:
+                    section, out_size, in_sum = name, int(m.group(2), 16), 0
+                continue
+            m = CONT_RE.match(line)
+            if m and section is not None:
+                size = int(m.group(2), 16)
+                add(RAM_SECTIONS[section], owner_of(m.group(3)), m.group(3), size)
+                in_sum += size
+            continue
+
+        if line and not line[0].isspace():
+            close()
+            section = None
+            m = OUTPUT_RE.match(line)
+            if m is None:
+                continue
+            if m.group(2) is None:
+                pending = ("out", m.group(1))
+            elif m.group(1) in RAM_SECTIONS:
+                section, out_size, in_sum = m.group(1), int(m.group(3), 16), 0
+            continue
+
+        if section is None:
+            continue
+        m = INPUT_RE.match(line)
+        if m is None or m.group(1).startswith("*(") or m.group(1).startswith("0x"):
+            continue
+        name = m.group(1)
+        if m.group(2) is None:
+            if not name.startswith("*"):
+                pending = ("in", name)
+            continue
+        if name == "*fill*":
+            continue                        # Counted as padding on close
+        size = int(m.group(3), 16)
+        add(RAM_SECTIONS[section], owner_of(m.group(4)), m.group(4), size)
+        in_sum += size
+
+    close()
+    return usage, detail
+
+
+def parse_budget(path):
+    budget = {}
+    with open(path) as f:
+        for n, line in enumerate(f, 1):
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            try:
+                name, value = line.split()
+                scale = 1024 if value[-1] in "kK" else 1
+                budget[name] = int(value.rstrip("kK"), 0) * scale
+            except ValueError:
+                raise SystemExit("%s:%d: expected 'owner bytes'" % (path, n))
+    return budget
+
+
+def main():
+    args = sys.argv[1:]
+    verbose = "--verbose" in args
+    args = [a for a in args if a != "--verbose"]
+    if not args:
+        print(__doc__)
+        return 2
+
+    usage, detail = parse_map(args[0])
+    budget = parse_budget(args[1]) if len(args) > 1 else {}
+    over = []
+
+    print("RAM use by owner (bytes)")
+    print("  %-10s %8s %8s %8s %8s" % ("owner", "sram", "dtcm", "total", "budget"))
+    totals = {"sram": 0, "dtcm": 0}
+    for owner in OWNER_ORDER:
+        sram = usage.get(("sram", owner), 0)
+        dtcm = usage.get(("dtcm", owner), 0)
+        totals["sram"] += sram
+        totals["dtcm"] += dtcm
+        if sram + dtcm == 0 and owner not in budget:
+            continue
+        limit = budget.get(owner)
+        flag = ""
+        if limit is not None and sram > limit:
+            flag = "  OVER"
+            over.append(owner)
+        print("  %-10s %8d %8d %8d %8s%s" % (owner, sram, dtcm, sram + dtcm,
+                                           "-" if limit is None else limit, flag))
+        if verbose:
+            for (region, o, obj), size in sorted(detail.items()):
+                if o == owner and size:
+                    print("      %-28s %-4s %8d" % (obj, region, size))
+
+    for region in ("sram", "dtcm"):
+        limit = budget.get(region)
+        flag = ""
+        if limit is not None and totals[region] > limit:
+            flag = "  OVER"
+            over.append(region)
+        print("  %-10s %8s %8s %8d %8s%s" % (region + " total", "", "", totals[region],
+                                           "-" if limit is None else limit, flag))
+
+    if over:
+        print("RAM budget exceeded: %s" % ", ".join(over), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+"""
+Decode the firmware telemetry stream (src/telemetry.h).
+
+Packet: 0xA5 0x5A | type | len | payload | xor(type, len, payload)
+
+Trace packets (drivers/trace.h) are printed as a timeline in ms since
+the first record, with the duration of each stage on its end record
+and the latency from frame readout to output per frame.
+
+Usage:
+    python3 tools/telemetry_decode.py /dev/ttyACM0 [baud]   (needs pyserial)
+    python3 tools/telemetry_decode.py capture.bin
+"""
+
+import os
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+BAUD = 921600
+
+TYPE_STATUS = 0x01
+TYPE_LINK = 0x02
+TYPE_TRACE = 0x03
+TYPE_SUPERVISOR = 0x04
+
+CPU_HZ = 300e6              # CYCCNT rate
+TRACE_END = 0x8000
+TRACE_NAMES = {
+    0x01: "irq_rtt", 0x02: "frame_ready", 0x03: "fifo_error", 0x04: "fifo_resync",
+    0x05: "if_gain",
+    0x10: "spi_burst", 0x11: "unpack", 0x12: "presence", 0x13: "tracking",
+    0x14: "gesture", 0x15: "features", 0x16: "classifier", 0x17: "vitals",
+    0x18: "output",
+}
+TRACE_FRAME_READY = 0x02
+TRACE_FIFO_ERROR = 0x03
+TRACE_FIFO_RESYNC = 0x04
+TRACE_IF_GAIN = 0x05
+HPF_KHZ = [20, 45, 70, 80, 160]         # HPF_SEL -> cut-off
+TRACE_OUTPUT = 0x18
+
+
+GESTURES = ["none", "swipe", "push", "pull"]
+
+
+def decode_status(payload):
+    (frame, flags, max_idx, occ, wave_class, gesture, gesture_seq,
+     breath, heart, zones) = struct.unpack("<IBBBBBBBBB", payload[:13])
+    name = GESTURES[gesture] if gesture < len(GESTURES) else str(gesture)
+    return ("status frame=%d presence=%d waving=%d bin=%d occupancy=%d class=%d "
+            "gesture=%s#%d breath=%d heart=%d zones=0x%02x" % (frame, flags & 1, (flags >> 1) & 1,
+                                                                max_idx, occ, wave_class, name,
+                                                                gesture_seq, breath, heart, zones))
+
+
+def decode_link(payload):
+    (clock_hz, scbr, flags, steps, readback_err, pattern_err,
+     check_fail) = struct.unpack("<IBBHIII", payload[:20])
+    return ("link clock=%.1fMHz scbr=%d hs_read=%d wide=%d steps=%d readback_err=%d "
+            "pattern_err=%d check_fail=%d" % (clock_hz / 1e6, scbr, flags & 1, (flags >> 1) & 1,
+                                              steps, readback_err, pattern_err, check_fail))
+
+
+LEVELS = ["full", "no_classifier", "sparse"]
+STAGES = ["presence", "tracking", "gesture", "features", "vitals", "output"]
+
+
+def decode_supervisor(payload):
+    (level, frames, overruns, late, unhealthy, downs, ups,
+     frame_max_us) = struct.unpack("<BIIIIHHI", payload[:25])
+    stages = struct.unpack("<" + "HH" * len(STAGES), payload[25:25 + 4 * len(STAGES)])
+    name = LEVELS[level] if level < len(LEVELS) else str(level)
+    text = ("supervisor level=%s frames=%d overruns=%d late=%d unhealthy=%d steps=-%d/+%d "
+            "frame_max=%dus" % (name, frames, overruns, late, unhealthy, downs, ups, frame_max_us))
+    for i, stage in enumerate(STAGES):
+        text += " %s=%d/%dus" % (stage, stages[2 * i], stages[2 * i + 1])
+    return text
+
+
+class TraceTimeline:
+    """Unwraps the 32-bit cycle counter and pairs stage begin/end records."""
+
+    def __init__(self):
+        self.next_seq = None
+        self.last_cycles = None
+        self.time = 0           # Unwrapped cycles since the first record
+        self.begin = {}         # Stage ID -> begin time
+        self.frame = None       # (index, time) of the last frame readout
+        self.overflow = None    # Time of an overflow not yet recovered
+        self.resynced = False
+
+    def ms(self, cycles):
+        return cycles * 1e3 / CPU_HZ
+
+    def decode(self, payload):
+        (seq,) = struct.unpack("<I", payload[:4])
+        lines = []
+        if self.next_seq is not None and seq != self.next_seq:
+            lines.append("trace  -- %d records lost --" % ((seq - self.next_seq) & 0xFFFFFFFF))
+            self.begin.clear()
+        self.next_seq = (seq + (len(payload) - 4) // 8) & 0xFFFFFFFF
+
+        for off in range(4, len(payload) - 7, 8):
+            cycles, ev, arg = struct.unpack("<IHH", payload[off:off + 8])
+            if self.last_cycles is not None:
+                self.time += (cycles - self.last_cycles) & 0xFFFFFFFF
+            self.last_cycles = cycles
+
+            stage = ev & ~TRACE_END
+            name = TRACE_NAMES.get(stage, "0x%02x" % stage)
+            line = "trace %10.3f ms  %-12s" % (self.ms(self.time), name)
+            if ev & TRACE_END:
+                start = self.begin.pop(stage, None)
+                line += " end   arg=%-5d" % arg
+                if start is not None:
+                    line += " %8.3f ms" % self.ms(self.time - start)
+                if stage == TRACE_OUTPUT and self.frame is not None:
+                    line += "  frame %d latency %.3f ms" % (self.frame[0],
+                                                          self.ms(self.time - self.frame[1]))
+            elif stage >= 0x10:
+                self.begin[stage] = self.time
+                line += " begin arg=%d" % arg
+            else:
+                line += " arg=%d" % arg
+                if stage == TRACE_FRAME_READY:
+                    self.frame = (arg, self.time)
+                    if self.resynced:
+                        line += "  recovered in %.3f ms" % self.ms(self.time - self.overflow)
+                        self.overflow = None
+                        self.resynced = False
+                elif stage == TRACE_FIFO_ERROR and self.overflow is None:
+                    self.overflow = self.time
+                elif stage == TRACE_FIFO_RESYNC and self.overflow is not None:
+                    self.resynced = True
+                elif stage == TRACE_IF_GAIN:
+                    hpf = arg >> 8
+                    line += "  VGA %d dB, high-pass %s kHz" % (
+                        5 * (arg & 0xFF), HPF_KHZ[hpf] if hpf < len(HPF_KHZ) else "?")
+            lines.append(line)
+        return "\n".join(lines)
+
+
+DECODERS = {
+    TYPE_STATUS: decode_status,
+    TYPE_LINK: decode_link,
+    TYPE_TRACE: TraceTimeline().decode,
+    TYPE_SUPERVISOR: decode_supervisor,
+}
+
+
+def packets(read):
+    """Yield (type, payload) from a byte source, resyncing on bad checksums."""
+    buf = bytearray()
+    while True:
+        chunk = read(256)
+        if not chunk:
+            return
+        buf += chunk
+        while True:
+            start = buf.find(SYNC)
+            if start < 0:
+                del buf[:-1]
+                break
+            del buf[:start]
+            if len(buf) < 4 or len(buf) < 5 + buf[3]:
+                break
+            ptype, length = buf[2], buf[3]
+            payload = bytes(buf[4:4 + length])
+            check = ptype ^ length
+            for b in payload:
+                check ^= b
+            if check != buf[4 + length]:
+                del buf[:1]
+                continue
+            del buf[:5 + length]
+            yield ptype, payload
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+
+    path = sys.argv[1]
+    if os.path.isfile(path):
+        src = open(path, "rb")
+        read = src.read
+    else:
+        import serial
+        src = serial.Serial(path, int(sys.argv[2]) if len(sys.argv) > 2 else BAUD, timeout=1)
+
+        def read(n):
+            while True:
+                data = src.read(n)  # Empty on timeout: keep waiting
+                if data:
+                    return data
+
+    for ptype, payload in packets(read):
+        decoder = DECODERS.get(ptype)
+        if decoder:
+            print(decoder(payload))
+        else:
+            print("type 0x%02x len %d: %s" % (ptype, len(payload), payload.hex()))
+
+
+if __name__ == "__main__":
+    main()